@@ -0,0 +1,192 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@kit.edu>
+ */
+
+/*
+ * Micro-benchmark for the conversion between the payload bytes of a frame and the
+ * bit vector that is processed by the PHY. For a 1500 byte frame, the byte-wise
+ * conversion (PhySimHelper::DecToBin and itpp::bin2dec on 8-bit slices) is compared
+ * against PhySimPackedBits. In addition, the time spent in PhySimWifiPhy::SendPacket
+ * for the whole frame construction is reported for each IEEE 802.11p data rate.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/common-module.h"
+#include "ns3/node-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/physim-wifi-module.h"
+#include "ns3/mobility-module.h"
+
+#include <itpp/itcomm.h>
+
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("Main");
+
+using namespace ns3;
+
+static double
+ToMicroSeconds (std::clock_t ticks, uint32_t repetitions)
+{
+  return ((double) ticks / CLOCKS_PER_SEC) * 1e6 / repetitions;
+}
+
+class SendBenchmark
+{
+public:
+  double
+  Run (WifiMode mode, uint32_t size, uint32_t repetitions)
+  {
+    PhySimWifiPhy::ClearCache ();
+    Ptr<PhySimWifiChannel> channel = CreateObject<PhySimWifiUniformChannel> ();
+    Ptr<PhySimWifiPhy> phy = CreateObject<PhySimWifiPhy> ();
+    phy->ConfigureStandard (WIFI_PHY_STANDARD_80211p_CCH);
+    phy->SetChannel (channel);
+    Ptr<Node> node = CreateObject<Node> ();
+    Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+    Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+    node->AggregateObject (mobility);
+    phy->SetMobility (node);
+    phy->SetDevice (device);
+
+    std::vector<uint8_t> payload (size);
+    for (uint32_t i = 0; i < size; i++)
+      {
+        payload[i] = itpp::randi (0, 255);
+      }
+    m_packet = Create<Packet> (&payload[0], size);
+    m_phy = phy;
+    m_mode = mode;
+    m_cpuTime = 0;
+
+    // One frame per 10 ms, which is longer than a 1500 byte frame at 3 Mbps
+    for (uint32_t i = 0; i < repetitions; i++)
+      {
+        Simulator::Schedule (MilliSeconds (10 * (i + 1)), &SendBenchmark::Send, this);
+      }
+    Simulator::Run ();
+    Simulator::Destroy ();
+    m_phy = 0;
+
+    return ToMicroSeconds (m_cpuTime, repetitions);
+  }
+
+private:
+  void
+  Send (void)
+  {
+    std::clock_t start = std::clock ();
+    m_phy->SendPacket (m_packet, m_mode, WIFI_PREAMBLE_LONG, 1);
+    m_cpuTime += std::clock () - start;
+  }
+
+  Ptr<PhySimWifiPhy> m_phy;
+  Ptr<const Packet> m_packet;
+  WifiMode m_mode;
+  std::clock_t m_cpuTime;
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t size = 1500;
+  uint32_t repetitions = 200;
+
+  CommandLine cmd;
+  cmd.AddValue ("size", "Payload size of the frame in bytes", size);
+  cmd.AddValue ("repetitions", "Number of repetitions per measurement", repetitions);
+  cmd.Parse (argc, argv);
+
+  std::vector<uint8_t> bytes (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      bytes[i] = itpp::randi (0, 255);
+    }
+
+  // Byte-wise conversion of the payload into a bit vector and back
+  std::clock_t start = std::clock ();
+  itpp::bvec reference;
+  for (uint32_t r = 0; r < repetitions; r++)
+    {
+      reference.set_size (0);
+      for (uint32_t i = 0; i < size; i++)
+        {
+          reference.ins (reference.size (), PhySimHelper::DecToBin (bytes[i], 8));
+        }
+    }
+  double unpackBytewise = ToMicroSeconds (std::clock () - start, repetitions);
+
+  start = std::clock ();
+  for (uint32_t r = 0; r < repetitions; r++)
+    {
+      for (uint32_t i = 0; i < size; i++)
+        {
+          itpp::bvec extract = reference ((i * 8), (i * 8) + 8 - 1);
+          bytes[i] = itpp::bin2dec ( extract, false );
+        }
+    }
+  double packBytewise = ToMicroSeconds (std::clock () - start, repetitions);
+
+  // Table-driven conversion
+  start = std::clock ();
+  itpp::bvec bits;
+  for (uint32_t r = 0; r < repetitions; r++)
+    {
+      bits = PhySimPackedBits (&bytes[0], size).ToBvec ();
+    }
+  double unpackPacked = ToMicroSeconds (std::clock () - start, repetitions);
+
+  start = std::clock ();
+  for (uint32_t r = 0; r < repetitions; r++)
+    {
+      PhySimPackedBits packed (bits);
+    }
+  double packPacked = ToMicroSeconds (std::clock () - start, repetitions);
+
+  if (!(bits == reference))
+    {
+      std::cerr << "Table-driven conversion does not match byte-wise conversion" << std::endl;
+      return 1;
+    }
+
+  std::cout << "Conversion of a " << size << " byte payload (us per frame):" << std::endl;
+  std::cout << std::setw (24) << "" << std::setw (14) << "byte-wise" << std::setw (14) << "packed" << std::endl;
+  std::cout << std::setw (24) << "bytes -> bit vector" << std::setw (14) << unpackBytewise << std::setw (14) << unpackPacked << std::endl;
+  std::cout << std::setw (24) << "bit vector -> bytes" << std::setw (14) << packBytewise << std::setw (14) << packPacked << std::endl;
+  std::cout << std::endl;
+
+  // Whole frame construction for every IEEE 802.11p rate
+  WifiMode modes[8] = { WifiPhy::GetOfdmRate3MbpsBW10MHz (), WifiPhy::GetOfdmRate4_5MbpsBW10MHz (),
+                        WifiPhy::GetOfdmRate6MbpsBW10MHz (), WifiPhy::GetOfdmRate9MbpsBW10MHz (),
+                        WifiPhy::GetOfdmRate12MbpsBW10MHz (), WifiPhy::GetOfdmRate18MbpsBW10MHz (),
+                        WifiPhy::GetOfdmRate24MbpsBW10MHz (), WifiPhy::GetOfdmRate27MbpsBW10MHz () };
+  std::cout << "PhySimWifiPhy::SendPacket for a " << size << " byte frame:" << std::endl;
+  std::cout << std::setw (28) << "mode" << std::setw (14) << "us/frame" << std::endl;
+  SendBenchmark benchmark;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      double perFrame = benchmark.Run (modes[i], size, repetitions);
+      std::cout << std::setw (28) << modes[i].GetUniqueName () << std::setw (14) << perFrame << std::endl;
+    }
+
+  return 0;
+}
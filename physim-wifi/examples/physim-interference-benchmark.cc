@@ -0,0 +1,168 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@kit.edu>
+ */
+
+/*
+ * Micro-benchmark for PhySimInterferenceHelper. Frames of a fixed duration arrive
+ * back-to-back such that on average a given number of transmissions overlap at the
+ * receiver. On every arrival, the cumulative samples of the next OFDM symbol are
+ * requested and the CCA energy check is performed, which is what PhySimWifiPhy does
+ * in StartReceivePacket and CheckForNextCcaBusyStart. The CPU time spent in these
+ * queries is reported per query and per number of concurrent transmissions.
+ *
+ * Overlap queries cost O(log n + k log n) for n stored and k overlapping events. With
+ * --longFrame=1, every run starts with one frame that lasts as long as 1000 regular frames,
+ * which must not make the queries visit the events that have ended in the meantime.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/common-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/physim-wifi-module.h"
+
+#include <itpp/itcomm.h>
+
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+
+NS_LOG_COMPONENT_DEFINE ("Main");
+
+using namespace ns3;
+
+class InterferenceBenchmark
+{
+public:
+  InterferenceBenchmark ()
+    : m_symbolDuration (MicroSeconds (4)),
+      m_frameSymbols (20)
+  {
+  }
+
+  double
+  Run (uint32_t concurrent, uint32_t numFrames, bool longFrame)
+  {
+    m_interference = CreateObject<PhySimInterferenceHelper> ();
+    m_interference->SetAttribute ("DisableNoise", BooleanValue (true));
+    m_interference->SetSymbolTime (m_symbolDuration);
+
+    // One tag is shared by all events, only its samples are read
+    Time duration = m_symbolDuration * m_frameSymbols;
+    uint32_t numSamples = m_frameSymbols * 80 + 1;
+    m_tag = Create<PhySimWifiPhyTag> ();
+    m_tag->SetTxParameters (WIFI_PREAMBLE_LONG, WifiPhy::GetOfdmRate6Mbps (), duration,
+                            itpp::randb (100), itpp::randn_c (numSamples), 5.2e9, 5e-8, 0);
+    m_tag->SetRxSamples (1e-5 * itpp::randn_c (numSamples));
+
+    m_interval = NanoSeconds (duration.GetNanoSeconds () / concurrent);
+    m_remaining = numFrames;
+    m_queries = 0;
+    m_cpuTime = 0;
+
+    if (longFrame)
+      {
+        uint32_t longSymbols = 1000 * m_frameSymbols;
+        Ptr<PhySimWifiPhyTag> tag = Create<PhySimWifiPhyTag> ();
+        tag->SetTxParameters (WIFI_PREAMBLE_LONG, WifiPhy::GetOfdmRate6Mbps (), m_symbolDuration * longSymbols,
+                              itpp::randb (100), itpp::randn_c (longSymbols * 80 + 1), 5.2e9, 5e-8, 0);
+        tag->SetRxSamples (1e-5 * itpp::randn_c (longSymbols * 80 + 1));
+        Simulator::Schedule (Seconds (1.0), &InterferenceBenchmark::AddLongFrame, this, tag);
+      }
+    Simulator::Schedule (Seconds (1.0), &InterferenceBenchmark::AddFrame, this);
+    Simulator::Run ();
+    Simulator::Destroy ();
+
+    return ((double) m_cpuTime / CLOCKS_PER_SEC) * 1e6 / m_queries;
+  }
+
+  uint32_t
+  GetStoredEvents (void) const
+  {
+    return m_storedEvents;
+  }
+
+private:
+  void
+  AddLongFrame (Ptr<PhySimWifiPhyTag> tag)
+  {
+    m_interference->Add (Create<Packet> (), tag);
+  }
+
+  void
+  AddFrame (void)
+  {
+    m_interference->Add (Create<Packet> (), m_tag);
+
+    std::clock_t start = std::clock ();
+    itpp::cvec samples = m_interference->GetCumulativeSamples (Simulator::Now (), Simulator::Now () + m_symbolDuration);
+    Time until;
+    m_interference->IsEnergyReached (-62.0, until);
+    m_cpuTime += std::clock () - start;
+    m_queries++;
+
+    m_storedEvents = m_interference->GetNEvents ();
+    if (--m_remaining > 0)
+      {
+        Simulator::Schedule (m_interval, &InterferenceBenchmark::AddFrame, this);
+      }
+  }
+
+  Time m_symbolDuration;
+  uint32_t m_frameSymbols;
+  Time m_interval;
+  uint32_t m_remaining;
+  uint32_t m_queries;
+  uint32_t m_storedEvents;
+  std::clock_t m_cpuTime;
+  Ptr<PhySimInterferenceHelper> m_interference;
+  Ptr<PhySimWifiPhyTag> m_tag;
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t numFrames = 20000;
+  uint32_t maxConcurrent = 256;
+  bool longFrame = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("frames", "Number of frames that arrive in each run", numFrames);
+  cmd.AddValue ("maxConcurrent", "Largest number of concurrent transmissions to benchmark", maxConcurrent);
+  cmd.AddValue ("longFrame", "Start every run with a frame that lasts as long as 1000 regular frames", longFrame);
+  cmd.Parse (argc, argv);
+
+  std::cout << "Overlap queries cost O(log n + k log n) for n stored and k overlapping events";
+  if (longFrame)
+    {
+      std::cout << ", every run starts with one long frame";
+    }
+  std::cout << std::endl;
+
+  std::cout << std::setw (12) << "concurrent" << std::setw (16) << "stored events" << std::setw (16) << "us/query" << std::endl;
+
+  InterferenceBenchmark benchmark;
+  for (uint32_t concurrent = 1; concurrent <= maxConcurrent; concurrent *= 2)
+    {
+      double perQuery = benchmark.Run (concurrent, numFrames, longFrame);
+      std::cout << std::setw (12) << concurrent << std::setw (16) << benchmark.GetStoredEvents ()
+                << std::setw (16) << perQuery << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,391 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@kit.edu>
+ */
+
+/*
+ * Calibration tool that generates packet and bit error rate tables from the full
+ * PhySimWifiPhy signal processing chain. For every point of the grid
+ *
+ *     SNR x WifiMode x payload length x VEHICULAR_CHANNEL_PROFILE
+ *
+ * a sender transmits a fixed number of broadcast frames to a receiver over a constant
+ * path loss and the vehicular fading channel, and the outcome of every reception is
+ * counted. Grid points are distributed over several worker processes (one ns-3 simulator
+ * per process), whose results are collected through pipes.
+ *
+ * The resulting PhySimPerTable is written into a binary file (see physim-per-table.h for its format). The
+ * payload lengths given on the command line are stored as the size of the transmitted frames (PSDU), and the
+ * profile "awgn" calibrates without fading. These AWGN curves are the ones used by the SINR lookup of
+ * PhySimWifiPhy (attributes UseSinrLookup and PerTable), e.g.
+ *
+ *   Ptr<PhySimPerTable> table = CreateObject<PhySimPerTable> ();
+ *   table->Load ("physim-per-table.bin");
+ *   Config::SetDefault ("ns3::PhySimWifiPhy::PerTable", PointerValue (table));
+ *   Config::SetDefault ("ns3::PhySimWifiPhy::UseSinrLookup", BooleanValue (true));
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/common-module.h"
+#include "ns3/node-module.h"
+#include "ns3/helper-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/physim-wifi-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/contrib-module.h"
+
+#include <itpp/itcomm.h>
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cstdio>
+#include <sstream>
+#include <iostream>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("Main");
+
+using namespace ns3;
+
+/*
+ * The result of a single grid point, as it is transferred from a worker to the main process
+ */
+struct GridResult
+{
+  uint32_t index;
+  uint32_t psduSize;
+  uint32_t txCount;
+  uint32_t rxOkCount;
+  uint32_t payloadCount;
+  uint64_t payloadBits;
+  uint64_t bitErrors;
+};
+
+class Calibration
+{
+public:
+  /*
+   * Derives the IT++ seed of a grid point from the global seed and the index of the point (MurmurHash3 finalizer)
+   */
+  static uint32_t
+  GetItppSeed (uint32_t seed, uint32_t index)
+  {
+    uint32_t h = seed ^ (0x9e3779b9u * (index + 1));
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+  }
+
+  GridResult
+  Run (uint32_t index, std::string wifiMode, uint32_t packetSize, uint32_t profile, double snr,
+       uint32_t frames, double speed, uint32_t seed)
+  {
+    double txPower = 20.0;
+    double bgNoise = -99.0;
+
+    m_result.index = index;
+    m_result.psduSize = 0;
+    m_result.txCount = 0;
+    m_result.rxOkCount = 0;
+    m_result.payloadCount = 0;
+    m_result.payloadBits = 0;
+    m_result.bitErrors = 0;
+
+    Config::SetDefault ("ns3::WifiRemoteStationManager::FragmentationThreshold", StringValue ("2200"));
+    Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", StringValue ("2200"));
+    Config::SetDefault ("ns3::PhySimScrambler::UseFixedScrambler", BooleanValue (false) );
+
+    Config::SetDefault ("ns3::PhySimWifiPhy::TxPowerEnd", DoubleValue (txPower) );
+    Config::SetDefault ("ns3::PhySimWifiPhy::TxPowerStart", DoubleValue (txPower) );
+    Config::SetDefault ("ns3::PhySimWifiPhy::TxPowerLevels", UintegerValue (1) );
+    Config::SetDefault ("ns3::PhySimWifiPhy::TxGain", DoubleValue (0.0) );
+    Config::SetDefault ("ns3::PhySimWifiPhy::RxGain", DoubleValue (0.0) );
+    Config::SetDefault ("ns3::PhySimWifiPhy::ChannelEstimator", StringValue ("ns3::PhySimChannelFrequencyOffsetEstimator") );
+    Config::SetDefault ("ns3::PhySimInterferenceHelper::NoiseFloor", DoubleValue (bgNoise) );
+
+    PhySimWifiChannelHelper wifiChannel;
+    wifiChannel.AddPropagationLoss ("ns3::PhySimPropagationLossModel");
+    wifiChannel.AddPropagationLoss ("ns3::PhySimConstantPropagationLoss");
+    Config::SetDefault ("ns3::PhySimConstantPropagationLoss::PathLoss", DoubleValue (txPower - bgNoise - snr) );
+    if (profile != PhySimPerTable::AWGN_PROFILE)
+      {
+        wifiChannel.AddPropagationLoss ("ns3::PhySimVehicularChannelPropagationLoss");
+        Config::SetDefault ("ns3::PhySimVehicularChannelPropagationLoss::MinimumRelativeSpeed", DoubleValue (speed) );
+        Config::SetDefault ("ns3::PhySimVehicularChannelPropagationLoss::ChannelProfile", EnumValue (profile) );
+      }
+    wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+
+    // Every grid point gets its own ns-3 run and its own IT++ stream (which drives the noise, the fading and the
+    // random payloads), such that results do not depend on the number of workers or the order of the grid points
+    SeedManager::SetSeed (seed);
+    SeedManager::SetRun (index + 1);
+    PhySimWifiPhy::ResetRNG (GetItppSeed (seed, index));
+
+    PhySimWifiPhyHelper wifiPhy = PhySimWifiPhyHelper::Default ();
+    wifiPhy.SetChannel (wifiChannel.Create ());
+
+    WifiHelper wifi = WifiHelper::Default ();
+    wifi.SetStandard (WIFI_PHY_STANDARD_80211p_CCH);
+    NqosWifiMacHelper wifiMac = NqosWifiMacHelper::Default ();
+    wifiMac.SetType ("ns3::AdhocWifiMac");
+    wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                  "DataMode", StringValue (wifiMode),
+                                  "NonUnicastMode", StringValue (wifiMode));
+
+    NodeContainer nodes;
+    nodes.Create (2);
+    wifi.Install (wifiPhy, wifiMac, nodes);
+
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+    positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+    positionAlloc->Add (Vector (1.0, 0.0, 0.0));
+    mobility.SetPositionAllocator (positionAlloc);
+    mobility.Install (nodes);
+
+    PacketSocketHelper packetSocket;
+    packetSocket.Install (nodes);
+
+    PacketSocketAddress socketOn0;
+    socketOn0.SetAllDevices ();
+    socketOn0.SetPhysicalAddress (Mac48Address::GetBroadcast ());
+    socketOn0.SetProtocol (1);
+    PacketSinkHelper sink ("ns3::PacketSocketFactory", Address (socketOn0));
+
+    PacketSocketAddress socketTo0;
+    socketTo0.SetAllDevices ();
+    socketTo0.SetPhysicalAddress (Mac48Address::GetBroadcast ());
+    socketTo0.SetProtocol (1);
+    OnOffHelper onOff ("ns3::PacketSocketFactory", Address (socketTo0));
+    onOff.SetAttribute ("PacketSize", UintegerValue (packetSize));
+    onOff.SetAttribute ("OnTime", RandomVariableValue (ConstantVariable (1.0)));
+    onOff.SetAttribute ("OffTime", RandomVariableValue (ConstantVariable (0.0)));
+    std::ostringstream oss;
+    oss << (10 * packetSize) << "B/s";
+    onOff.SetAttribute ("DataRate", DataRateValue (DataRate (oss.str ()) ));
+
+    // 10 frames per second
+    ApplicationContainer app;
+    app = sink.Install (nodes.Get (1));
+    app = onOff.Install (nodes.Get (0));
+    app.Start (Seconds (1.0));
+    app.Stop (Seconds (1.0 + frames / 10.0));
+
+    Config::ConnectWithoutContext ("/NodeList/0/DeviceList/*/$ns3::WifiNetDevice/Phy/Tx", MakeCallback (&Calibration::PhyTxTrace, this) );
+    Config::ConnectWithoutContext ("/NodeList/1/DeviceList/*/$ns3::WifiNetDevice/Phy/RxOk", MakeCallback (&Calibration::PhyRxOkTrace, this) );
+    Config::ConnectWithoutContext ("/NodeList/1/DeviceList/*/$ns3::WifiNetDevice/Phy/RxError", MakeCallback (&Calibration::PhyRxErrorTrace, this) );
+
+    Simulator::Stop (Seconds (3.0 + frames / 10.0));
+    Simulator::Run ();
+    Simulator::Destroy ();
+
+    return m_result;
+  }
+
+private:
+  void
+  PhyTxTrace (Ptr<const Packet> p, Ptr<const PhySimWifiPhyTag> tag)
+  {
+    m_result.psduSize = p->GetSize ();
+    m_result.txCount++;
+  }
+
+  void
+  PhyRxOkTrace (Ptr<const Packet> p, Ptr<const PhySimWifiPhyTag> tag)
+  {
+    m_result.rxOkCount++;
+    m_result.payloadCount++;
+    m_result.payloadBits += tag->GetTxedDataBits ().size ();
+  }
+
+  void
+  PhyRxErrorTrace (Ptr<const Packet> p, Ptr<const PhySimWifiPhyTag> tag, enum PhySimWifiPhy::ErrorReason reason)
+  {
+    // Only errors at the end of the payload carry decoded data bits
+    itpp::bvec rxBits = tag->GetRxDataBits ();
+    itpp::bvec txBits = tag->GetTxedDataBits ();
+    if (reason == PhySimWifiPhy::PROCESSING && rxBits.size () == txBits.size () && txBits.size () > 0)
+      {
+        m_result.payloadCount++;
+        m_result.payloadBits += txBits.size ();
+        for (int32_t i = 0; i < txBits.size (); i++)
+          {
+            if (rxBits (i) != txBits (i))
+              {
+                m_result.bitErrors++;
+              }
+          }
+      }
+  }
+
+  GridResult m_result;
+};
+
+static std::vector<std::string>
+Split (std::string list)
+{
+  std::vector<std::string> result;
+  std::stringstream ss (list);
+  std::string item;
+  while (std::getline (ss, item, ','))
+    {
+      if (!item.empty ())
+        {
+          result.push_back (item);
+        }
+    }
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  double snrMin = -5.0;
+  double snrMax = 30.0;
+  double snrStep = 1.0;
+  std::string modeList = "OfdmRate3MbpsBW10MHz,OfdmRate6MbpsBW10MHz,OfdmRate12MbpsBW10MHz,OfdmRate27MbpsBW10MHz";
+  std::string lengthList = "100,500,1000";
+  std::string profileList = "awgn,0,2,4,6,8,10";
+  uint32_t frames = 1000;
+  uint32_t jobs = sysconf (_SC_NPROCESSORS_ONLN);
+  uint32_t seed = 1;
+  double speed = 10.0;
+  std::string output = "physim-per-table.bin";
+
+  CommandLine cmd;
+  cmd.AddValue ("snrMin", "Smallest SNR value (dB) of the grid", snrMin);
+  cmd.AddValue ("snrMax", "Largest SNR value (dB) of the grid", snrMax);
+  cmd.AddValue ("snrStep", "Step size (dB) between two SNR values of the grid", snrStep);
+  cmd.AddValue ("modes", "Comma separated list of WifiMode names", modeList);
+  cmd.AddValue ("lengths", "Comma separated list of payload lengths in bytes", lengthList);
+  cmd.AddValue ("profiles", "Comma separated list of VEHICULAR_CHANNEL_PROFILE values, or awgn for no fading", profileList);
+  cmd.AddValue ("frames", "Number of frames transmitted per grid point", frames);
+  cmd.AddValue ("jobs", "Number of worker processes", jobs);
+  cmd.AddValue ("seed", "Seed of the random number generator", seed);
+  cmd.AddValue ("speed", "Relative speed (m/s) between sender and receiver", speed);
+  cmd.AddValue ("output", "Name of the binary output file", output);
+  cmd.Parse (argc, argv);
+
+  std::vector<double> snrs;
+  for (double snr = snrMin; snr <= snrMax + 1e-9; snr += snrStep)
+    {
+      snrs.push_back (snr);
+    }
+  std::vector<std::string> modes = Split (modeList);
+  std::vector<uint32_t> lengths;
+  std::vector<uint32_t> profiles;
+  std::vector<std::string> items = Split (lengthList);
+  for (uint32_t i = 0; i < items.size (); i++)
+    {
+      lengths.push_back (atoi (items[i].c_str ()));
+    }
+  items = Split (profileList);
+  for (uint32_t i = 0; i < items.size (); i++)
+    {
+      profiles.push_back (items[i] == "awgn" ? PhySimPerTable::AWGN_PROFILE : atoi (items[i].c_str ()));
+    }
+
+  uint32_t numPoints = snrs.size () * modes.size () * lengths.size () * profiles.size ();
+  if (jobs < 1)
+    {
+      jobs = 1;
+    }
+  std::cout << "Calibrating " << numPoints << " grid points with " << frames << " frames each using " << jobs << " worker processes" << std::endl;
+
+  // Start the workers: worker w simulates all grid points with index % jobs == w
+  std::vector<pid_t> workers;
+  std::vector<int> pipes;
+  for (uint32_t w = 0; w < jobs; w++)
+    {
+      int fd[2];
+      if (pipe (fd) != 0)
+        {
+          std::cerr << "Unable to create pipe for worker " << w << std::endl;
+          return 1;
+        }
+      pid_t pid = fork ();
+      if (pid == 0)
+        {
+          close (fd[0]);
+          Calibration calibration;
+          for (uint32_t index = w; index < numPoints; index += jobs)
+            {
+              uint32_t s = index % snrs.size ();
+              uint32_t l = (index / snrs.size ()) % lengths.size ();
+              uint32_t m = (index / snrs.size () / lengths.size ()) % modes.size ();
+              uint32_t p = index / snrs.size () / lengths.size () / modes.size ();
+              GridResult result = calibration.Run (index, modes[m], lengths[l], profiles[p], snrs[s], frames, speed, seed);
+              if (write (fd[1], &result, sizeof (result)) != sizeof (result))
+                {
+                  _exit (1);
+                }
+            }
+          close (fd[1]);
+          _exit (0);
+        }
+      close (fd[1]);
+      workers.push_back (pid);
+      pipes.push_back (fd[0]);
+    }
+
+  // Collect the results of all workers
+  std::vector<GridResult> results (numPoints);
+  uint32_t received = 0;
+  for (uint32_t w = 0; w < jobs; w++)
+    {
+      GridResult result;
+      while (read (pipes[w], &result, sizeof (result)) == sizeof (result))
+        {
+          results[result.index] = result;
+          received++;
+        }
+      close (pipes[w]);
+      int status;
+      waitpid (workers[w], &status, 0);
+    }
+  if (received != numPoints)
+    {
+      std::cerr << "Only " << received << " of " << numPoints << " grid points have been simulated" << std::endl;
+      return 1;
+    }
+
+  // Write the table, with the frame lengths as transmitted by the PHY
+  std::vector<uint32_t> psduSizes;
+  for (uint32_t l = 0; l < lengths.size (); l++)
+    {
+      psduSizes.push_back (results[l * snrs.size ()].psduSize);
+    }
+  Ptr<PhySimPerTable> table = CreateObject<PhySimPerTable> ();
+  table->SetGrid (snrs, modes, psduSizes, profiles);
+  for (uint32_t i = 0; i < numPoints; i++)
+    {
+      const GridResult &r = results[i];
+      table->SetRecord (i, r.txCount, r.rxOkCount, r.payloadCount, r.payloadBits, r.bitErrors);
+    }
+  if (!table->Save (output))
+    {
+      std::cerr << "Unable to write " << output << std::endl;
+      return 1;
+    }
+
+  std::cout << "PER table written to " << output << std::endl;
+  return 0;
+}
@@ -0,0 +1,133 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Jens Mittag <jens.mittag@kit.edu>
+ */
+
+
+/*
+ * Throughput benchmark for the construction of transmitted frames. For each IEEE 802.11p data
+ * rate, frames of a given size are sent through PhySimWifiPhy::SendPacket, once with the DATA
+ * field constructed in separate passes over the whole frame and once with the streaming
+ * PhySimTxPipeline (attribute 'UseTxPipeline'), and the throughput is reported in frames per
+ * second of CPU time.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/common-module.h"
+#include "ns3/node-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/physim-wifi-module.h"
+#include "ns3/mobility-module.h"
+
+#include <itpp/itcomm.h>
+
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+NS_LOG_COMPONENT_DEFINE ("Main");
+
+using namespace ns3;
+
+class TxBenchmark
+{
+public:
+  double
+  Run (WifiMode mode, bool useTxPipeline, uint32_t size, uint32_t repetitions)
+  {
+    Ptr<PhySimWifiChannel> channel = CreateObject<PhySimWifiUniformChannel> ();
+    Ptr<PhySimWifiPhy> phy = CreateObject<PhySimWifiPhy> ();
+    phy->SetAttribute ("UseTxPipeline", BooleanValue (useTxPipeline));
+    phy->ConfigureStandard (WIFI_PHY_STANDARD_80211p_CCH);
+    phy->SetChannel (channel);
+    Ptr<Node> node = CreateObject<Node> ();
+    Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+    Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+    node->AggregateObject (mobility);
+    phy->SetMobility (node);
+    phy->SetDevice (device);
+
+    std::vector<uint8_t> payload (size);
+    for (uint32_t i = 0; i < size; i++)
+      {
+        payload[i] = itpp::randi (0, 255);
+      }
+    m_packet = Create<Packet> (&payload[0], size);
+    m_phy = phy;
+    m_mode = mode;
+    m_cpuTime = 0;
+
+    // One frame per 10 ms, which is longer than a 1500 byte frame at 3 Mbps
+    for (uint32_t i = 0; i < repetitions; i++)
+      {
+        Simulator::Schedule (MilliSeconds (10 * (i + 1)), &TxBenchmark::Send, this);
+      }
+    Simulator::Run ();
+    Simulator::Destroy ();
+    m_phy = 0;
+
+    return repetitions / ((double) m_cpuTime / CLOCKS_PER_SEC);
+  }
+
+private:
+  void
+  Send (void)
+  {
+    std::clock_t start = std::clock ();
+    m_phy->SendPacket (m_packet, m_mode, WIFI_PREAMBLE_LONG, 1);
+    m_cpuTime += std::clock () - start;
+  }
+
+  Ptr<PhySimWifiPhy> m_phy;
+  Ptr<const Packet> m_packet;
+  WifiMode m_mode;
+  std::clock_t m_cpuTime;
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t size = 1500;
+  uint32_t repetitions = 200;
+
+  CommandLine cmd;
+  cmd.AddValue ("size", "Payload size of the frames in bytes", size);
+  cmd.AddValue ("repetitions", "Number of frames per measurement", repetitions);
+  cmd.Parse (argc, argv);
+
+  WifiMode modes[8] = { WifiPhy::GetOfdmRate3MbpsBW10MHz (), WifiPhy::GetOfdmRate4_5MbpsBW10MHz (),
+                        WifiPhy::GetOfdmRate6MbpsBW10MHz (), WifiPhy::GetOfdmRate9MbpsBW10MHz (),
+                        WifiPhy::GetOfdmRate12MbpsBW10MHz (), WifiPhy::GetOfdmRate18MbpsBW10MHz (),
+                        WifiPhy::GetOfdmRate24MbpsBW10MHz (), WifiPhy::GetOfdmRate27MbpsBW10MHz () };
+
+  std::cout << "PhySimWifiPhy::SendPacket for a " << size << " byte frame (frames per second):" << std::endl;
+  std::cout << std::setw (28) << "mode" << std::setw (14) << "frame-wise" << std::setw (14) << "pipeline"
+            << std::setw (10) << "speedup" << std::endl;
+  TxBenchmark benchmark;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      PhySimWifiPhy::ClearCache ();
+      double frameWise = benchmark.Run (modes[i], false, size, repetitions);
+      double pipeline = benchmark.Run (modes[i], true, size, repetitions);
+      std::cout << std::setw (28) << modes[i].GetUniqueName () << std::setw (14) << frameWise
+                << std::setw (14) << pipeline << std::setw (10) << pipeline / frameWise << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include "ns3/config.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/physim-helper.h"
+#include "physim-sinr-trace-writer.h"
+
+NS_LOG_COMPONENT_DEFINE ("PhySimSinrTraceWriter");
+
+namespace ns3 {
+
+static uint32_t
+GetNodeId (Ptr<NetDevice> device)
+{
+  if (device == 0 || device->GetNode () == 0)
+    {
+      return 0xffffffff;
+    }
+  return device->GetNode ()->GetId ();
+}
+
+PhySimSinrTraceWriter::PhySimSinrTraceWriter (std::string filename)
+  : m_records (0)
+{
+  m_stream.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_stream.is_open (), "PhySimSinrTraceWriter::PhySimSinrTraceWriter() - unable to open file " << filename);
+  m_stream.write ("PSNR", 4);
+  WriteValue<uint16_t> (VERSION);
+  WriteValue<uint16_t> (0);
+}
+
+PhySimSinrTraceWriter::~PhySimSinrTraceWriter ()
+{
+  m_stream.close ();
+}
+
+void
+PhySimSinrTraceWriter::ConnectAll (void)
+{
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::PhySimWifiPhy/SymbolSinr",
+                                 MakeCallback (&PhySimSinrTraceWriter::Write, this));
+}
+
+void
+PhySimSinrTraceWriter::Write (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag, bool success)
+{
+  std::vector<double> sinrs = tag->GetSymbolSinrs ();
+  NS_LOG_DEBUG ("PhySimSinrTraceWriter:Write() - packet " << packet->GetUid () << " with " << sinrs.size () << " symbols");
+
+  WriteValue<uint64_t> (Simulator::Now ().GetNanoSeconds ());
+  WriteValue<uint32_t> (GetNodeId (tag->GetRxNetDevice ()));
+  WriteValue<uint32_t> (GetNodeId (tag->GetTxNetDevice ()));
+  WriteValue<uint8_t> (itpp::bin2dec (PhySimHelper::CreateRateField (tag->GetRxWifiMode ())));
+  WriteValue<uint8_t> (success ? 1 : 0);
+  WriteValue<uint32_t> (tag->GetDetectedLength ());
+  WriteValue<uint32_t> (sinrs.size ());
+  for (std::vector<double>::const_iterator it = sinrs.begin (); it != sinrs.end (); ++it)
+    {
+      WriteValue<float> (*it);
+    }
+  m_records++;
+}
+
+uint64_t
+PhySimSinrTraceWriter::GetNRecords (void) const
+{
+  return m_records;
+}
+
+template <typename T>
+void
+PhySimSinrTraceWriter::WriteValue (T value)
+{
+  m_stream.write (reinterpret_cast<const char *> (&value), sizeof (T));
+}
+
+} // namespace ns3
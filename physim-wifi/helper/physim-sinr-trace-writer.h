@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#ifndef PHYSIM_SINR_TRACE_WRITER_H
+#define PHYSIM_SINR_TRACE_WRITER_H
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/packet.h"
+#include "ns3/physim-wifi-phy-tag.h"
+#include <fstream>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \brief Writes the per-OFDM-symbol SINR of every decoded frame into a compact binary file
+ *
+ * The writer is meant to be connected to the 'SymbolSinr' trace source of PhySimWifiPhy (which
+ * requires the attribute 'CalculateSymbolSinr' to be enabled), so that external tools can replay
+ * or fit error models to the SINR time series of each frame without parsing ASCII traces.
+ *
+ * The file starts with a header consisting of the four characters "PSNR", followed by a uint16
+ * format version and a reserved uint16 field. Each frame is then stored as one record with the
+ * following fields, all in host byte order:
+ *
+ *   uint64  reception time in nanoseconds
+ *   uint32  node id of the receiver (0xffffffff if unknown)
+ *   uint32  node id of the transmitter (0xffffffff if unknown)
+ *   uint8   the 4-bit IEEE 802.11 rate field of the frame
+ *   uint8   1 if the payload was decoded successfully, 0 otherwise
+ *   uint32  the length of the frame in bytes
+ *   uint32  the number N of OFDM symbols that follow
+ *   float32 N times the SINR of an OFDM symbol (in dB)
+ */
+class PhySimSinrTraceWriter : public SimpleRefCount<PhySimSinrTraceWriter>
+{
+public:
+  static const uint16_t VERSION = 1;
+
+  /**
+   * Opens the given file for writing and writes the file header.
+   * \param filename The name of the binary trace file
+   */
+  PhySimSinrTraceWriter (std::string filename);
+  ~PhySimSinrTraceWriter ();
+
+  /**
+   * Connects this writer to the 'SymbolSinr' trace source of all PhySimWifiPhy instances
+   * that exist at the time of calling.
+   */
+  void ConnectAll (void);
+  /**
+   * Trace sink that writes one record for the given frame.
+   * \param packet  The received packet
+   * \param tag     The tag of the received packet carrying the per-symbol SINR values
+   * \param success Whether the payload was decoded successfully
+   */
+  void Write (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag, bool success);
+  /**
+   * Returns the number of records that were written so far.
+   */
+  uint64_t GetNRecords (void) const;
+
+private:
+  template <typename T>
+  void WriteValue (T value);
+
+  std::ofstream m_stream;
+  uint64_t m_records;
+};
+
+} // namespace ns3
+
+#endif /* PHYSIM_SINR_TRACE_WRITER_H */
@@ -24,15 +24,64 @@
 #include "ns3/log.h"
 #include "physim-blockinterleaver.h"
 #include "physim-helper.h"
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("PhySimBlockInterleaver");
 
 namespace ns3 {
 
-NS_OBJECT_ENSURE_REGISTERED (PhySimBlockInterleaver);
+/*
+ * Interleaving and deinterleaving permutations (17.3.5.6) of the four block sizes of the eight IEEE 802.11a/p
+ * rates, i.e. N_CBPS = 48, 96, 192 and 288 coded bits per symbol (N_BPSC = 1, 2, 4 and 6).
+ */
+class PhySimInterleaverTables
+{
+public:
+  PhySimInterleaverTables ()
+  {
+    const uint32_t bitsPerCarrier[4] = { 1, 2, 4, 6 };
+    for (uint32_t t = 0; t < 4; t++)
+      {
+        uint32_t ncbps = 48 * bitsPerCarrier[t];
+        uint32_t s = std::max (bitsPerCarrier[t] / 2, (uint32_t) 1); // Equation 17-17
+        for (uint32_t k = 0; k < ncbps; k++)
+          {
+            // Equations 17-15 and 17-16: new position of bit k
+            uint32_t i = (ncbps / 16) * (k % 16) + k / 16;
+            m_interleave[t][k] = s * (i / s) + (i + ncbps - (16 * i) / ncbps) % s;
+          }
+        for (uint32_t j = 0; j < ncbps; j++)
+          {
+            // Equations 17-18 and 17-19: original position of received bit j
+            uint32_t i = s * (j / s) + (j + (16 * j) / ncbps) % s;
+            m_deinterleave[t][j] = 16 * i - (ncbps - 1) * ((16 * i) / ncbps);
+          }
+      }
+  }
+  static uint32_t GetIndex (uint32_t ncbps)
+  {
+    switch (ncbps)
+      {
+      case 48:
+        return 0;
+      case 96:
+        return 1;
+      case 192:
+        return 2;
+      case 288:
+        return 3;
+      default:
+        NS_FATAL_ERROR ("PhySimInterleaverTables::GetIndex(): unsupported number of coded bits per symbol " << ncbps);
+        return 0;
+      }
+  }
+  uint16_t m_interleave[4][288];
+  uint16_t m_deinterleave[4][288];
+};
+
+static const PhySimInterleaverTables g_interleaverTables;
 
-std::map<uint32_t, itpp::ivec> PhySimBlockInterleaver::m_iCache;
-std::map<uint32_t, itpp::ivec> PhySimBlockInterleaver::m_diCache;
+NS_OBJECT_ENSURE_REGISTERED (PhySimBlockInterleaver);
 
 TypeId
 PhySimBlockInterleaver::GetTypeId (void)
@@ -47,6 +96,9 @@ PhySimBlockInterleaver::GetTypeId (void)
 PhySimBlockInterleaver::PhySimBlockInterleaver ()
 {
   m_zeropadding = 0;
+  m_NCBPS = 48;
+  m_iIndex = g_interleaverTables.m_interleave[0];
+  m_diIndex = g_interleaverTables.m_deinterleave[0];
 }
 
 PhySimBlockInterleaver::~PhySimBlockInterleaver ()
@@ -63,6 +115,10 @@ itpp::bvec
 PhySimBlockInterleaver::InterleaveBlock (const itpp::bvec& bits)
 {
   m_zeropadding = GetPadding (bits.size ()); // calculate zero padding size
+  if (m_zeropadding == 0)
+    {
+      return Interleave (bits);
+    }
   int sizeWithPadding = bits.size () + m_zeropadding;
 
   itpp::bvec input (sizeWithPadding);
@@ -74,7 +130,7 @@ PhySimBlockInterleaver::InterleaveBlock (const itpp::bvec& bits)
   // output[i1]=input[0], output[i2]=input[2] and so on
   for (int k = 0; k < sizeWithPadding; ++k)
     { // applies interleaving index to the input vector
-      output (iIndex (k)) = input (k);
+      output (m_iIndex[k % m_NCBPS] + k - k % m_NCBPS) = input (k);
     }
 
   return output;
@@ -93,13 +149,17 @@ itpp::vec
 PhySimBlockInterleaver::DeinterleaveBlock (const itpp::vec& bits)
 {
   m_zeropadding = GetPadding (bits.size ()); // calculate zero padding size
+  if (m_zeropadding == 0)
+    {
+      return Deinterleave (bits);
+    }
   int sizeWithPadding = bits.size () + m_zeropadding;
 
   itpp::vec deint (sizeWithPadding);
 
   for (int k = 0; k < sizeWithPadding; k++)
     { // applies deinterleaving index to the input vector
-      deint (diIndex (k)) = bits (k);
+      deint (m_diIndex[k % m_NCBPS] + k - k % m_NCBPS) = bits (k);
     }
 
   itpp::vec output = deint.split (bits.size () - m_zeropadding); // removes zero-padding bits
@@ -111,90 +171,65 @@ PhySimBlockInterleaver::SetWifiMode (const WifiMode mode)
 {
   m_NCBPS = PhySimHelper::GetNCBPS (mode);
 
-  uint32_t m_NBPSC = (m_NCBPS / 48);
-  // According to Equation 17-17
-  uint32_t m_s = itpp::ceil_i (static_cast<double> (m_NBPSC) / 2.0);
-
   // Adjust interleaving index according to selected wifi mode
-  std::map<uint32_t, itpp::ivec>::iterator it = m_iCache.find (m_NCBPS);
-  if (it != m_iCache.end ())
-    {
-      iIndex = it->second;
-    }
-  else
-    {
-      iIndex = InterleavingIndex (m_NCBPS, m_s);
-      m_iCache.insert ( std::pair<uint32_t, itpp::ivec> (m_NCBPS, iIndex) );
-    }
-
-  // Adjust interleaving index according to selected wifi mode
-  it = m_diCache.find (m_NCBPS);
-  if (it != m_diCache.end ())
-    {
-      diIndex = it->second;
-    }
-  else
-    {
-      diIndex = DeinterleavingIndex (m_NCBPS, m_s);
-      m_diCache.insert ( std::pair<uint32_t, itpp::ivec> (m_NCBPS, diIndex) );
-    }
+  uint32_t index = PhySimInterleaverTables::GetIndex (m_NCBPS);
+  m_iIndex = g_interleaverTables.m_interleave[index];
+  m_diIndex = g_interleaverTables.m_deinterleave[index];
 }
 
 /*
- * Creates an interleaving index, which contains the new positions
- * of the bits. So an interleaving index element
- * i[0] will contain as a value the position that element 0
- * should have in the bit stream.
- *
- * @param sizeWithPadding the block size
- * @return interleaving index
+ * \brief Interleaves all blocks of a frame. Each output bit is gathered from the
+ * position given by the deinterleaving index, which is the inverse permutation.
+ * @param bits input bits
+ * @return interleaved bits
  */
-itpp::ivec
-PhySimBlockInterleaver::InterleavingIndex (uint32_t sizeWithPadding, uint32_t m_s)
+itpp::bvec
+PhySimBlockInterleaver::Interleave (const itpp::bvec& bits) const
 {
-  itpp::ivec firstindex (sizeWithPadding);
-
-  // First permutation 17.3.5.6, Equation 17-15
-  for (uint32_t k = 0; k < sizeWithPadding; k++)
+  NS_ASSERT (bits.size () % m_NCBPS == 0);
+  itpp::bvec output (bits.size ());
+  for (int32_t block = 0; block < bits.size (); block += m_NCBPS)
     {
-      firstindex (k) = (sizeWithPadding / 16) * itpp::mod (k, 16) + itpp::floor_i (k / 16);
+      InterleaveBlock (bits._data () + block, output._data () + block);
     }
+  return output;
+}
 
-  itpp::ivec secondindex (sizeWithPadding);
-
-  // Second permutation 17.3.5.6, Equation 17-16
-  for (uint32_t k = 0; k < sizeWithPadding; k++)
+void
+PhySimBlockInterleaver::InterleaveBlock (const itpp::bin *input, itpp::bin *output) const
+{
+  for (uint32_t k = 0; k < m_NCBPS; ++k)
     {
-      secondindex (k) = m_s * itpp::floor_i (firstindex (k) / m_s) +
-        itpp::mod (firstindex (k) + sizeWithPadding - itpp::floor_i (16 * firstindex (k) / sizeWithPadding),
-                   m_s);
+      output[k] = input[m_diIndex[k]];
     }
-
-  return secondindex;
 }
 
 /*
- * Same as the InterleavingIndex, but used for deinterleaving.
- * @param sizeWithPadding the blocksize
- * @return deinterleaving index
+ * \brief Deinterleaves all blocks of a frame, gathering through the interleaving index.
+ * @param bits input (soft) bits
+ * @return de-interleaved bits
  */
-itpp::ivec
-PhySimBlockInterleaver::DeinterleavingIndex (uint32_t sizeWithPadding, uint32_t m_s)
+itpp::vec
+PhySimBlockInterleaver::Deinterleave (const itpp::vec& bits) const
 {
-  itpp::ivec firstindex (sizeWithPadding);
-  for (uint32_t j = 0; j < sizeWithPadding; j++)
+  NS_ASSERT (bits.size () % m_NCBPS == 0);
+  itpp::vec output (bits.size ());
+  const double *input = bits._data ();
+  double *deinterleaved = output._data ();
+  for (int32_t block = 0; block < bits.size (); block += m_NCBPS)
     {
-      firstindex (j) = m_s * itpp::floor_i (j / m_s) + itpp::mod (j + itpp::floor_i (16 * j
-                                                                                     / (sizeWithPadding)), m_s); // Equation 17-18
+      for (uint32_t k = 0; k < m_NCBPS; ++k)
+        {
+          deinterleaved[block + k] = input[block + m_iIndex[k]];
+        }
     }
+  return output;
+}
 
-  itpp::ivec secondindex (sizeWithPadding);
-  for (uint32_t j = 0; j < sizeWithPadding; j++)
-    {
-      secondindex (j) = 16 * firstindex (j) - (sizeWithPadding - 1) * itpp::floor_i (
-          16 * firstindex (j) / sizeWithPadding);
-    }
-  return secondindex;
+const uint16_t *
+PhySimBlockInterleaver::GetDeinterleavingPositions (void) const
+{
+  return m_diIndex;
 }
 
 /*!
@@ -25,7 +25,7 @@
 
 #include "ns3/object.h"
 #include "ns3/wifi-mode.h"
-#include <map>
+#include <stdint.h>
 #include <itpp/itcomm.h>
 
 namespace ns3 {
@@ -46,18 +46,39 @@ public:
   itpp::vec DeinterleaveBlock (const itpp::vec& bits);
   void SetWifiMode (const WifiMode mode);
 
+  /**
+   * Interleaves all blocks of a frame in one pass
+   * \param bits The coded bits of the frame, a multiple of the number of coded bits per symbol
+   * \return     The interleaved bits
+   */
+  itpp::bvec Interleave (const itpp::bvec& bits) const;
+  /**
+   * Deinterleaves all blocks of a frame in one pass
+   * \param bits The (soft) bits of the frame, a multiple of the number of coded bits per symbol
+   * \return     The deinterleaved bits
+   */
+  itpp::vec Deinterleave (const itpp::vec& bits) const;
+  /**
+   * Interleaves a single block of the current mode
+   * \param input  The coded bits of one OFDM symbol
+   * \param output Buffer for the interleaved bits, of the same size
+   */
+  void InterleaveBlock (const itpp::bin *input, itpp::bin *output) const;
+  /**
+   * \return The deinterleaving permutation of the current mode: element k of a received block is moved to
+   *         position GetDeinterleavingPositions ()[k]
+   */
+  const uint16_t * GetDeinterleavingPositions (void) const;
+
 private:
-  itpp::ivec InterleavingIndex (uint32_t sizeWithPadding, uint32_t m_s);
-  itpp::ivec DeinterleavingIndex (uint32_t sizeWithPadding, uint32_t m_s);
   uint32_t GetPadding (uint32_t size);
 
   uint32_t m_NCBPS;             // Number of coded bits per OFDM symbol
   uint32_t m_zeropadding;       // number of zeros added to the last interleaved packet
-  itpp::ivec iIndex,diIndex;
 
-  // for performance optimization
-  static std::map<uint32_t, itpp::ivec> m_iCache;
-  static std::map<uint32_t, itpp::ivec> m_diCache;
+  // Permutations of the current mode, taken from the precomputed tables
+  const uint16_t *m_iIndex;
+  const uint16_t *m_diIndex;
 
 };
 
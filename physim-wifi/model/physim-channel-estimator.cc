@@ -24,6 +24,7 @@
 #include "physim-ofdm-symbolcreator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("PhySimChannelEstimator");
 
@@ -94,6 +95,39 @@ PhySimChannelEstimator::ApplyOFDMSymbolCorrection (const itpp::cvec &input, uint
   return input;
 }
 
+/*
+ * \brief Called for a sequence of OFDM symbols to apply the channel estimation and correction in place
+ *
+ * @param subcarriers frequency domain representations (53 values each) of the OFDM symbols
+ * @param numSymbols number of OFDM symbols
+ * @param firstSymbolNo 0 for SIGNAL, 1..n for the rest of the OFDM symbols
+ */
+void
+PhySimChannelEstimator::ApplyOFDMSymbolCorrections (std::complex<double> *subcarriers, uint32_t numSymbols, uint32_t firstSymbolNo)
+{
+  for (uint32_t i = 0; i < numSymbols; ++i)
+    {
+      std::complex<double> *symbol = subcarriers + 53 * i;
+      itpp::cvec corrected = ApplyOFDMSymbolCorrection (itpp::cvec (symbol, 53), firstSymbolNo + i);
+      std::copy (corrected._data (), corrected._data () + 53, symbol);
+    }
+}
+
+/*
+ * \brief Multiplies the subcarriers with the pilot ratios, linearly interpolated over 17 subcarriers each.
+ */
+void
+PhySimChannelEstimator::ApplyPilotInterpolation (std::complex<double> *subcarriers, const std::complex<double> *ratio)
+{
+  // 52 interpolated factors for the subcarriers except the DC at position 26
+  for (uint32_t i = 0; i < 52; ++i)
+    {
+      uint32_t k = i / 17;
+      std::complex<double> factor = (k < 3) ? ratio[k] + (ratio[k + 1] - ratio[k]) / 17.0 * (double) (i % 17) : ratio[3];
+      subcarriers[(i < 26) ? i : i + 1] *= factor;
+    }
+}
+
 void
 PhySimChannelEstimator::SetDetectedNoise (const double estN0)
 {
@@ -185,6 +219,23 @@ PhySimSimpleChannelEstimator::ApplyOFDMSymbolCorrection (const itpp::cvec &input
   return result;
 }
 
+void
+PhySimSimpleChannelEstimator::ApplyOFDMSymbolCorrections (std::complex<double> *subcarriers, uint32_t numSymbols, uint32_t firstSymbolNo)
+{
+  std::complex<double> pilots[4];
+  std::complex<double> ratio[4];
+  for (uint32_t i = 0; i < numSymbols; ++i)
+    {
+      std::complex<double> *symbol = subcarriers + 53 * i;
+      PhySimOFDMSymbolCreator::GetPilotSubcarrier (firstSymbolNo + i, pilots);
+      ratio[0] = pilots[0] / symbol[5];
+      ratio[1] = pilots[1] / symbol[19];
+      ratio[2] = pilots[2] / symbol[33];
+      ratio[3] = pilots[3] / symbol[47];
+      ApplyPilotInterpolation (symbol, ratio);
+    }
+}
+
 void
 PhySimSimpleChannelEstimator::Reset ()
 {
@@ -321,6 +372,45 @@ PhySimChannelFrequencyOffsetEstimator::ApplyOFDMSymbolCorrection (const itpp::cv
   return result;
 }
 
+void
+PhySimChannelFrequencyOffsetEstimator::ApplyOFDMSymbolCorrections (std::complex<double> *subcarriers, uint32_t numSymbols, uint32_t firstSymbolNo)
+{
+  const uint32_t pilotPositions[4] = { 5, 19, 33, 47 };
+  std::complex<double> refpilots[4];
+  std::complex<double> ratio[4];
+  for (uint32_t i = 0; i < numSymbols; ++i)
+    {
+      std::complex<double> *symbol = subcarriers + 53 * i;
+      PhySimOFDMSymbolCreator::GetPilotSubcarrier (firstSymbolNo + i, refpilots);
+
+      // Residual carrier frequency offset, see CalculateResidualCarrierFreqOffset ()
+      std::complex<double> sum = 0;
+      for (uint32_t k = 0; k < 4; ++k)
+        {
+          sum += symbol[pilotPositions[k]] * refpilots[k] * std::conj (m_channelGains (k));
+        }
+      double estimator = std::arg (sum);
+      if (isnan (estimator))
+        {
+          NS_LOG_WARN ("PhySimChannelFrequencyOffsetEstimator::ApplyOFDMSymbolCorrections() - Estimator not valid");
+        }
+      else
+        {
+          std::complex<double> rotation (cos (estimator), sin (-1 * estimator));
+          for (uint32_t k = 0; k < 53; ++k)
+            {
+              symbol[k] *= rotation;
+            }
+        }
+
+      for (uint32_t k = 0; k < 4; ++k)
+        {
+          ratio[k] = refpilots[k] / symbol[pilotPositions[k]];
+        }
+      ApplyPilotInterpolation (symbol, ratio);
+    }
+}
+
 void
 PhySimChannelFrequencyOffsetEstimator::Reset ()
 {
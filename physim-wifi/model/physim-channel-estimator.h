@@ -50,12 +50,27 @@ public:
   virtual double GetInitialChannelEstimation (const itpp::cvec &input);
   virtual itpp::cvec ApplyEstimateFromTrainingSequence (const itpp::cvec &input, double estimate, int phaseOffset);
   virtual itpp::cvec ApplyOFDMSymbolCorrection (const itpp::cvec &input, uint32_t symbolNo);
+  /**
+   * Applies the per-symbol correction to several consecutive OFDM symbols in place. The default implementation
+   * calls ApplyOFDMSymbolCorrection for each symbol, sub-classes may provide an allocation-free version.
+   * \param subcarriers   The frequency domain representations (53 values each) of the OFDM symbols
+   * \param numSymbols    The number of OFDM symbols
+   * \param firstSymbolNo The number of the first OFDM symbol (0 for SIGNAL, 1..n for DATA symbols)
+   */
+  virtual void ApplyOFDMSymbolCorrections (std::complex<double> *subcarriers, uint32_t numSymbols, uint32_t firstSymbolNo);
   virtual void SetDetectedNoise (const double estN0);
   virtual double GetDetectedNoise ();
   virtual void Reset ();
 
   static itpp::cvec GetPilots (const itpp::cvec& input);
 
+protected:
+  /**
+   * Multiplies the 53 subcarriers of an OFDM symbol with the linear interpolation of the given pilot ratios,
+   * in the same way as itpp::lininterp (ratio, 17) with the DC kept unchanged
+   */
+  static void ApplyPilotInterpolation (std::complex<double> *subcarriers, const std::complex<double> *ratio);
+
 private:
   double m_N0;
 };
@@ -82,6 +97,7 @@ public:
 
   itpp::cvec ApplyEstimateFromTrainingSequence (const itpp::cvec &input, double estimate, int phaseOffset);
   itpp::cvec ApplyOFDMSymbolCorrection (const itpp::cvec &input, uint32_t symbolNo);
+  void ApplyOFDMSymbolCorrections (std::complex<double> *subcarriers, uint32_t numSymbols, uint32_t firstSymbolNo);
   void Reset ();
 
 };
@@ -109,6 +125,7 @@ public:
 
   itpp::cvec ApplyEstimateFromTrainingSequence (const itpp::cvec &input, double estimate, int phaseOffset);
   itpp::cvec ApplyOFDMSymbolCorrection (const itpp::cvec &input, uint32_t symbolNo);
+  void ApplyOFDMSymbolCorrections (std::complex<double> *subcarriers, uint32_t numSymbols, uint32_t firstSymbolNo);
   void Reset ();
 
 private:
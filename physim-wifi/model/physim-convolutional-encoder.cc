@@ -23,12 +23,57 @@
 #include "ns3/object.h"
 #include "ns3/log.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "physim-convolutional-encoder.h"
 
 NS_LOG_COMPONENT_DEFINE ("PhySimConvolutionalEncoder");
 
 namespace ns3 {
 
+/*
+ * Output of the rate 1/2 mother code for every encoder state and input byte. Bit 2i (2i+1) of the output holds the
+ * output of generator g0 (g1) for the i-th input bit, where input bits are processed from the LSB to the MSB.
+ */
+class PhySimConvolutionalTable
+{
+public:
+  PhySimConvolutionalTable ()
+  {
+    for (uint32_t state = 0; state < 64; state++)
+      {
+        for (uint32_t byte = 0; byte < 256; byte++)
+          {
+            uint32_t reg = state;
+            uint16_t output = 0;
+            for (uint32_t i = 0; i < 8; i++)
+              {
+                reg |= ((byte >> i) & 1) << 6;
+                output |= Parity (reg & 0133) << (2 * i);
+                output |= Parity (reg & 0171) << (2 * i + 1);
+                reg >>= 1;
+              }
+            m_output[state][byte] = output;
+            m_nextState[state][byte] = reg;
+          }
+      }
+  }
+  uint16_t m_output[64][256];
+  uint8_t m_nextState[64][256];
+
+private:
+  static uint16_t Parity (uint32_t value)
+  {
+    uint16_t parity = 0;
+    for (; value; value >>= 1)
+      {
+        parity ^= value & 1;
+      }
+    return parity;
+  }
+};
+
+static const PhySimConvolutionalTable g_convolutionalTable;
+
 NS_OBJECT_ENSURE_REGISTERED (PhySimConvolutionalEncoder);
 
 TypeId
@@ -42,13 +87,31 @@ PhySimConvolutionalEncoder::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PhySimConvolutionalEncoder::m_softViterbiDecision),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseNativeViterbi",
+                   "Flag indicating whether the dedicated 64-state Viterbi decoder (PhySimViterbiDecoder) should be used "
+                   "instead of the generic IT++ decoder. With the default ViterbiTracebackDepth of 0 both produce identical results.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PhySimConvolutionalEncoder::m_useNativeViterbi),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ViterbiTracebackDepth",
+                   "Traceback depth (in trellis steps) of the sliding window of the native Viterbi decoder, which bounds "
+                   "its memory independent of the frame length. A depth of 0 traces back the whole frame at once, exactly as "
+                   "IT++ does, while a sliding window may decode differently if the survivor paths have not merged within it.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PhySimConvolutionalEncoder::SetTracebackDepth,
+                                         &PhySimConvolutionalEncoder::GetTracebackDepth),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 PhySimConvolutionalEncoder::PhySimConvolutionalEncoder ()
+  : m_softViterbiDecision (false),
+    m_useNativeViterbi (false),
+    m_tracebackDepth (0)
 {
   SetupGenPolynomials ();
+  SetCodingRate (WIFI_CODE_RATE_1_2);
 }
 
 PhySimConvolutionalEncoder::~PhySimConvolutionalEncoder ()
@@ -65,6 +128,65 @@ PhySimConvolutionalEncoder::Encode (const itpp::bvec& bits)
   return encoded.mid (0, encoded.size () - GetTailSize (m_codingRate));
 }
 
+/*
+ * \brief Encode packed bits according to 17.3.5.5 in Std., one input byte at a time.
+ */
+uint32_t
+PhySimConvolutionalEncoder::Encode (const PhySimPackedBits& bits, itpp::bin *output) const
+{
+  const uint8_t *input = bits.GetBytes ();
+  uint32_t numBits = bits.GetNBits ();
+  uint32_t state = 0;
+  uint32_t phase = 0;
+  uint32_t k = 0;
+  for (uint32_t i = 0; i < numBits / 8; i++)
+    {
+      k += EncodeByte (input[i], 8, state, phase, output + k);
+    }
+
+  // Remaining bits of an incomplete last byte (the unused bits of the byte are zero)
+  if (numBits % 8 > 0)
+    {
+      k += EncodeByte (input[numBits / 8], numBits % 8, state, phase, output + k);
+    }
+  return k;
+}
+
+uint32_t
+PhySimConvolutionalEncoder::EncodeByte (uint8_t byte, uint32_t numBits, uint32_t &state, uint32_t &phase, itpp::bin *output) const
+{
+  uint32_t encoded = g_convolutionalTable.m_output[state][byte];
+  const uint8_t *positions = m_keptPositions[phase];
+  uint32_t k = 0;
+  for (uint32_t j = 0; j < m_keptCount[phase] && positions[j] < 2 * numBits; j++)
+    {
+      output[k++] = (encoded >> positions[j]) & 1;
+    }
+  state = g_convolutionalTable.m_nextState[state][byte];
+  phase = (phase + numBits) % m_puncturePeriod;
+  return k;
+}
+
+uint32_t
+PhySimConvolutionalEncoder::GetEncodedSize (uint32_t numBits) const
+{
+  uint32_t size = (numBits / 8) * 16;
+  uint32_t phase = 0;
+  for (uint32_t i = 0; i < numBits / 8; i++)
+    {
+      size -= 16 - m_keptCount[phase];
+      phase = (phase + 8) % m_puncturePeriod;
+    }
+  for (uint32_t j = 0; j < m_keptCount[phase]; j++)
+    {
+      if (m_keptPositions[phase][j] < 2 * (numBits % 8))
+        {
+          size++;
+        }
+    }
+  return size;
+}
+
 /*
  * \brief Decodes soft or hard bits using conv. decoding.
  */
@@ -95,17 +217,38 @@ PhySimConvolutionalEncoder::Decode (const itpp::vec& bits)
         }
       // Have to add a tail for the decoder to do its job
       temp.ins (temp.size (), tail);
+      if (m_useNativeViterbi)
+        {
+          return m_viterbi.Decode (temp, true);
+        }
       return m_code.decode (temp);
     }
   else
     {
       // do soft decoding
       itpp::vec temp = concat (bits, tail);
+      if (m_useNativeViterbi)
+        {
+          return m_viterbi.Decode (temp, false);
+        }
       return m_code.decode (temp);
     }
 
 }
 
+void
+PhySimConvolutionalEncoder::SetTracebackDepth (uint32_t depth)
+{
+  m_tracebackDepth = depth;
+  m_viterbi.SetTracebackDepth (depth);
+}
+
+uint32_t
+PhySimConvolutionalEncoder::GetTracebackDepth (void) const
+{
+  return m_tracebackDepth;
+}
+
 /*!
  * \brief Sets up punctured convolutional code for a given coding rate.
  *
@@ -132,6 +275,24 @@ PhySimConvolutionalEncoder::SetCodingRate (enum WifiCodeRate rate)
       punc_matrix = "1;1";
     }
   m_code.set_puncture_matrix (punc_matrix);
+  m_viterbi.SetCodingRate (m_codingRate);
+
+  // Transmitted positions within the 16 encoded bits of an input byte, for every phase of the byte
+  m_puncturePeriod = punc_matrix.cols ();
+  for (uint32_t phase = 0; phase < m_puncturePeriod; phase++)
+    {
+      m_keptCount[phase] = 0;
+      for (uint32_t i = 0; i < 8; i++)
+        {
+          for (uint32_t j = 0; j < 2; j++)
+            {
+              if (punc_matrix (j, (phase + i) % m_puncturePeriod) == 1)
+                {
+                  m_keptPositions[phase][m_keptCount[phase]++] = 2 * i + j;
+                }
+            }
+        }
+    }
 }
 
 void
@@ -25,6 +25,8 @@
 
 #include "ns3/object.h"
 #include "ns3/wifi-mode.h"
+#include "physim-packed-bits.h"
+#include "physim-viterbi-decoder.h"
 #include <itpp/itcomm.h>
 
 namespace ns3 {
@@ -47,13 +49,52 @@ public:
   itpp::bvec Encode (const itpp::bvec& bits);
   itpp::bvec Decode (const itpp::vec& bits);
 
+  /**
+   * Encodes packed bits with a precomputed state table, which produces 16 output bits per input byte, and
+   * applies the puncturing of the current coding rate inline. The encoder starts in the zero state and, as
+   * for Encode (const itpp::bvec&), no tail is appended.
+   * \param bits   The input bits
+   * \param output Caller-provided buffer of at least GetEncodedSize (bits.GetNBits ()) elements
+   * \return       The number of encoded bits written to the buffer
+   */
+  uint32_t Encode (const PhySimPackedBits& bits, itpp::bin *output) const;
+  /**
+   * \param numBits The number of input bits
+   * \return        The number of encoded bits at the current coding rate
+   */
+  uint32_t GetEncodedSize (uint32_t numBits) const;
+  /**
+   * Encodes a single input byte of a stream with the precomputed state table and applies the puncturing of the
+   * current coding rate. Calling this for every byte, starting with state and phase 0, gives the same result as
+   * Encode (const PhySimPackedBits&, itpp::bin *).
+   * \param byte    The input bits, least significant bit first
+   * \param numBits The number of valid bits (1..8), the unused bits of the byte have to be zero
+   * \param state   The state of the encoder, updated
+   * \param phase   The position within the puncturing period, updated
+   * \param output  Buffer of at least 16 elements
+   * \return        The number of encoded bits written to the buffer
+   */
+  uint32_t EncodeByte (uint8_t byte, uint32_t numBits, uint32_t &state, uint32_t &phase, itpp::bin *output) const;
+
 private:
+  void SetTracebackDepth (uint32_t depth);
+  uint32_t GetTracebackDepth (void) const;
+
   void SetupGenPolynomials ();
   int GetTailSize (enum WifiCodeRate rate);
 
   itpp::Punctured_Convolutional_Code m_code;
   enum WifiCodeRate m_codingRate;
   bool m_softViterbiDecision;
+  bool m_useNativeViterbi;
+  uint32_t m_tracebackDepth;
+
+  // Puncturing of the current coding rate: period (in input bits), and for each phase of an input byte with
+  // respect to the period the positions of the transmitted bits among the 16 encoded bits of the byte
+  uint32_t m_puncturePeriod;
+  uint8_t m_keptCount[3];
+  uint8_t m_keptPositions[3][16];
+  PhySimViterbiDecoder m_viterbi;
 
 };
 
@@ -86,6 +86,51 @@ PhySimHelper::GetOFDMSymbolSignalStrength (const itpp::cvec block)
   return ( energy / block.size () );
 }
 
+double
+PhySimHelper::GetOFDMSymbolSignalStrength (const std::complex<double> *block, uint32_t length)
+{
+  double energy = 0.0;
+  for ( uint32_t i = 0; i < length; i++ )
+    {
+      energy += norm (block[i]);
+    }
+  return ( energy / length );
+}
+
+std::complex<double>
+PhySimHelper::ComplexMac (const std::complex<double> *a, const std::complex<double> *b, uint32_t length)
+{
+  // std::complex<double> is laid out as two consecutive doubles (real, imaginary)
+  const double *x = reinterpret_cast<const double *> (a);
+  const double *y = reinterpret_cast<const double *> (b);
+  double re[4] = { 0.0, 0.0, 0.0, 0.0 };
+  double im[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+  uint32_t i = 0;
+  for (; i + 4 <= length; i += 4)
+    {
+      for (uint32_t l = 0; l < 4; l++)
+        {
+          double xr = x[2 * (i + l)];
+          double xi = x[2 * (i + l) + 1];
+          double yr = y[2 * (i + l)];
+          double yi = y[2 * (i + l) + 1];
+          re[l] += xr * yr - xi * yi;
+          im[l] += xr * yi + xi * yr;
+        }
+    }
+  for (; i < length; i++)
+    {
+      double xr = x[2 * i];
+      double xi = x[2 * i + 1];
+      double yr = y[2 * i];
+      double yi = y[2 * i + 1];
+      re[0] += xr * yr - xi * yi;
+      im[0] += xr * yi + xi * yr;
+    }
+  return std::complex<double> ((re[0] + re[1]) + (re[2] + re[3]), (im[0] + im[1]) + (im[2] + im[3]));
+}
+
 double
 PhySimHelper::DbmToW (double dbm)
 {
@@ -532,7 +577,7 @@ PhySimHelper::isPayloadDecodable(itpp::cvec samples, Ptr<const PhySimWifiPhyTag>
 
   // calculate length, get Wifi mode, etc...
   WifiMode mode = tag->GetTxWifiMode ();
-  uint32_t length = tag->GetTxedDataBits ().size();
+  uint32_t length = tag->PeekTxedDataBits ().size ();
   uint32_t tailNservice = 22;   // service field (16 bits) plus tail bits (6 bits)
   uint32_t ndbps = PhySimHelper::GetNDBPS (mode);
   uint32_t padding = ndbps - (tailNservice + length) % (ndbps);
@@ -574,7 +619,7 @@ PhySimHelper::isPayloadDecodable(itpp::cvec samples, Ptr<const PhySimWifiPhyTag>
   uint32_t nDATA = numSymbols * ndbps; // Equation 17-12 - length of data field
   itpp::bvec finalData = DATA (16, nDATA - padding - 6 - 1);
 
-  return (finalData == tag->GetTxedDataBits ());
+  return (finalData == tag->PeekTxedDataBits ());
 }
 
 } // namespace ns3
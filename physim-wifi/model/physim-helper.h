@@ -66,6 +66,24 @@ public:
    * \return      The normalized/average energy over the whole block of complex time samples
    */
   static double GetOFDMSymbolSignalStrength (const itpp::cvec block);
+  /**
+   * Same as GetOFDMSymbolSignalStrength (const itpp::cvec block), but operates on a plain buffer of
+   * complex time samples, e.g. a slice of a larger vector, without copying it first.
+   * \param block  Pointer to the first complex time sample of the block
+   * \param length The number of samples in the block
+   * \return       The normalized/average energy over the whole block of complex time samples
+   */
+  static double GetOFDMSymbolSignalStrength (const std::complex<double> *block, uint32_t length);
+  /**
+   * Complex multiply-accumulate kernel, i.e. returns the sum of a[i] * b[i] for i = 0 .. length-1. Real and imaginary
+   * parts are accumulated in four independent lanes of plain doubles, which allows the compiler to map the loop onto
+   * SIMD instructions (e.g. AVX2) and avoids the special case handling of the complex<double> multiplication.
+   * \param a      Pointer to the first input sequence
+   * \param b      Pointer to the second input sequence
+   * \param length The number of elements in both sequences
+   * \return       The sum of the element-wise products
+   */
+  static std::complex<double> ComplexMac (const std::complex<double> *a, const std::complex<double> *b, uint32_t length);
   /**
    * Calculates the power of complex time sample, which is actually the standard norm on complex values.
    */
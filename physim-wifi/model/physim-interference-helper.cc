@@ -28,6 +28,8 @@
 #include "ns3/simulator.h"
 #include "ns3/boolean.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("PhySimInterferenceHelper");
 
@@ -76,7 +78,7 @@ PhySimInterferenceHelper::Event::Overlaps (Time time) const
 uint32_t
 PhySimInterferenceHelper::Event::GetSize (void) const
 {
-  return (m_tag->GetTxedDataBits ().size ());
+  return (m_tag->PeekTxedDataBits ().size ());
 }
 
 WifiMode
@@ -152,13 +154,38 @@ PhySimInterferenceHelper::GetTypeId (void)
                    "time back to which packets (or their signals) are stored in order to correctly model cumulative noise.",
                    TimeValue (NanoSeconds(10968000)),
                    MakeTimeAccessor (&PhySimInterferenceHelper::m_maxPacketDuration),
-                   MakeTimeChecker());
+                   MakeTimeChecker())
+    .AddAttribute ("CounterBasedNoise",
+                   "Generate the background noise of each sample on demand from (NoiseSeed, node id, sample index) instead of "
+                   "storing previously generated noise chunks. Results are reproducible independent of the order of requests.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PhySimInterferenceHelper::m_counterBasedNoise),
+                   MakeBooleanChecker ())
+    .AddAttribute ("NoiseSeed",
+                   "The seed of the counter based background noise generator (only used if CounterBasedNoise is enabled).",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PhySimInterferenceHelper::m_noiseSeed),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("UseEnergyTimeline",
+                   "Answer CCA energy queries (IsEnergyReached, GetEnergyDuration) from an incrementally updated timeline of "
+                   "per-block energies instead of synthesizing the cumulative samples. Energies of overlapping frames and the "
+                   "noise floor are added incoherently and blocks are aligned to absolute sample indices, which is an approximation.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PhySimInterferenceHelper::m_useEnergyTimeline),
+                   MakeBooleanChecker ());
   return tid;
 }
 
 PhySimInterferenceHelper::PhySimInterferenceHelper ()
   : m_noNoise (false),
+    m_counterBasedNoise (false),
+    m_noiseSeed (1),
+    m_noiseStream (0),
     m_symbolDuration (MicroSeconds (4)),
+    m_treeBase (0),
+    m_firstSequence (0),
+    m_useEnergyTimeline (false),
+    m_energyTimelineBase (0),
     m_maxPacketDuration (MicroSeconds (0))
 {
 }
@@ -177,6 +204,10 @@ Time
 PhySimInterferenceHelper::GetEnergyDuration (double energydBm)
 {
   NS_LOG_FUNCTION (energydBm);
+  if (m_useEnergyTimeline)
+    {
+      return GetTimelineEnergyDuration (energydBm);
+    }
   Time now = Simulator::Now ();
   Time duration = MicroSeconds (0);
 
@@ -184,11 +215,13 @@ PhySimInterferenceHelper::GetEnergyDuration (double energydBm)
   // transmission
   Time max = now;
 
-  Events::iterator i = m_events.begin ();
-  while (i != m_events.end ())
+  uint64_t nowIndex = RoundTimeToIndex (now);
+  std::vector<const EventEntry *> candidates;
+  GetCandidateEvents (nowIndex, nowIndex, candidates);
+  for (std::vector<const EventEntry *>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
     {
-      Time start = (*i)->GetStartTime ();
-      Time end = (*i)->GetEndTime ();
+      Time start = (*i)->event->GetStartTime ();
+      Time end = (*i)->event->GetEndTime ();
       if (start <= now && end >= now)
         {
           if (end > max)
@@ -196,7 +229,6 @@ PhySimInterferenceHelper::GetEnergyDuration (double energydBm)
               max = end;
             }
         }
-      i++;
     }
 
   // If there is no interfering packet, simply return 0
@@ -209,12 +241,13 @@ PhySimInterferenceHelper::GetEnergyDuration (double energydBm)
 
   // We add one symbol duration to make sure we do not skip the last frame
   // due to partial overlap or rather not having enough samples
-  itpp::cvec cumNoise = GetCumulativeSamples (now, max + m_symbolDuration);
+  int64_t numSamples = RoundTimeToIndex (max + m_symbolDuration) - RoundTimeToIndex (now);
+  const std::complex<double> *cumNoise = GetScratchSamples (now, max + m_symbolDuration);
 
   // Now iterate over chunks of 80 samples and calculate their signal strength
-  for (int32_t i = 0; i < cumNoise.size () - 80; i += 80)
+  for (int64_t i = 0; i < numSamples - 80; i += 80)
     {
-      double strength = PhySimHelper::GetOFDMSymbolSignalStrength ( cumNoise.get (i, i + 80 - 1) );
+      double strength = PhySimHelper::GetOFDMSymbolSignalStrength (cumNoise + i, 80);
       NS_LOG_DEBUG ("PhySimInterferenceHelper:GetEnergyDuration() --> symbol " << ((uint32_t)(i / 80)) << " has signal strength of " << PhySimHelper::RatioToDb (strength) << " dBm");
       NS_LOG_DEBUG ("PhySimInterferenceHelper:IsEnergyReached() --> threshold: " << energydBm);
 
@@ -235,6 +268,10 @@ bool
 PhySimInterferenceHelper::IsEnergyReached (double energydBm, Time &duration)
 {
   NS_LOG_FUNCTION (energydBm);
+  if (m_useEnergyTimeline)
+    {
+      return IsTimelineEnergyReached (energydBm, duration);
+    }
   Time now = Simulator::Now ();
 
   // So far, set duration to 0 seconds
@@ -244,11 +281,13 @@ PhySimInterferenceHelper::IsEnergyReached (double energydBm, Time &duration)
   Time max = now;
 
   NS_LOG_INFO ("PhySimInterferenceHelper:IsEnergyReached() - starting to iterate over all interference events");
-  Events::iterator i = m_events.begin ();
-  while (i != m_events.end ())
+  uint64_t nowIndex = RoundTimeToIndex (now);
+  std::vector<const EventEntry *> candidates;
+  GetCandidateEvents (nowIndex, nowIndex, candidates);
+  for (std::vector<const EventEntry *>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
     {
-      Time start = (*i)->GetStartTime ();
-      Time end = (*i)->GetEndTime ();
+      Time start = (*i)->event->GetStartTime ();
+      Time end = (*i)->event->GetEndTime ();
       if (start <= now && end >= now)
         {
           if (end > max)
@@ -256,7 +295,6 @@ PhySimInterferenceHelper::IsEnergyReached (double energydBm, Time &duration)
               max = end;
             }
         }
-      i++;
     }
 
   NS_LOG_INFO ("PhySimInterferenceHelper:IsEnergyReached() - all events processed.");
@@ -275,12 +313,13 @@ PhySimInterferenceHelper::IsEnergyReached (double energydBm, Time &duration)
   // We add one symbol duration to make sure we do not skip the last frame
   // due to partial overlap or rather not having enough samples
   max += m_symbolDuration;
-  itpp::cvec cumNoise = GetCumulativeSamples (now, max);
+  int64_t numSamples = RoundTimeToIndex (max) - RoundTimeToIndex (now);
+  const std::complex<double> *cumNoise = GetScratchSamples (now, max);
 
   // Now iterate over chunks of 80 samples and calculate their signal strength
-  for (int32_t i = 0; i < cumNoise.size () - 80; i += 80)
+  for (int64_t i = 0; i < numSamples - 80; i += 80)
     {
-      double strength = PhySimHelper::GetOFDMSymbolSignalStrength ( cumNoise.get (i, i + 80 - 1) );
+      double strength = PhySimHelper::GetOFDMSymbolSignalStrength (cumNoise + i, 80);
       NS_LOG_INFO ("PhySimInterferenceHelper:IsEnergyReached() --> symbol " << ((uint32_t)(i / 80)) << " has signal PhySimHelper::RatioToDb(strength) of " << PhySimHelper::RatioToDb (strength) << " dBm");
       NS_LOG_INFO ("PhySimInterferenceHelper:IsEnergyReached() --> energydBm: " << energydBm);
 
@@ -326,205 +365,341 @@ PhySimInterferenceHelper::GetCumulativeSamples (Time start, Time end)
 {
   NS_LOG_FUNCTION (this << start << end);
 
+  // Convert start and end times into sample numbers
+  uint64_t indexStart = RoundTimeToIndex (start);
+  uint64_t indexEnd = RoundTimeToIndex (end);
+
+  itpp::cvec cumulativeSamples (indexEnd - indexStart);
+  AccumulateSamples (start, end, cumulativeSamples._data ());
+  return cumulativeSamples;
+}
+
+std::complex<double> *
+PhySimInterferenceHelper::GetScratchSamples (Time start, Time end)
+{
+  uint64_t numSamples = RoundTimeToIndex (end) - RoundTimeToIndex (start);
+
+  // The scratch buffer only grows, so that successive requests reuse its storage
+  if (static_cast<uint64_t> (m_scratch.size ()) < numSamples)
+    {
+      m_scratch.set_size (numSamples, false);
+    }
+  AccumulateSamples (start, end, m_scratch._data ());
+  return m_scratch._data ();
+}
+
+void
+PhySimInterferenceHelper::AccumulateSamples (Time start, Time end, std::complex<double> *output)
+{
   // Convert start and end times into sample numbers
   uint64_t indexStart = RoundTimeToIndex (start);
   uint64_t indexEnd = RoundTimeToIndex (end);
   uint64_t numSamples = indexEnd - indexStart;
 
-  NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() - requested cumulative samples from sample" << indexStart << " to " << indexEnd);
-  NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() - requested duration equals " << numSamples << " samples");
+  NS_LOG_DEBUG ("PhySimInterferenceHelper:AccumulateSamples() - requested cumulative samples from sample" << indexStart << " to " << indexEnd);
+  NS_LOG_DEBUG ("PhySimInterferenceHelper:AccumulateSamples() - requested duration equals " << numSamples << " samples");
 
   // In the beginning we only have random background noise (or nothing up to now)
-  itpp::cvec cumulativeSamples (numSamples);
-  cumulativeSamples.zeros ();
-  itpp::cvec oSamples (numSamples);
-  itpp::cvec extractedSamples;
+  std::fill (output, output + numSamples, std::complex<double> (0.0, 0.0));
 
   // Add background noise only if not disabled
   if (!m_noNoise)
     {
       itpp::cvec backgroundNoise = GetBackgroundNoise (start, end);
-      NS_ASSERT (backgroundNoise.size() == cumulativeSamples.size());
-      cumulativeSamples += backgroundNoise;
+      NS_ASSERT (static_cast<uint64_t> (backgroundNoise.size ()) == numSamples);
+      const std::complex<double> *noise = backgroundNoise._data ();
+      for (uint64_t k = 0; k < numSamples; k++)
+        {
+          output[k] += noise[k];
+        }
     }
 
   uint32_t count = 1;
 
-  // Iterate over all events and check whether they are inside of this time window
-  Events::iterator i = m_events.begin ();
-  while (i != m_events.end ())
+  // Iterate over all events that may be inside of this time window
+  std::vector<const EventEntry *> candidates;
+  GetCandidateEvents (indexStart, indexEnd, candidates);
+  for (std::vector<const EventEntry *>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
     {
-      uint64_t indexChunkStart = RoundTimeToIndex ((*i)->GetStartTime ());
-      uint64_t indexChunkEnd =   RoundTimeToIndex ((*i)->GetEndTime ());
-
-      NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() - processing event " << count << ":");
-      NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> indexChunkStart = " << indexChunkStart);
-      NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> indexChunkEnd = " << indexChunkEnd);
+      uint64_t indexChunkStart = (*i)->startIndex;
+      uint64_t indexChunkEnd = (*i)->endIndex;
       NS_ASSERT (indexChunkEnd > indexChunkStart);
 
-      // Case 1: the beginning of this event/frame is between 'indexStart' and 'indexEnd'
-      if ( indexChunkStart >= indexStart && indexChunkStart <= indexEnd )
-        {
-          // determine start and end times within of the overlapping frame part
-          uint64_t overlapStart = indexChunkStart;
-          uint64_t overlapEnd = (indexEnd < indexChunkEnd) ? (indexEnd) : (indexChunkEnd);
+      // Only the part of the frame that overlaps with the requested window is added,
+      // directly from the samples stored in the tag and without any intermediate copy
+      uint64_t overlapStart = std::max (indexStart, indexChunkStart);
+      uint64_t overlapEnd = std::min (indexEnd, indexChunkEnd);
 
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (1) overlapStart = " << overlapStart);
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (1) overlapEnd = " << overlapEnd);
+      NS_LOG_DEBUG ("PhySimInterferenceHelper:AccumulateSamples() - processing event " << count << ":");
+      NS_LOG_DEBUG ("PhySimInterferenceHelper:AccumulateSamples() -     --> indexChunkStart = " << indexChunkStart << ", indexChunkEnd = " << indexChunkEnd);
 
-          // calculate the number of samples we are going to copy
+      if (overlapEnd > overlapStart)
+        {
           uint64_t oNumSamples = overlapEnd - overlapStart;
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (1) oNumSamples = " << oNumSamples);
-          NS_ASSERT (oNumSamples >= 0);
-
-          if (oNumSamples > 0)
+          uint64_t sourceOffset = overlapStart - indexChunkStart;
+          uint64_t destinationOffset = overlapStart - indexStart;
+          NS_LOG_DEBUG ("PhySimInterferenceHelper:AccumulateSamples() -     --> oNumSamples = " << oNumSamples << ", sourceOffset = " << sourceOffset << ", destinationOffset = " << destinationOffset);
+
+          const itpp::cvec &interference = (*i)->event->GetWifiPhyTag ()->PeekRxedSamples ();
+          NS_ASSERT (sourceOffset + oNumSamples <= static_cast<uint64_t> (interference.size ()));
+          const std::complex<double> *src = interference._data () + sourceOffset;
+          std::complex<double> *dst = output + destinationOffset;
+          for (uint64_t k = 0; k < oNumSamples; k++)
             {
-              // what is the offset w.r.t the cumulative samples?
-              uint64_t destinationOffset = indexChunkStart - indexStart;
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (1) destinationOffset = " << destinationOffset);
-
-              // extract frame part we are interested in...
-              itpp::cvec interference = (*i)->GetWifiPhyTag ()->GetRxedSamples ();
-              extractedSamples = interference.get ( 0, oNumSamples - 1);
-              NS_ASSERT (oNumSamples <= static_cast<uint64_t> ((*i)->GetWifiPhyTag ()->GetRxedSamples ().size ()));
-
-              oSamples.zeros ();
-              oSamples.replace_mid (destinationOffset, extractedSamples);
-              NS_ASSERT (destinationOffset + extractedSamples.size () <= static_cast<uint64_t> (oSamples.size ()));
-
-              // .. and add extracted copy to final Samples
-              cumulativeSamples += oSamples;
-
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (1) finish!");
-            }
-          else
-            {
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:GetcumulativeSamples() -     --> (1) finish! (oNumSamples==0)");
+              dst[k] += src[k];
             }
         }
-      // Case 2: if the ending of this event is between 'start' and 'end'
-      else if ( indexChunkEnd > indexStart && indexChunkEnd <= indexEnd )
-        {
-
-          // determine start and end times of the overlapping frame part...
-          uint64_t overlapEnd = indexChunkEnd;
-          uint64_t overlapStart = (indexStart > indexChunkStart) ? (indexStart) : (indexChunkStart);
+      count++;
+    }
+}
 
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (2) overlapStart = " << overlapStart);
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (2) overlapEnd = " << overlapEnd);
+void
+PhySimInterferenceHelper::AppendEvent (Ptr<PhySimInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ExpireEvents ();
+
+  // Events are created at Simulator::Now (), hence appending them at the back keeps
+  // the store sorted by the starting sample index
+  EventEntry entry;
+  entry.startIndex = RoundTimeToIndex (event->GetStartTime ());
+  entry.endIndex = RoundTimeToIndex (event->GetEndTime ());
+  entry.event = event;
+  NS_ASSERT (m_events.empty () || m_events.back ().startIndex <= entry.startIndex);
+  m_events.push_back (entry);
+  uint64_t sequence = m_firstSequence + m_events.size () - 1;
+  if (sequence - m_treeBase >= m_endTree.size () / 2)
+    {
+      RebuildEndTree ();
+    }
+  else
+    {
+      SetTreeEnd (sequence, entry.endIndex);
+    }
+  if (m_useEnergyTimeline)
+    {
+      AddToEnergyTimeline (entry);
+    }
+}
 
-          // calculate the number of samples we are going to copy
-          uint64_t oNumSamples = overlapEnd - overlapStart;
-          NS_ASSERT (oNumSamples >= 0);
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (2) oNumSamples = " << oNumSamples);
+void
+PhySimInterferenceHelper::AddToEnergyTimeline (const EventEntry &entry)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint64_t nowBlock = RoundTimeToIndex (Simulator::Now ()) / 80;
+  TrimEnergyTimeline (nowBlock);
+  if (m_energyTimeline.empty ())
+    {
+      m_energyTimelineBase = nowBlock;
+    }
 
-          if (oNumSamples > 0)
-            {
-              // what is the offset w.r.t the cumulative samples?
-              uint64_t destinationOffset = overlapStart - indexStart;
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (2) destinationOffset = " << destinationOffset);
+  // Blocks before the start of the timeline lie in the past and are not needed anymore
+  uint64_t firstIndex = std::max (entry.startIndex, m_energyTimelineBase * 80);
+  if (entry.endIndex <= firstIndex)
+    {
+      return;
+    }
 
-              // what is the offset inside of the source samples?
-              uint64_t sourceOffset = (indexChunkStart < indexStart) ? (indexStart - indexChunkStart) : (indexChunkStart - indexStart);
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (2) sourceOffset = " << sourceOffset);
+  // Make sure the timeline covers the whole event
+  uint64_t lastBlock = (entry.endIndex - 1) / 80;
+  if (lastBlock >= m_energyTimelineBase + m_energyTimeline.size ())
+    {
+      m_energyTimeline.resize (lastBlock - m_energyTimelineBase + 1, 0.0);
+    }
 
-              // extract frame part we are interested in...
-              itpp::cvec interference = (*i)->GetWifiPhyTag ()->GetRxedSamples ();
-              extractedSamples = interference.get ( sourceOffset, sourceOffset + oNumSamples - 1);
-              NS_ASSERT (oNumSamples <= static_cast<uint64_t> ((*i)->GetWifiPhyTag ()->GetRxedSamples ().size ())&&oNumSamples >= 0);
+  const itpp::cvec &samples = entry.event->GetWifiPhyTag ()->PeekRxedSamples ();
+  uint64_t numSamples = std::min (entry.endIndex - entry.startIndex, static_cast<uint64_t> (samples.size ()));
+  for (uint64_t k = firstIndex - entry.startIndex; k < numSamples; k++)
+    {
+      m_energyTimeline[(entry.startIndex + k) / 80 - m_energyTimelineBase] += norm (samples (k));
+    }
+}
 
-              oSamples.zeros ();
-              oSamples.replace_mid ( destinationOffset, extractedSamples);
-              NS_ASSERT (destinationOffset + extractedSamples.size () <= static_cast<uint64_t> (oSamples.size ()));
+void
+PhySimInterferenceHelper::TrimEnergyTimeline (uint64_t block)
+{
+  while (!m_energyTimeline.empty () && m_energyTimelineBase < block)
+    {
+      m_energyTimeline.pop_front ();
+      m_energyTimelineBase++;
+    }
+}
 
-              // ... and add extracted copy to final Samples
-              cumulativeSamples += oSamples;
+double
+PhySimInterferenceHelper::GetTimelineBlockPower (uint64_t block) const
+{
+  double power = m_energyTimeline[block - m_energyTimelineBase] / 80.0;
+  if (!m_noNoise)
+    {
+      power += pow (10, (m_noiseFloorDbm / 10));
+    }
+  return power;
+}
 
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (2) finish!");
-            }
-          else
-            {
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (2) finish! (oNumSamples==0)");
+Time
+PhySimInterferenceHelper::GetTimelineEnergyDuration (double energydBm)
+{
+  NS_LOG_FUNCTION (energydBm);
+  uint64_t nowIndex = RoundTimeToIndex (Simulator::Now ());
+  uint64_t block = nowIndex / 80;
+  TrimEnergyTimeline (block);
+  uint64_t sampleDuration = m_symbolDuration.GetNanoSeconds () / 80.0;
 
-            }
-        }
-      // Case 3: if the frame is overlapping completely, i.e. indexChunkStart < indexStart
-      //         and indexChunkEnd > indexEnd
-      else if (indexChunkStart < indexStart && indexChunkEnd > indexEnd)
+  uint64_t endBlock = m_energyTimelineBase + m_energyTimeline.size ();
+  for (; block < endBlock; block++)
+    {
+      // If the energy of this block dropped below 'energydBm', the medium is busy until its end
+      if (PhySimHelper::RatioToDb (GetTimelineBlockPower (block)) < energydBm)
         {
+          break;
+        }
+    }
+  Time duration = NanoSeconds ((std::max (block * 80 + 80, nowIndex) - nowIndex) * sampleDuration);
+  if (block >= endBlock)
+    {
+      // The energy stays above the threshold until the last known frame ends, or all frames have ended already
+      duration = NanoSeconds ((std::max (endBlock * 80, nowIndex) - nowIndex) * sampleDuration);
+    }
+  NS_LOG_DEBUG ("PhySimInterferenceHelper:GetTimelineEnergyDuration() duration = " << duration);
+  return duration;
+}
 
-          // determine start and end times of the overlapping frame part
-          uint64_t overlapStart = indexStart - indexChunkStart;
-          uint64_t overlapEnd = overlapStart + (indexEnd - indexStart);
-          NS_ASSERT (overlapEnd > overlapStart);
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (3) overlapStart = " << overlapStart);
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (3) overlapEnd = " << overlapEnd);
-
-          // calculate the number of samples we are going to copy
-          uint64_t oNumSamples = overlapEnd - overlapStart;
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (3) oNumSamples = " << oNumSamples);
-          NS_ASSERT (oNumSamples >= 0);
-
-          // what is the offset inside of the source Samples?
-          uint64_t sourceOffset = overlapStart;
-          NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (3) sourceOffset = " << sourceOffset);
+bool
+PhySimInterferenceHelper::IsTimelineEnergyReached (double energydBm, Time &duration)
+{
+  NS_LOG_FUNCTION (energydBm);
+  duration = Seconds (0);
+  uint64_t nowIndex = RoundTimeToIndex (Simulator::Now ());
+  uint64_t block = nowIndex / 80;
+  TrimEnergyTimeline (block);
+  uint64_t sampleDuration = m_symbolDuration.GetNanoSeconds () / 80.0;
 
-          if (oNumSamples > 0)
-            {
-              // extract frame part we are interested in...
-              itpp::cvec interference = (*i)->GetWifiPhyTag ()->GetRxedSamples ();
-              extractedSamples = interference.get ( sourceOffset, sourceOffset + oNumSamples - 1);
-              NS_ASSERT (sourceOffset < static_cast<uint64_t> ((*i)->GetWifiPhyTag ()->GetRxedSamples ().size ()));
-              NS_ASSERT (sourceOffset + oNumSamples <= static_cast<uint64_t> ((*i)->GetWifiPhyTag ()->GetRxedSamples ().size ()));
-              oSamples.zeros ();
-              oSamples.replace_mid (0, extractedSamples);
-              NS_ASSERT (extractedSamples.size () <= oSamples.size ());
-              // ... and add extracted copy to final Samples
-              cumulativeSamples += oSamples;
-
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (3) finish!");
-            }
-          else
-            {
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() -     --> (3) finish! (oNumSamples==0)");
-            }
+  uint64_t endBlock = m_energyTimelineBase + m_energyTimeline.size ();
+  for (; block < endBlock; block++)
+    {
+      if (PhySimHelper::RatioToDb (GetTimelineBlockPower (block)) >= energydBm)
+        {
+          duration = NanoSeconds ((std::max (block * 80, nowIndex) - nowIndex) * sampleDuration);
+          NS_LOG_DEBUG ("PhySimInterferenceHelper:IsTimelineEnergyReached() duration = " << duration);
+          return true;
         }
-      NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCumulativeSamples() - finished processing event " << count);
-      i++;
-      count++;
     }
-
-  return cumulativeSamples;
+  return false;
 }
 
 void
-PhySimInterferenceHelper::AppendEvent (Ptr<PhySimInterferenceHelper::Event> event)
+PhySimInterferenceHelper::ExpireEvents (void)
 {
   /* attempt to remove the events which are
    * not useful anymore.
    * i.e.: all events which end _before_
    *       now - m_maxPacketDuration
+   *
+   * Since the store is sorted by start time, we only look at the front. An expired
+   * event that is queued behind a still valid one will be removed as soon as it reaches
+   * the front. Until then it can not overlap with any window that is requested after
+   * now - m_maxPacketDuration, so it does not change any result.
    */
   NS_LOG_FUNCTION_NOARGS ();
-  NS_LOG_DEBUG ("PhySimInterferenceHelper:AppendEvent() - m_maxPacketDuration = "  << GetMaxPacketDuration ());
+  NS_LOG_DEBUG ("PhySimInterferenceHelper:ExpireEvents() - m_maxPacketDuration = "  << GetMaxPacketDuration ());
   if (Simulator::Now () > GetMaxPacketDuration ())
     {
       Time end = Simulator::Now () - GetMaxPacketDuration ();
-      Events::iterator it = m_events.begin ();
-      while (it != m_events.end ())
+      while (!m_events.empty () && m_events.front ().event->GetEndTime () < end)
         {
-          if ((*it)->GetEndTime () < end)
-            {
-              NS_LOG_DEBUG ("PhySimInterferenceHelper:AppendEvent() - deleting event with startTime = "  << (*it)->GetStartTime () << " and endTime = " << (*it)->GetEndTime ());
-              it = m_events.erase (it);
-            }
-          else
-            {
-              it++;
-            }
+          const EventEntry &entry = m_events.front ();
+          NS_LOG_DEBUG ("PhySimInterferenceHelper:ExpireEvents() - deleting event with startTime = "  << entry.event->GetStartTime () << " and endTime = " << entry.event->GetEndTime ());
+          SetTreeEnd (m_firstSequence, 0);
+          m_events.pop_front ();
+          m_firstSequence++;
         }
     }
-  m_events.push_back (event);
+}
+
+bool
+PhySimInterferenceHelper::StartsAfter (uint64_t index, const EventEntry &entry)
+{
+  return index < entry.startIndex;
+}
+
+void
+PhySimInterferenceHelper::GetCandidateEvents (uint64_t indexStart, uint64_t indexEnd, std::vector<const EventEntry *> &candidates) const
+{
+  candidates.clear ();
+  if (m_events.empty ())
+    {
+      return;
+    }
+
+  // Events are sorted by their start, so all events starting after the window form the tail of the store. Among the
+  // others, only the subtrees whose maximum end index reaches the window are visited.
+  Events::const_iterator last = std::upper_bound (m_events.begin (), m_events.end (), indexEnd, &PhySimInterferenceHelper::StartsAfter);
+  uint32_t begin = m_firstSequence - m_treeBase;
+  uint32_t end = begin + (last - m_events.begin ());
+  if (end > begin)
+    {
+      CollectCandidates (1, 0, m_endTree.size () / 2, begin, end, indexStart, candidates);
+    }
+  NS_LOG_DEBUG ("PhySimInterferenceHelper:GetCandidateEvents() - " << candidates.size () << " out of " << m_events.size () << " events are candidates for the window " << indexStart << " to " << indexEnd);
+}
+
+void
+PhySimInterferenceHelper::CollectCandidates (uint32_t node, uint32_t nodeBegin, uint32_t nodeEnd, uint32_t begin, uint32_t end,
+                                             uint64_t indexStart, std::vector<const EventEntry *> &candidates) const
+{
+  // The node covers the leaves [nodeBegin, nodeEnd), visit it only if it overlaps with [begin, end) and contains
+  // an event that ends within or after the window
+  if (nodeEnd <= begin || end <= nodeBegin || m_endTree[node] < indexStart || m_endTree[node] == 0)
+    {
+      return;
+    }
+  if (nodeEnd - nodeBegin == 1)
+    {
+      candidates.push_back (&m_events[nodeBegin + m_treeBase - m_firstSequence]);
+      return;
+    }
+  uint32_t middle = (nodeBegin + nodeEnd) / 2;
+  CollectCandidates (2 * node, nodeBegin, middle, begin, end, indexStart, candidates);
+  CollectCandidates (2 * node + 1, middle, nodeEnd, begin, end, indexStart, candidates);
+}
+
+void
+PhySimInterferenceHelper::SetTreeEnd (uint64_t sequence, uint64_t endIndex)
+{
+  uint32_t node = m_endTree.size () / 2 + (sequence - m_treeBase);
+  m_endTree[node] = endIndex;
+  for (node /= 2; node > 0; node /= 2)
+    {
+      m_endTree[node] = std::max (m_endTree[2 * node], m_endTree[2 * node + 1]);
+    }
+}
+
+void
+PhySimInterferenceHelper::RebuildEndTree (void)
+{
+  // The leaves start at the first stored event and leave room for as many events as are stored, so that the
+  // rebuild is amortized over the appended events
+  uint32_t leaves = 16;
+  while (leaves < 2 * m_events.size ())
+    {
+      leaves *= 2;
+    }
+  m_endTree.assign (2 * leaves, 0);
+  m_treeBase = m_firstSequence;
+  for (uint32_t k = 0; k < m_events.size (); k++)
+    {
+      m_endTree[leaves + k] = m_events[k].endIndex;
+    }
+  for (uint32_t node = leaves - 1; node > 0; node--)
+    {
+      m_endTree[node] = std::max (m_endTree[2 * node], m_endTree[2 * node + 1]);
+    }
+}
+
+uint32_t
+PhySimInterferenceHelper::GetNEvents (void) const
+{
+  return m_events.size ();
 }
 
 Time
@@ -549,6 +724,12 @@ PhySimInterferenceHelper::GetBackgroundNoise (Time start, Time end)
   uint64_t sampleDuration = m_symbolDuration.GetNanoSeconds () / 80.0;
   NS_LOG_DEBUG ("PhySimInterferenceHelper:GetBackgroundNoise() sampleDuration = " << sampleDuration);
 
+  // The counter based generator does not need any noise chunks
+  if (m_counterBasedNoise)
+    {
+      return GetCounterBasedNoise (RoundTimeToIndex (start), RoundTimeToIndex (end));
+    }
+
   itpp::cvec backgroundNoise;
   Noises::iterator it = m_noiseChunks.begin ();
 
@@ -758,6 +939,65 @@ PhySimInterferenceHelper::GetBackgroundNoise (Time start, Time end)
   return backgroundNoise;
 }
 
+/*
+ * One Philox4x32-10 block (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC 2011).
+ * Encrypts the 128 bit counter with the 64 bit key and returns four uniformly distributed words.
+ */
+static void
+Philox4x32 (uint32_t counter[4], uint32_t key0, uint32_t key1)
+{
+  const uint64_t m0 = 0xD2511F53;
+  const uint64_t m1 = 0xCD9E8D57;
+  for (uint32_t round = 0; round < 10; round++)
+    {
+      uint64_t p0 = m0 * counter[0];
+      uint64_t p1 = m1 * counter[2];
+      uint32_t c0 = static_cast<uint32_t> (p1 >> 32) ^ counter[1] ^ key0;
+      uint32_t c1 = static_cast<uint32_t> (p1);
+      uint32_t c2 = static_cast<uint32_t> (p0 >> 32) ^ counter[3] ^ key1;
+      uint32_t c3 = static_cast<uint32_t> (p0);
+      counter[0] = c0;
+      counter[1] = c1;
+      counter[2] = c2;
+      counter[3] = c3;
+      key0 += 0x9E3779B9;
+      key1 += 0xBB67AE85;
+    }
+}
+
+itpp::cvec
+PhySimInterferenceHelper::GetCounterBasedNoise (uint64_t indexStart, uint64_t indexEnd) const
+{
+  NS_LOG_FUNCTION (indexStart << indexEnd);
+  NS_ASSERT (indexEnd >= indexStart);
+
+  // Same amplitude as for the chunk based noise
+  double amplitude = sqrt ( pow (10, (m_noiseFloorDbm / 10)) );
+  itpp::cvec noise (indexEnd - indexStart);
+  for (uint64_t index = indexStart; index < indexEnd; index++)
+    {
+      uint32_t counter[4] = { static_cast<uint32_t> (index), static_cast<uint32_t> (index >> 32), m_noiseStream, 0 };
+      Philox4x32 (counter, m_noiseSeed, m_noiseStream);
+
+      // Two uniform variables with 53 bit precision in (0,1), transformed by Box-Muller
+      // into a complex Gaussian sample with unit variance (same as itpp::randn_c)
+      uint64_t w0 = (static_cast<uint64_t> (counter[0]) << 32) | counter[1];
+      uint64_t w1 = (static_cast<uint64_t> (counter[2]) << 32) | counter[3];
+      double u0 = ((w0 >> 11) + 0.5) / 9007199254740992.0;
+      double u1 = ((w1 >> 11) + 0.5) / 9007199254740992.0;
+      double radius = sqrt (-log (u0));
+      double angle = 2.0 * M_PI * u1;
+      noise (index - indexStart) = amplitude * std::complex<double> (radius * cos (angle), radius * sin (angle));
+    }
+  return noise;
+}
+
+void
+PhySimInterferenceHelper::SetNoiseStream (uint32_t stream)
+{
+  m_noiseStream = stream;
+}
+
 double
 PhySimInterferenceHelper::CalculatePreambleSinr (Ptr<PhySimInterferenceHelper::Event> event)
 {
@@ -811,10 +1051,77 @@ PhySimInterferenceHelper::CalculateOverallSinr (Ptr<PhySimInterferenceHelper::Ev
   return sinr;
 }
 
+PhySimInterferenceHelper::SinrValues
+PhySimInterferenceHelper::CalculateSinrs (Ptr<PhySimInterferenceHelper::Event> event)
+{
+  NS_LOG_FUNCTION (event);
+  const itpp::cvec &rxSamples = event->GetWifiPhyTag ()->PeekRxedSamples ();
+  uint64_t numSamples = RoundTimeToIndex (event->GetEndTime ()) - RoundTimeToIndex (event->GetStartTime ());
+  NS_ASSERT (numSamples < static_cast<uint64_t> (rxSamples.size ()));
+  NS_ASSERT (numSamples % 80 == 0 && numSamples >= 480);
+
+  // Synthesize the cumulative samples of the whole frame only once
+  const std::complex<double> *cumulative = GetScratchSamples (event->GetStartTime (), event->GetEndTime ());
+  const std::complex<double> *reference = rxSamples._data ();
+
+  // Compute the linear signal-to-(interference plus noise) ratio of every OFDM symbol
+  uint32_t numSymbols = numSamples / 80;
+  std::vector<double> ratios (numSymbols);
+  for (uint32_t b = 0; b < numSymbols; b++)
+    {
+      double energyNoise = 0.0;
+      double energyReference = 0.0;
+      for (uint32_t k = b * 80; k < (b + 1) * 80; k++)
+        {
+          energyNoise += norm (cumulative[k] - reference[k]);
+          energyReference += norm (reference[k]);
+        }
+      ratios[b] = (energyReference / 80) / (energyNoise / 80);
+    }
+
+  // Then average over the blocks of each part, the same way CalculateSinr does
+  SinrValues values;
+  double preamble = 0.0, payload = 0.0, overall = 0.0;
+  values.perSymbol.resize (numSymbols);
+  for (uint32_t b = 0; b < numSymbols; b++)
+    {
+      if (b < 4)
+        {
+          preamble += ratios[b];
+        }
+      else if (b > 4)
+        {
+          payload += ratios[b];
+        }
+      overall += ratios[b];
+      values.perSymbol[b] = 10.0 * log10 (ratios[b]);
+    }
+  values.preamble = 10.0 * log10 (preamble / 4);
+  values.header = values.perSymbol[4];
+  values.payload = 10.0 * log10 (payload / (numSymbols - 5));
+  values.overall = 10.0 * log10 (overall / numSymbols);
+  NS_LOG_DEBUG ("PhySimInterferenceHelper:CalculateSinrs() preamble = " << values.preamble << "dB, header = " << values.header
+                << "dB, payload = " << values.payload << "dB, overall = " << values.overall << "dB");
+  return values;
+}
+
 void
 PhySimInterferenceHelper::SetSymbolTime (Time duration)
 {
   m_symbolDuration = duration;
+
+  // The cached sample indices depend on the symbol time, so recompute them
+  m_energyTimeline.clear ();
+  for (Events::iterator i = m_events.begin (); i != m_events.end (); ++i)
+    {
+      i->startIndex = RoundTimeToIndex (i->event->GetStartTime ());
+      i->endIndex = RoundTimeToIndex (i->event->GetEndTime ());
+      if (m_useEnergyTimeline)
+        {
+          AddToEnergyTimeline (*i);
+        }
+    }
+  RebuildEndTree ();
 }
 
 double
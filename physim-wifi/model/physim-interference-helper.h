@@ -28,6 +28,8 @@
 #include <stdint.h>
 #include <vector>
 #include <list>
+#include <deque>
+#include <set>
 #include "ns3/wifi-mode.h"
 #include "ns3/wifi-preamble.h"
 #include "ns3/nstime.h"
@@ -53,9 +55,15 @@ class PhySimWifiPhyTag;
  *
  * The module includes the white Gaussian noise that is present at any WiFi receiver
  * and manages the list of all incoming signals/frames. Therefore, it employs two
- * lists, PhySimInterferenceHelper::Events and PhySimInterferenceHelper::Noises, which
- * are basically std::list containers of the private classes PhysimInterferenceHelper::Event
- * and PhySimInterferenceHelper::NoiseChunk
+ * containers, PhySimInterferenceHelper::Events and PhySimInterferenceHelper::Noises, which
+ * hold instances of the private classes PhysimInterferenceHelper::Event and
+ * PhySimInterferenceHelper::NoiseChunk
+ *
+ * The events are kept sorted by their starting sample index (events are always appended at
+ * Simulator::Now (), so this comes for free). Together with the longest duration of all
+ * stored events, this bounds the range of events that can overlap a given time window,
+ * such that overlap queries and the expiry of old events cost O(log n + k) instead of a
+ * scan over the whole history.
  *
  * In the current implementation, the functionality of this module is used by PhySimWifiPhy
  * to request the cumulative complex time signals within the PhySimWifiPhy::EndPreamble(),
@@ -265,27 +273,147 @@ private:
    */
   double CalculateOverallSinr (Ptr<PhySimInterferenceHelper::Event> event);
 
+  /**
+   * \brief The SINR values of all parts of a frame, as computed by CalculateSinrs
+   */
+  struct SinrValues
+  {
+    double preamble;                    //!< SINR of the preamble (same as CalculatePreambleSinr)
+    double header;                      //!< SINR of the signal header (same as CalculateHeaderSinr)
+    double payload;                     //!< SINR of the payload (same as CalculatePayloadSinr)
+    double overall;                     //!< SINR of the whole frame (same as CalculateOverallSinr)
+    std::vector<double> perSymbol;      //!< SINR of each OFDM symbol (block of 80 samples) of the frame
+  };
+
+  /**
+   * Calculates the SINR of the preamble, the signal header, the payload and the whole frame, as well as
+   * the SINR of every single OFDM symbol, in a single pass. In contrast to calling the four methods
+   * above, the cumulative samples of the frame are only synthesized once and the signal and noise energy
+   * of every OFDM symbol is only computed once. The results are identical to the individual methods,
+   * provided that all interfering frames are already known, i.e. when called at the end of the frame.
+   * \param event The event pointer, which identifies the packet for which the SINR shall be computed.
+   * \return      The computed SINR values (in dB)
+   */
+  SinrValues CalculateSinrs (Ptr<PhySimInterferenceHelper::Event> event);
+
   /**
    * Sets the symbol time that shall be assumed when generating random background noise
    * \param duration The OFDM symbol time duration
    */
   void SetSymbolTime (Time duration);
+  /**
+   * Sets the noise stream, typically the id of the node this helper belongs to, that is combined with
+   * the NoiseSeed attribute when the counter based background noise is used. Different streams yield
+   * independent noise samples for the same absolute sample index.
+   * \param stream The stream identifier
+   */
+  void SetNoiseStream (uint32_t stream);
+
+  /**
+   * Returns the number of events that are currently stored by the interference helper
+   */
+  uint32_t GetNEvents (void) const;
 
 private:
-  typedef std::list< Ptr<PhySimInterferenceHelper::Event> > Events;
+  /**
+   * An entry of the event store. The start and end sample indices are computed once
+   * when the event is appended, so that overlap queries do not have to convert times again.
+   */
+  struct EventEntry
+  {
+    uint64_t startIndex;
+    uint64_t endIndex;
+    Ptr<PhySimInterferenceHelper::Event> event;
+  };
+  typedef std::deque<EventEntry> Events;
 
   PhySimInterferenceHelper (const PhySimInterferenceHelper &o);
   PhySimInterferenceHelper &operator = (const PhySimInterferenceHelper &o);
 
+  static bool StartsAfter (uint64_t index, const EventEntry &entry);
+
   void AppendEvent (Ptr<PhySimInterferenceHelper::Event> event);
+  void ExpireEvents (void);
+  /**
+   * Determines all stored events that start not later than indexEnd and end not earlier than indexStart, in the
+   * order of their start, i.e. all events that may overlap with the sample window [indexStart, indexEnd]. The
+   * events starting after the window are cut off by a binary search, and the events that ended before the window
+   * are skipped by a descent through the maximum end index tree, hence a query costs O(log n + k log n) for k
+   * returned events.
+   */
+  void GetCandidateEvents (uint64_t indexStart, uint64_t indexEnd, std::vector<const EventEntry *> &candidates) const;
+  void CollectCandidates (uint32_t node, uint32_t nodeBegin, uint32_t nodeEnd, uint32_t begin, uint32_t end,
+                          uint64_t indexStart, std::vector<const EventEntry *> &candidates) const;
+  /**
+   * Sets the end index of the event with the given sequence number in the maximum end index tree, where 0 marks
+   * an expired event
+   */
+  void SetTreeEnd (uint64_t sequence, uint64_t endIndex);
+  /**
+   * Rebuilds the maximum end index tree for the stored events, with room for at least as many appended events
+   */
+  void RebuildEndTree (void);
+  /**
+   * Writes the cumulative signal of all overlapping frames plus the background noise for the
+   * given time window into the given buffer, which has to hold enough samples for the window.
+   * Only the overlapping part of each frame is added, hence the cost is proportional to the
+   * overlap and not to the window length times the number of frames.
+   */
+  void AccumulateSamples (Time start, Time end, std::complex<double> *output);
+  /**
+   * Same as GetCumulativeSamples, but the samples are written into a scratch buffer owned by this
+   * helper, which is reused by successive calls. The returned pointer is only valid until the next call.
+   */
+  std::complex<double> * GetScratchSamples (Time start, Time end);
+  /**
+   * Adds the energy of the given event to the per-block energy timeline. The timeline is aligned to
+   * blocks of 80 samples in absolute sample indices, and each entry holds the sum of |x|^2 of all
+   * events that overlap with that block.
+   */
+  void AddToEnergyTimeline (const EventEntry &entry);
+  /**
+   * Drops all blocks of the energy timeline that lie before the given block, since they will
+   * never be requested again.
+   */
+  void TrimEnergyTimeline (uint64_t block);
+  /**
+   * Returns the average power of the given block of the energy timeline, including the noise floor
+   */
+  double GetTimelineBlockPower (uint64_t block) const;
+  /**
+   * Implementations of GetEnergyDuration and IsEnergyReached that are based on the energy timeline
+   */
+  Time GetTimelineEnergyDuration (double energydBm);
+  bool IsTimelineEnergyReached (double energydBm, Time &duration);
   Time GetMaxPacketDuration (void);
   double CalculateSinr (itpp::cvec reference, itpp::cvec cumNoise);
   uint64_t RoundTimeToIndex (Time t) const;
+  /**
+   * Generates the background noise for the sample indices [indexStart, indexEnd) without any
+   * bookkeeping: each sample is derived from (m_noiseSeed, m_noiseStream, sample index) by means
+   * of a counter based random number generator (Philox4x32-10), hence the same sample index always
+   * yields the same noise sample, independent of the order in which windows are requested.
+   */
+  itpp::cvec GetCounterBasedNoise (uint64_t indexStart, uint64_t indexEnd) const;
 
   double m_noiseFloorDbm;
   bool m_noNoise;
+  bool m_counterBasedNoise;
+  uint32_t m_noiseSeed;
+  uint32_t m_noiseStream;
   Time m_symbolDuration;
   Events m_events;
+  // Binary tree over the stored events (leaf i holds the end index of the event with sequence number
+  // m_treeBase + i, inner nodes hold the maximum of their children), and the sequence number of the first event
+  std::vector<uint64_t> m_endTree;
+  uint64_t m_treeBase;
+  uint64_t m_firstSequence;
+  itpp::cvec m_scratch;
+
+  // For the incremental energy timeline used by CCA decisions
+  bool m_useEnergyTimeline;
+  std::deque<double> m_energyTimeline;
+  uint64_t m_energyTimelineBase;
   Time m_maxPacketDuration;
 
   // For background noise management
@@ -29,6 +29,7 @@
 #include "physim-ofdm-symbolcreator.h"
 #include "physim-helper.h"
 #include <itpp/itcomm.h>
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("PhySimOFDMSymbolCreator");
 
@@ -48,6 +49,19 @@ const int32_t PhySimOFDMSymbolCreator::m_subcarrierPolarity[]
   -1, -1, -1, -1, -1, -1
   };
 
+// Subcarriers -26..-1 are mapped to IFFT inputs 38..63 and subcarriers 1..26 to IFFT inputs 1..26
+const uint8_t PhySimOFDMSymbolCreator::m_dataBins[]
+  = {
+  38, 39, 40, 41, 42, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 58, 59, 60, 61, 62, 63,
+  1, 2, 3, 4, 5, 6, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 22, 23, 24, 25, 26
+  };
+const uint8_t PhySimOFDMSymbolCreator::m_pilotBins[] = { 43, 57, 7, 21 }; // subcarriers -21, -7, 7, 21
+const uint8_t PhySimOFDMSymbolCreator::m_dataSubcarriers[]
+  = {
+  0, 1, 2, 3, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 20, 21, 22, 23, 24, 25,
+  27, 28, 29, 30, 31, 32, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 48, 49, 50, 51, 52
+  };
+
 TypeId
 PhySimOFDMSymbolCreator::GetTypeId (void)
 {
@@ -69,7 +83,7 @@ PhySimOFDMSymbolCreator::GetTypeId (void)
                    EnumValue (itpp::LOGMAP),
                    MakeEnumAccessor (&PhySimOFDMSymbolCreator::m_softMethod),
                    MakeEnumChecker (itpp::LOGMAP, "Log-MAP full calculation method",
-                                    itpp::APPROX, "Approximate faster method"));
+                                    itpp::APPROX, "Approximate faster method (max-log, computed by PhySimMaxLogDemapper)"));
   return tid;
 }
 
@@ -155,6 +169,56 @@ PhySimOFDMSymbolCreator::Modulate (const itpp::bvec &input, const int symbolInde
   return Normalise (output, false);
 }
 
+/*
+ * Turns a bitstream of several OFDM symbols into time samples, see Modulate (const itpp::bvec &, const int).
+ *
+ * @param input input bits, a multiple of the number of coded bits per symbol
+ * @param firstSymbolIndex 0 for SIGNAL or 1..n for the first OFDM data symbol
+ * @param output buffer for 80 time samples per OFDM symbol
+ * @return number of OFDM symbols
+ */
+uint32_t
+PhySimOFDMSymbolCreator::ModulateSymbols (const itpp::bvec &input, uint32_t firstSymbolIndex, std::complex<double> *output)
+{
+  uint32_t bitsPerSymbol = CheckSize ();
+  NS_ASSERT ( input.size () % bitsPerSymbol == 0 );
+  uint32_t numSymbols = input.size () / bitsPerSymbol;
+
+  // Map the constellation points of all symbols at once
+  itpp::cvec modulated = ModulateBits (input);
+  if (m_ieeeCompliantMode)
+    {
+      TransformModulation (modulated, true);
+    }
+
+  m_ifftInput.set_size (m_DefaultNoCarriers);
+  m_ifftInput.zeros ();
+  for (uint32_t symbol = 0; symbol < numSymbols; symbol++)
+    {
+      const std::complex<double> *points = modulated._data () + 48 * symbol;
+      for (uint32_t i = 0; i < 48; i++)
+        {
+          m_ifftInput (m_dataBins[i]) = points[i];
+        }
+      int32_t polarity = m_subcarrierPolarity[(firstSymbolIndex + symbol) % 126];
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          m_ifftInput (m_pilotBins[i]) = m_subcarrierValues (i) * (double) polarity;
+        }
+
+      // The 64-point transform is the same for every symbol, so IT++ reuses its FFTW plan. The normalisation
+      // of IT++'s OFDM modulator is undone by Normalise () anyway, hence the plain IFFT.
+      itpp::ifft (m_ifftInput, m_ifftOutput);
+
+      // Cyclic prefix followed by the symbol
+      std::complex<double> *samples = output + (m_DefaultNoCarriers + m_DefaultNCP) * symbol;
+      const std::complex<double> *time = m_ifftOutput._data ();
+      std::copy (time + m_DefaultNoCarriers - m_DefaultNCP, time + m_DefaultNoCarriers, samples);
+      std::copy (time, time + m_DefaultNoCarriers, samples + m_DefaultNCP);
+    }
+  return numSymbols;
+}
+
 /*
  * Takes a cvec representing the 53 OFDM subcarriers (inc. DC) and produces an OFDM symbol. There is no additional modulation performed.
  * The cyclic prefix defines how much (if at all) of a cyclic prefix will be added.
@@ -234,6 +298,68 @@ PhySimOFDMSymbolCreator::DeModulate (const itpp::cvec &input, uint32_t symbolNo)
   return DeModulateBits (fixedInput);
 }
 
+/*
+ * Given several OFDM symbols return the contained bits (soft or hard).
+ *
+ * @param input the OFDM symbols, 80 samples each
+ * @param firstSymbolNo the symbol number of the first symbol
+ * @return demodulated bits (soft or hard)
+ */
+itpp::vec
+PhySimOFDMSymbolCreator::DeModulateSymbols (const itpp::cvec &input, uint32_t firstSymbolNo, const uint16_t *positions)
+{
+  const uint32_t sampleSize = m_DefaultNoCarriers + m_DefaultNCP;
+  NS_ASSERT ( input.size () % sampleSize == 0 );
+  uint32_t numSymbols = input.size () / sampleSize;
+
+  NS_LOG_FUNCTION ( firstSymbolNo << numSymbols );
+
+  // FFT of each symbol without its cyclic prefix. Normalise () and the normalisation of IT++'s OFDM demodulator
+  // cancel out, hence the plain FFT. The result is stored in the order of TransformToInput ().
+  m_fftInput.set_size (m_DefaultNoCarriers, false);
+  m_subcarriers.set_size (53 * numSymbols, false);
+  for (uint32_t symbol = 0; symbol < numSymbols; symbol++)
+    {
+      const std::complex<double> *samples = input._data () + sampleSize * symbol + m_DefaultNCP;
+      std::copy (samples, samples + m_DefaultNoCarriers, m_fftInput._data ());
+      itpp::fft (m_fftInput, m_fftOutput);
+
+      std::complex<double> *subcarriers = m_subcarriers._data () + 53 * symbol;
+      const std::complex<double> *bins = m_fftOutput._data ();
+      std::copy (bins + 38, bins + 64, subcarriers); // 38-63 is really 0..25
+      subcarriers[26] = 0; // the DC
+      std::copy (bins + 1, bins + 27, subcarriers + 27); // 1-26 is really 27-52
+    }
+
+  // Perform pilot symbol channel estimation and corrections for all symbols
+  m_estimator->ApplyOFDMSymbolCorrections (m_subcarriers._data (), numSymbols, firstSymbolNo);
+
+  // Gather the data subcarriers (i.e. remove pilots and DC)
+  m_dataCarriers.set_size (48 * numSymbols, false);
+  for (uint32_t symbol = 0; symbol < numSymbols; symbol++)
+    {
+      const std::complex<double> *subcarriers = m_subcarriers._data () + 53 * symbol;
+      std::complex<double> *data = m_dataCarriers._data () + 48 * symbol;
+      for (uint32_t i = 0; i < 48; i++)
+        {
+          data[i] = subcarriers[m_dataSubcarriers[i]];
+        }
+    }
+
+  if (m_ieeeCompliantMode)
+    {
+      // IEEE Standard to IT++ notation
+      TransformModulation (m_dataCarriers, false);
+    }
+
+  // Demodulate real data
+  if (positions)
+    {
+      return DeModulateBits (m_dataCarriers, positions);
+    }
+  return DeModulateBits (m_dataCarriers);
+}
+
 void
 PhySimOFDMSymbolCreator::SetModulationType (enum PhySimHelper::ModulationType type, uint8_t constellation)
 {
@@ -406,6 +532,10 @@ PhySimOFDMSymbolCreator::DeModulateBits (const itpp::cvec& input)
         {
           return itpp::to_vec (m_bpsk->demodulate_bits (input));
         }
+      else if (m_softMethod == itpp::APPROX && m_bpskDemapper.Initialise (*m_bpsk))
+        {
+          return m_bpskDemapper.Demodulate (input, spectralNoiseDensity);
+        }
       else
         {
           return m_bpsk->demodulate_soft_bits (input, spectralNoiseDensity, m_softMethod);
@@ -420,6 +550,10 @@ PhySimOFDMSymbolCreator::DeModulateBits (const itpp::cvec& input)
         {
           return itpp::to_vec (m_qpsk->demodulate_bits (input));
         }
+      else if (m_softMethod == itpp::APPROX && m_qpskDemapper.Initialise (*m_qpsk))
+        {
+          return m_qpskDemapper.Demodulate (input, spectralNoiseDensity);
+        }
       else
         {
           return m_qpsk->demodulate_soft_bits (input, spectralNoiseDensity, m_softMethod);
@@ -434,6 +568,10 @@ PhySimOFDMSymbolCreator::DeModulateBits (const itpp::cvec& input)
         {
           return itpp::to_vec (m_qam16->demodulate_bits (input));
         }
+      else if (m_softMethod == itpp::APPROX && m_qam16Demapper.Initialise (*m_qam16))
+        {
+          return m_qam16Demapper.Demodulate (input, spectralNoiseDensity);
+        }
       else
         {
           return m_qam16->demodulate_soft_bits (input, spectralNoiseDensity, m_softMethod);
@@ -448,6 +586,10 @@ PhySimOFDMSymbolCreator::DeModulateBits (const itpp::cvec& input)
         {
           return itpp::to_vec (m_qam64->demodulate_bits (input));
         }
+      else if (m_softMethod == itpp::APPROX && m_qam64Demapper.Initialise (*m_qam64))
+        {
+          return m_qam64Demapper.Demodulate (input, spectralNoiseDensity);
+        }
       else
         {
           return m_qam64->demodulate_soft_bits (input, spectralNoiseDensity, m_softMethod);
@@ -462,6 +604,10 @@ PhySimOFDMSymbolCreator::DeModulateBits (const itpp::cvec& input)
         {
           return itpp::to_vec (m_bpsk->demodulate_bits (input));
         }
+      else if (m_softMethod == itpp::APPROX && m_bpskDemapper.Initialise (*m_bpsk))
+        {
+          return m_bpskDemapper.Demodulate (input, spectralNoiseDensity);
+        }
       else
         {
           return m_bpsk->demodulate_soft_bits (input, spectralNoiseDensity, m_softMethod);
@@ -469,6 +615,81 @@ PhySimOFDMSymbolCreator::DeModulateBits (const itpp::cvec& input)
     }
 }
 
+/*!
+ * Demodulates the data subcarriers of one or more OFDM symbols and writes the bits of each symbol to the given
+ * positions. With soft decisions and the APPROX method, the LLRs are written directly by the max-log demapper.
+ */
+itpp::vec
+PhySimOFDMSymbolCreator::DeModulateBits (const itpp::cvec& input, const uint16_t *positions)
+{
+  NS_ASSERT (input.size () % 48 == 0);
+  if (m_softViterbiDecision && m_softMethod == itpp::APPROX)
+    {
+      double spectralNoiseDensity = m_estimator->GetDetectedNoise ();
+      itpp::vec output (input.size () * CheckSize () / 48);
+      switch (m_modulationType)
+        {
+        case PhySimHelper::QPSK:
+          if (!m_qpsk)
+            {
+              m_qpsk = new itpp::QPSK;
+            }
+          if (m_qpskDemapper.Initialise (*m_qpsk))
+            {
+              m_qpskDemapper.Demodulate (input._data (), input.size (), spectralNoiseDensity, output._data (), positions, 48);
+              return output;
+            }
+          break;
+        case PhySimHelper::QAM16:
+          if (!m_qam16)
+            {
+              m_qam16 = new itpp::QAM (16);
+            }
+          if (m_qam16Demapper.Initialise (*m_qam16))
+            {
+              m_qam16Demapper.Demodulate (input._data (), input.size (), spectralNoiseDensity, output._data (), positions, 48);
+              return output;
+            }
+          break;
+        case PhySimHelper::QAM64:
+          if (!m_qam64)
+            {
+              m_qam64 = new itpp::QAM (64);
+            }
+          if (m_qam64Demapper.Initialise (*m_qam64))
+            {
+              m_qam64Demapper.Demodulate (input._data (), input.size (), spectralNoiseDensity, output._data (), positions, 48);
+              return output;
+            }
+          break;
+        default:   // Default is BPSK
+          if (!m_bpsk)
+            {
+              m_bpsk = new itpp::BPSK_c;
+            }
+          if (m_bpskDemapper.Initialise (*m_bpsk))
+            {
+              m_bpskDemapper.Demodulate (input._data (), input.size (), spectralNoiseDensity, output._data (), positions, 48);
+              return output;
+            }
+          break;
+        }
+    }
+
+  // Otherwise demodulate first and move the bits afterwards
+  itpp::vec demodulated = DeModulateBits (input);
+  itpp::vec output (demodulated.size ());
+  uint32_t blockSize = CheckSize ();
+  for (int32_t block = 0; block < demodulated.size (); block += blockSize)
+    {
+      for (uint32_t k = 0; k < blockSize; k++)
+        {
+          output (block + positions[k]) = demodulated (block + k);
+        }
+    }
+  return output;
+}
+
 /*!
  * Returns the appropriate SubCarrier for an OFDM symbol at a given position.
  * Symbol positions begin with 0, with position 0 indicating the SIGNAL and 1..n the respective DATA symbols.
@@ -489,6 +710,16 @@ PhySimOFDMSymbolCreator::GetPilotSubcarrier (const int symbolIndex)
   return (PhySimOFDMSymbolCreator::m_subcarrierValues * pilotsPolarity);
 }
 
+void
+PhySimOFDMSymbolCreator::GetPilotSubcarrier (const uint32_t symbolIndex, std::complex<double> *pilots)
+{
+  double pilotsPolarity = PhySimOFDMSymbolCreator::m_subcarrierPolarity[symbolIndex % 126];
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      pilots[i] = PhySimOFDMSymbolCreator::m_subcarrierValues (i) * pilotsPolarity;
+    }
+}
+
 /*
  * \brief Change the polarity of vector and exchange real and imaginary parts.
  */
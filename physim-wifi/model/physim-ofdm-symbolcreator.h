@@ -25,6 +25,7 @@
 
 #include "ns3/object.h"
 #include "physim-channel-estimator.h"
+#include "physim-soft-demapper.h"
 #include "ns3/wifi-mode.h"
 #include <itpp/itcomm.h>
 
@@ -46,6 +47,27 @@ public:
   // this function is only used for the modulation of the preamble
   itpp::cvec Modulate (const itpp::cvec &input, int cyclic_prefix = 0);
   itpp::vec DeModulate (const itpp::cvec &input, uint32_t symbolNo = 0);
+  /**
+   * Modulates several consecutive OFDM symbols at once. All constellation points of the input are mapped in one
+   * pass, pilots are taken from the polarity table, and each symbol is transformed by the same 64-point IFFT.
+   * The cyclic prefix is written in place, no window function is applied.
+   * \param input            The interleaved bits of one or more OFDM symbols
+   * \param firstSymbolIndex Position of the first symbol in the PPDU (0 for SIGNAL, 1..n for DATA symbols)
+   * \param output           Buffer of at least 80 time samples per OFDM symbol
+   * \return                 The number of modulated OFDM symbols
+   */
+  uint32_t ModulateSymbols (const itpp::bvec &input, uint32_t firstSymbolIndex, std::complex<double> *output);
+  /**
+   * Demodulates several consecutive OFDM symbols at once, see DeModulate (const itpp::cvec &, uint32_t). The symbols
+   * are transformed one after another into a single buffer of subcarriers, corrected by the channel estimator in one
+   * call, and the data subcarriers of all symbols are demodulated together.
+   * \param input         80 time samples per OFDM symbol
+   * \param firstSymbolNo The number of the first OFDM symbol (0 for SIGNAL, 1..n for DATA symbols)
+   * \param positions     If given, the demodulated bits of each OFDM symbol are written to these positions instead,
+   *                      e.g. the deinterleaving permutation (see PhySimBlockInterleaver::GetDeinterleavingPositions)
+   * \return              The demodulated bits (soft or hard) of all symbols
+   */
+  itpp::vec DeModulateSymbols (const itpp::cvec &input, uint32_t firstSymbolNo, const uint16_t *positions = 0);
 
   void SetModulationType (enum PhySimHelper::ModulationType type, uint8_t constellation);
   itpp::cvec Normalise (const itpp::cvec &input, bool multiply);
@@ -53,6 +75,10 @@ public:
   static itpp::cvec TransformToOutput (const itpp::cvec &input);
   static itpp::cvec TransformToInput (const itpp::cvec &input);
   static itpp::cvec GetPilotSubcarrier (const int symbolIndex);
+  /**
+   * Writes the four pilot subcarrier values of the OFDM symbol at the given position into the given buffer
+   */
+  static void GetPilotSubcarrier (const uint32_t symbolIndex, std::complex<double> *pilots);
 
   void SetChannelEstimator (std::string type);
   Ptr<PhySimChannelEstimator> GetChannelEstimator ();
@@ -66,6 +92,7 @@ private:
 
   itpp::cvec ModulateBits (const itpp::bvec& input);
   itpp::vec DeModulateBits (const itpp::cvec& input);
+  itpp::vec DeModulateBits (const itpp::cvec& input, const uint16_t *positions);
 
   enum PhySimHelper::ModulationType m_modulationType;
   uint8_t m_constellation;
@@ -83,12 +110,34 @@ private:
   itpp::QAM *m_qam64;
   itpp::OFDM m_ofdm;
 
+  // Constant-time max-log demappers, used for soft decisions with the APPROX method
+  PhySimMaxLogDemapper<2> m_bpskDemapper;
+  PhySimMaxLogDemapper<4> m_qpskDemapper;
+  PhySimMaxLogDemapper<16> m_qam16Demapper;
+  PhySimMaxLogDemapper<64> m_qam64Demapper;
+
   // ! Polarity of symbols (according to 17-25 in Standard)
   static const int32_t m_subcarrierPolarity[127];
 
   // ! Subcarrier values for each OFDM symbol (according to 17-24 in Standard)
   static const itpp::cvec m_subcarrierValues;
 
+  // ! IFFT input positions of the 48 data and the 4 pilot subcarriers (Fig. 17-3 in Standard)
+  static const uint8_t m_dataBins[48];
+  static const uint8_t m_pilotBins[4];
+  // ! Positions of the 48 data subcarriers within the 53 subcarriers (-26..26) of an OFDM symbol
+  static const uint8_t m_dataSubcarriers[48];
+
+  // Reused input and output of the IFFT in ModulateSymbols
+  itpp::cvec m_ifftInput;
+  itpp::cvec m_ifftOutput;
+
+  // Reused buffers of DeModulateSymbols
+  itpp::cvec m_fftInput;
+  itpp::cvec m_fftOutput;
+  itpp::cvec m_subcarriers;
+  itpp::cvec m_dataCarriers;
+
   bool m_ieeeCompliantMode;
   bool m_softViterbiDecision;
   itpp::Soft_Method m_softMethod;
@@ -0,0 +1,167 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#include "ns3/assert.h"
+#include "physim-packed-bits.h"
+#include <cstring>
+
+namespace ns3 {
+
+/*
+ * Lookup table with the 8 bits of every byte value, least significant bit first
+ */
+class PhySimUnpackTable
+{
+public:
+  PhySimUnpackTable ()
+  {
+    for (uint32_t value = 0; value < 256; value++)
+      {
+        for (uint32_t bit = 0; bit < 8; bit++)
+          {
+            m_bits[value][bit] = (value >> bit) & 1;
+          }
+      }
+  }
+  uint8_t m_bits[256][8];
+};
+
+static const PhySimUnpackTable g_unpackTable;
+
+PhySimPackedBits::PhySimPackedBits ()
+  : m_nBits (0)
+{
+}
+
+PhySimPackedBits::PhySimPackedBits (const uint8_t *bytes, uint32_t numBytes)
+  : m_bytes (bytes, bytes + numBytes),
+    m_nBits (8 * numBytes)
+{
+}
+
+PhySimPackedBits::PhySimPackedBits (const itpp::bvec &bits)
+  : m_bytes ((bits.size () + 7) / 8),
+    m_nBits (bits.size ())
+{
+  if (m_nBits > 0)
+    {
+      Pack (bits._data (), m_nBits, &m_bytes[0]);
+    }
+}
+
+void
+PhySimPackedBits::Resize (uint32_t numBits)
+{
+  m_bytes.resize ((numBits + 7) / 8, 0);
+  m_nBits = numBits;
+  if (numBits % 8 != 0)
+    {
+      // clear the unused bits of the last byte
+      m_bytes[numBits / 8] &= (1 << (numBits % 8)) - 1;
+    }
+}
+
+uint32_t
+PhySimPackedBits::GetNBits (void) const
+{
+  return m_nBits;
+}
+
+uint32_t
+PhySimPackedBits::GetNBytes (void) const
+{
+  return m_bytes.size ();
+}
+
+const uint8_t *
+PhySimPackedBits::GetBytes (void) const
+{
+  return m_bytes.empty () ? 0 : &m_bytes[0];
+}
+
+uint8_t *
+PhySimPackedBits::GetBytes (void)
+{
+  return m_bytes.empty () ? 0 : &m_bytes[0];
+}
+
+bool
+PhySimPackedBits::GetBit (uint32_t index) const
+{
+  NS_ASSERT (index < m_nBits);
+  return (m_bytes[index / 8] >> (index % 8)) & 1;
+}
+
+itpp::bvec
+PhySimPackedBits::ToBvec (void) const
+{
+  itpp::bvec bits (m_nBits);
+  if (m_nBits > 0)
+    {
+      Unpack (&m_bytes[0], m_nBits, bits._data ());
+    }
+  return bits;
+}
+
+void
+PhySimPackedBits::Unpack (const uint8_t *bytes, uint32_t numBits, itpp::bin *output)
+{
+  uint32_t fullBytes = numBits / 8;
+  for (uint32_t i = 0; i < fullBytes; i++)
+    {
+      const uint8_t *bits = g_unpackTable.m_bits[bytes[i]];
+      itpp::bin *out = output + 8 * i;
+      for (uint32_t j = 0; j < 8; j++)
+        {
+          out[j] = bits[j];
+        }
+    }
+  for (uint32_t j = 0; j < numBits % 8; j++)
+    {
+      output[8 * fullBytes + j] = g_unpackTable.m_bits[bytes[fullBytes]][j];
+    }
+}
+
+void
+PhySimPackedBits::Pack (const itpp::bin *bits, uint32_t numBits, uint8_t *output)
+{
+  memset (output, 0, (numBits + 7) / 8);
+  uint32_t fullBytes = numBits / 8;
+  for (uint32_t i = 0; i < fullBytes; i++)
+    {
+      const itpp::bin *in = bits + 8 * i;
+      output[i] = (in[0].value ())
+        | (in[1].value () << 1)
+        | (in[2].value () << 2)
+        | (in[3].value () << 3)
+        | (in[4].value () << 4)
+        | (in[5].value () << 5)
+        | (in[6].value () << 6)
+        | (in[7].value () << 7);
+    }
+  for (uint32_t j = 0; j < numBits % 8; j++)
+    {
+      output[fullBytes] |= bits[8 * fullBytes + j].value () << j;
+    }
+}
+
+} // namespace ns3
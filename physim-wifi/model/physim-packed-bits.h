@@ -0,0 +1,110 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#ifndef PHYSIM_PACKED_BITS_H
+#define PHYSIM_PACKED_BITS_H
+
+#include <itpp/itcomm.h>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief A sequence of bits, stored as packed bytes.
+ *
+ * Bits are stored in transmission order, i.e. bit i of the sequence is bit (i % 8) of byte (i / 8), where bit 0
+ * is the least significant bit. This is the same order in which PhySimWifiPhy serializes the payload of a packet
+ * (see PhySimHelper::DecToBin), so the bytes of a packet can be used as they are. Conversion from and to the
+ * itpp::bvec representation used by the signal processing chain is table-driven and linear in the number of bits.
+ */
+class PhySimPackedBits
+{
+public:
+  PhySimPackedBits ();
+  /**
+   * Creates a bit sequence from a sequence of bytes
+   * \param bytes    The bytes, e.g. the payload of a packet
+   * \param numBytes The number of bytes
+   */
+  PhySimPackedBits (const uint8_t *bytes, uint32_t numBytes);
+  /**
+   * Creates a bit sequence by packing the given bit vector
+   * \param bits The bit vector
+   */
+  explicit PhySimPackedBits (const itpp::bvec &bits);
+
+  /**
+   * Changes the number of bits of the sequence. New bits are set to zero.
+   * \param numBits The new number of bits
+   */
+  void Resize (uint32_t numBits);
+  /**
+   * \return The number of bits of the sequence
+   */
+  uint32_t GetNBits (void) const;
+  /**
+   * \return The number of bytes needed to store the sequence
+   */
+  uint32_t GetNBytes (void) const;
+  /**
+   * \return Pointer to the packed bytes. If the number of bits is not a multiple of 8, the unused bits of the
+   *         last byte are zero.
+   */
+  const uint8_t * GetBytes (void) const;
+  /**
+   * \return Pointer to the packed bytes, for modification
+   */
+  uint8_t * GetBytes (void);
+  /**
+   * \param index The index of the bit
+   * \return      The value of the bit
+   */
+  bool GetBit (uint32_t index) const;
+  /**
+   * \return The bit sequence as bit vector
+   */
+  itpp::bvec ToBvec (void) const;
+
+  /**
+   * Unpacks bits into a bit vector using a lookup table of 256 entries
+   * \param bytes   The packed bytes
+   * \param numBits The number of bits to unpack
+   * \param output  The output buffer of at least numBits elements
+   */
+  static void Unpack (const uint8_t *bytes, uint32_t numBits, itpp::bin *output);
+  /**
+   * Packs bits of a bit vector into bytes
+   * \param bits    The bits
+   * \param numBits The number of bits to pack
+   * \param output  The output buffer of at least (numBits + 7) / 8 bytes
+   */
+  static void Pack (const itpp::bin *bits, uint32_t numBits, uint8_t *output);
+
+private:
+  std::vector<uint8_t> m_bytes;
+  uint32_t m_nBits;
+};
+
+} // namespace ns3
+
+#endif /* PHYSIM_PACKED_BITS_H */
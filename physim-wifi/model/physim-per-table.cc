@@ -0,0 +1,324 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "physim-per-table.h"
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+
+NS_LOG_COMPONENT_DEFINE ("PhySimPerTable");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (PhySimPerTable);
+
+const uint16_t PhySimPerTable::VERSION;
+const uint32_t PhySimPerTable::AWGN_PROFILE;
+
+template <typename T>
+static void
+WriteValue (std::ofstream &out, T value)
+{
+  out.write (reinterpret_cast<const char *> (&value), sizeof (T));
+}
+
+template <typename T>
+static T
+ReadValue (std::ifstream &in)
+{
+  T value = 0;
+  in.read (reinterpret_cast<char *> (&value), sizeof (T));
+  return value;
+}
+
+TypeId
+PhySimPerTable::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PhySimPerTable")
+    .SetParent<Object> ()
+    .AddConstructor<PhySimPerTable> ()
+  ;
+  return tid;
+}
+
+PhySimPerTable::PhySimPerTable ()
+{
+}
+
+PhySimPerTable::~PhySimPerTable ()
+{
+}
+
+void
+PhySimPerTable::SetGrid (const std::vector<double> &snrs, const std::vector<std::string> &modes,
+                         const std::vector<uint32_t> &lengths, const std::vector<uint32_t> &profiles)
+{
+  m_snrs = snrs;
+  m_modes = modes;
+  m_lengths = lengths;
+  m_profiles = profiles;
+  Record empty = { 0, 0, 0, 0, 0, 1.0, 0.5 };
+  m_records.assign (snrs.size () * modes.size () * lengths.size () * profiles.size (), empty);
+}
+
+uint32_t
+PhySimPerTable::GetIndex (uint32_t snr, uint32_t mode, uint32_t length, uint32_t profile) const
+{
+  return ((profile * m_modes.size () + mode) * m_lengths.size () + length) * m_snrs.size () + snr;
+}
+
+uint32_t
+PhySimPerTable::GetNRecords (void) const
+{
+  return m_records.size ();
+}
+
+void
+PhySimPerTable::SetRecord (uint32_t index, uint32_t txCount, uint32_t rxOkCount, uint32_t payloadCount,
+                           uint64_t payloadBits, uint64_t bitErrors)
+{
+  NS_ASSERT (index < m_records.size ());
+  Record &r = m_records[index];
+  r.txCount = txCount;
+  r.rxOkCount = rxOkCount;
+  r.payloadCount = payloadCount;
+  r.payloadBits = payloadBits;
+  r.bitErrors = bitErrors;
+  r.per = (txCount > 0) ? 1.0 - (double) rxOkCount / txCount : 1.0;
+  r.ber = (payloadBits > 0) ? (double) bitErrors / payloadBits : 0.5;
+}
+
+const PhySimPerTable::Record&
+PhySimPerTable::GetRecord (uint32_t index) const
+{
+  NS_ASSERT (index < m_records.size ());
+  return m_records[index];
+}
+
+bool
+PhySimPerTable::Save (std::string filename) const
+{
+  std::ofstream out (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out.is_open ())
+    {
+      return false;
+    }
+  out.write ("PPER", 4);
+  WriteValue<uint16_t> (out, VERSION);
+  WriteValue<uint16_t> (out, 0);
+  WriteValue<uint32_t> (out, m_snrs.size ());
+  WriteValue<uint32_t> (out, m_modes.size ());
+  WriteValue<uint32_t> (out, m_lengths.size ());
+  WriteValue<uint32_t> (out, m_profiles.size ());
+  for (uint32_t i = 0; i < m_snrs.size (); i++)
+    {
+      WriteValue<double> (out, m_snrs[i]);
+    }
+  for (uint32_t i = 0; i < m_modes.size (); i++)
+    {
+      WriteValue<uint8_t> (out, m_modes[i].size ());
+      out.write (m_modes[i].c_str (), m_modes[i].size ());
+    }
+  for (uint32_t i = 0; i < m_lengths.size (); i++)
+    {
+      WriteValue<uint32_t> (out, m_lengths[i]);
+    }
+  for (uint32_t i = 0; i < m_profiles.size (); i++)
+    {
+      WriteValue<uint32_t> (out, m_profiles[i]);
+    }
+  for (uint32_t i = 0; i < m_records.size (); i++)
+    {
+      const Record &r = m_records[i];
+      WriteValue<uint32_t> (out, r.txCount);
+      WriteValue<uint32_t> (out, r.rxOkCount);
+      WriteValue<uint32_t> (out, r.payloadCount);
+      WriteValue<uint64_t> (out, r.payloadBits);
+      WriteValue<uint64_t> (out, r.bitErrors);
+      WriteValue<double> (out, r.per);
+      WriteValue<double> (out, r.ber);
+    }
+  return out.good ();
+}
+
+bool
+PhySimPerTable::Load (std::string filename)
+{
+  std::ifstream in (filename.c_str (), std::ios::in | std::ios::binary);
+  char magic[4];
+  in.read (magic, 4);
+  if (!in.good () || std::string (magic, 4) != "PPER")
+    {
+      NS_LOG_WARN ("PhySimPerTable::Load() - " << filename << " is not a PER table");
+      return false;
+    }
+  uint16_t version = ReadValue<uint16_t> (in);
+  ReadValue<uint16_t> (in);
+  if (version != VERSION)
+    {
+      NS_LOG_WARN ("PhySimPerTable::Load() - unsupported format version " << version << " of " << filename);
+      return false;
+    }
+
+  std::vector<double> snrs (ReadValue<uint32_t> (in));
+  std::vector<std::string> modes (ReadValue<uint32_t> (in));
+  std::vector<uint32_t> lengths (ReadValue<uint32_t> (in));
+  std::vector<uint32_t> profiles (ReadValue<uint32_t> (in));
+  for (uint32_t i = 0; i < snrs.size (); i++)
+    {
+      snrs[i] = ReadValue<double> (in);
+    }
+  for (uint32_t i = 0; i < modes.size (); i++)
+    {
+      std::vector<char> name (ReadValue<uint8_t> (in) + 1, 0);
+      in.read (&name[0], name.size () - 1);
+      modes[i] = std::string (&name[0]);
+    }
+  for (uint32_t i = 0; i < lengths.size (); i++)
+    {
+      lengths[i] = ReadValue<uint32_t> (in);
+    }
+  for (uint32_t i = 0; i < profiles.size (); i++)
+    {
+      profiles[i] = ReadValue<uint32_t> (in);
+    }
+  SetGrid (snrs, modes, lengths, profiles);
+  for (uint32_t i = 0; i < m_records.size (); i++)
+    {
+      Record &r = m_records[i];
+      r.txCount = ReadValue<uint32_t> (in);
+      r.rxOkCount = ReadValue<uint32_t> (in);
+      r.payloadCount = ReadValue<uint32_t> (in);
+      r.payloadBits = ReadValue<uint64_t> (in);
+      r.bitErrors = ReadValue<uint64_t> (in);
+      r.per = ReadValue<double> (in);
+      r.ber = ReadValue<double> (in);
+    }
+  if (!in.good ())
+    {
+      NS_LOG_WARN ("PhySimPerTable::Load() - " << filename << " is truncated");
+      SetGrid (std::vector<double> (), std::vector<std::string> (), std::vector<uint32_t> (), std::vector<uint32_t> ());
+      return false;
+    }
+  NS_LOG_DEBUG ("PhySimPerTable::Load() - " << m_records.size () << " records read from " << filename);
+  return true;
+}
+
+bool
+PhySimPerTable::HasCurve (std::string mode, uint32_t profile) const
+{
+  if (m_snrs.empty () || m_lengths.empty ())
+    {
+      return false;
+    }
+  bool hasMode = false;
+  for (uint32_t m = 0; m < m_modes.size (); m++)
+    {
+      hasMode = hasMode || (m_modes[m] == mode);
+    }
+  bool hasProfile = false;
+  for (uint32_t p = 0; p < m_profiles.size (); p++)
+    {
+      hasProfile = hasProfile || (m_profiles[p] == profile);
+    }
+  return hasMode && hasProfile;
+}
+
+void
+PhySimPerTable::FindCurve (std::string mode, uint32_t length, uint32_t profile, uint32_t &m, uint32_t &l, uint32_t &p) const
+{
+  NS_ASSERT_MSG (HasCurve (mode, profile), "PhySimPerTable::FindCurve() - no curve for mode " << mode << " and profile " << profile);
+  for (m = 0; m_modes[m] != mode; m++)
+    {
+    }
+  for (p = 0; m_profiles[p] != profile; p++)
+    {
+    }
+  l = 0;
+  for (uint32_t i = 1; i < m_lengths.size (); i++)
+    {
+      if (std::abs ((double) m_lengths[i] - length) < std::abs ((double) m_lengths[l] - length))
+        {
+          l = i;
+        }
+    }
+}
+
+double
+PhySimPerTable::GetScaledPer (uint32_t i, uint32_t m, uint32_t l, uint32_t p, uint32_t length) const
+{
+  double per = m_records[GetIndex (i, m, l, p)].per;
+  if (length == m_lengths[l] || m_lengths[l] == 0)
+    {
+      return per;
+    }
+  return 1.0 - std::pow (1.0 - per, (double) length / m_lengths[l]);
+}
+
+double
+PhySimPerTable::GetPer (std::string mode, uint32_t length, uint32_t profile, double snr) const
+{
+  uint32_t m, l, p;
+  FindCurve (mode, length, profile, m, l, p);
+  if (snr <= m_snrs.front ())
+    {
+      return GetScaledPer (0, m, l, p, length);
+    }
+  if (snr >= m_snrs.back ())
+    {
+      return GetScaledPer (m_snrs.size () - 1, m, l, p, length);
+    }
+  uint32_t i = 1;
+  while (m_snrs[i] < snr)
+    {
+      i++;
+    }
+  double w = (snr - m_snrs[i - 1]) / (m_snrs[i] - m_snrs[i - 1]);
+  return (1 - w) * GetScaledPer (i - 1, m, l, p, length) + w * GetScaledPer (i, m, l, p, length);
+}
+
+double
+PhySimPerTable::GetSnrForPer (std::string mode, uint32_t length, uint32_t profile, double per) const
+{
+  uint32_t m, l, p;
+  FindCurve (mode, length, profile, m, l, p);
+  double previous = GetScaledPer (0, m, l, p, length);
+  if (previous <= per)
+    {
+      return m_snrs.front ();
+    }
+  for (uint32_t i = 1; i < m_snrs.size (); i++)
+    {
+      double current = GetScaledPer (i, m, l, p, length);
+      if (current <= per)
+        {
+          double w = (previous - per) / (previous - current);
+          return m_snrs[i - 1] + w * (m_snrs[i] - m_snrs[i - 1]);
+        }
+      previous = current;
+    }
+  return m_snrs.back ();
+}
+
+} // namespace ns3
@@ -0,0 +1,156 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#ifndef PHYSIM_PER_TABLE_H
+#define PHYSIM_PER_TABLE_H
+
+#include "ns3/object.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Packet error rate curves of the PhySimWifiPhy signal processing chain
+ *
+ * The table holds one record per combination of SNR, WiFi mode, frame length and channel profile, as produced by
+ * the example physim-per-calibration. It is stored in a binary file in host byte order:
+ *
+ *   char[4]  "PPER"
+ *   uint16   format version (currently 2)
+ *   uint16   reserved
+ *   uint32   number of SNR values, WiFi modes, frame lengths and channel profiles
+ *   float64  the SNR values (in dB), in increasing order
+ *   for each WiFi mode: uint8 length of the unique name, followed by the name
+ *   uint32   the frame lengths (PSDU size in bytes)
+ *   uint32   the channel profiles (VEHICULAR_CHANNEL_PROFILE, or AWGN_PROFILE without fading)
+ *   records  for each profile, mode, length and SNR (the SNR varying fastest):
+ *            uint32 transmitted frames, uint32 successfully received frames,
+ *            uint32 frames whose payload was decoded, uint64 bits in these payloads,
+ *            uint64 bit errors in these payloads, float64 PER, float64 BER
+ *
+ * The PER of a frame is interpolated linearly between the SNR values and taken from the calibrated length closest
+ * to the length of the frame, scaled to the frame length assuming independent errors per byte.
+ */
+class PhySimPerTable : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  static const uint16_t VERSION = 2;
+  /**
+   * Channel profile value of curves calibrated without fading, as used for the effective SINR lookup
+   */
+  static const uint32_t AWGN_PROFILE = 0xffffffff;
+
+  /**
+   * Simulation result of a single point of the grid
+   */
+  struct Record
+  {
+    uint32_t txCount;
+    uint32_t rxOkCount;
+    uint32_t payloadCount;
+    uint64_t payloadBits;
+    uint64_t bitErrors;
+    double per;
+    double ber;
+  };
+
+  PhySimPerTable ();
+  virtual ~PhySimPerTable ();
+
+  /**
+   * Defines the grid of the table and resets all records
+   * \param snrs     The SNR values (in dB), in increasing order
+   * \param modes    The unique names of the WiFi modes
+   * \param lengths  The frame lengths (PSDU size in bytes)
+   * \param profiles The channel profiles
+   */
+  void SetGrid (const std::vector<double> &snrs, const std::vector<std::string> &modes,
+                const std::vector<uint32_t> &lengths, const std::vector<uint32_t> &profiles);
+  /**
+   * \return The index of the record of the given grid point, the SNR varying fastest
+   */
+  uint32_t GetIndex (uint32_t snr, uint32_t mode, uint32_t length, uint32_t profile) const;
+  /**
+   * \return The number of records (grid points) of the table
+   */
+  uint32_t GetNRecords (void) const;
+  /**
+   * Stores the frame counts of a grid point and derives its PER and BER from them
+   */
+  void SetRecord (uint32_t index, uint32_t txCount, uint32_t rxOkCount, uint32_t payloadCount,
+                  uint64_t payloadBits, uint64_t bitErrors);
+  const Record& GetRecord (uint32_t index) const;
+
+  /**
+   * Writes the table into the given binary file
+   * \return False if the file could not be written
+   */
+  bool Save (std::string filename) const;
+  /**
+   * Replaces the table by the content of the given binary file
+   * \return False if the file could not be read or has an unsupported format
+   */
+  bool Load (std::string filename);
+
+  /**
+   * \return Whether the table holds the PER curves of the given WiFi mode and channel profile
+   */
+  bool HasCurve (std::string mode, uint32_t profile) const;
+  /**
+   * Returns the PER of a frame at the given SNR. The curve must exist (see HasCurve).
+   * \param mode    The unique name of the WiFi mode
+   * \param length  The frame length (PSDU size in bytes)
+   * \param profile The channel profile
+   * \param snr     The SNR (in dB)
+   */
+  double GetPer (std::string mode, uint32_t length, uint32_t profile, double snr) const;
+  /**
+   * Returns the lowest SNR (in dB) at which the PER of a frame drops to the given value, interpolated linearly
+   * between the SNR values of the table. The smallest (largest) SNR value of the table is returned if the PER is
+   * already below (never reaches) the given value.
+   */
+  double GetSnrForPer (std::string mode, uint32_t length, uint32_t profile, double per) const;
+
+private:
+  /**
+   * Returns the index of the given mode and profile and of the calibrated length closest to the given length
+   */
+  void FindCurve (std::string mode, uint32_t length, uint32_t profile, uint32_t &m, uint32_t &l, uint32_t &p) const;
+  /**
+   * \return The PER at the i-th SNR value, scaled from the calibrated length to the given length
+   */
+  double GetScaledPer (uint32_t i, uint32_t m, uint32_t l, uint32_t p, uint32_t length) const;
+
+  std::vector<double> m_snrs;
+  std::vector<std::string> m_modes;
+  std::vector<uint32_t> m_lengths;
+  std::vector<uint32_t> m_profiles;
+  std::vector<Record> m_records;
+};
+
+} // namespace ns3
+
+#endif /* PHYSIM_PER_TABLE_H */
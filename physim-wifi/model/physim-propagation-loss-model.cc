@@ -30,6 +30,8 @@
 #include "ns3/double.h"
 #include "ns3/uinteger.h"
 #include "ns3/enum.h"
+#include <limits>
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("PhySimPropagationLossModel");
 
@@ -82,6 +84,27 @@ PhySimPropagationLossModel::DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<
   return;
 }
 
+double
+PhySimPropagationLossModel::GetMaxGainDb (double distance, double frequency) const
+{
+  double gain = DoGetMaxGainDb (distance, frequency);
+  if (m_next != 0)
+    {
+      gain += m_next->GetMaxGainDb (distance, frequency);
+    }
+  return gain;
+}
+
+double
+PhySimPropagationLossModel::DoGetMaxGainDb (double distance, double frequency) const
+{
+  if (GetInstanceTypeId () == PhySimPropagationLossModel::GetTypeId ())
+    {
+      return 0.0;
+    }
+  return std::numeric_limits<double>::infinity ();
+}
+
 // ------------------------------------------------------------------------- //
 
 NS_OBJECT_ENSURE_REGISTERED (PhySimFriisSpacePropagationLoss);
@@ -128,10 +151,19 @@ PhySimFriisSpacePropagationLoss::DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag,
   double m_pathLoss = 10 * log10 (numerator / denominator);
   NS_LOG_DEBUG ("PhySimFriisSpacePropagationLoss::DoCalcRxPower() m_pathLoss = " << m_pathLoss);
 
-  itpp::cvec input = tag->GetRxedSamples ();
-  itpp::cvec output = input * sqrt (pow (10, m_pathLoss / 10.0));
   tag->SetPathLoss (m_pathLoss);
-  tag->SetRxSamples (output);
+  tag->ScaleRxSamples (sqrt (pow (10, m_pathLoss / 10.0)));
+}
+
+double
+PhySimFriisSpacePropagationLoss::DoGetMaxGainDb (double distance, double frequency) const
+{
+  if (distance <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  double lambda = m_speedOfLight / frequency;
+  return 10 * log10 ((lambda * lambda) / (16 * M_PI * M_PI * distance * distance * m_systemLoss));
 }
 
 // ------------------------------------------------------------------------- //
@@ -206,10 +238,8 @@ PhySimTwoRayGroundPropagationLossModel::DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag
     }
   NS_LOG_DEBUG ("PhySimTwoRayGroundPropagationLossModel::DoCalcRxPower() m_pathLoss = " << m_pathLoss);
 
-  itpp::cvec input = tag->GetRxedSamples ();
-  itpp::cvec output = input * sqrt (pow (10, m_pathLoss / 10.0));
   tag->SetPathLoss (m_pathLoss);
-  tag->SetRxSamples (output);
+  tag->ScaleRxSamples (sqrt (pow (10, m_pathLoss / 10.0)));
 
 }
 
@@ -251,10 +281,14 @@ PhySimConstantPropagationLoss::DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<
                                                 MobilityModel> a, Ptr<MobilityModel> b) const
 {
   NS_LOG_DEBUG ("PhySimConstantPropagationLoss::DoCalcRxPower() m_pathLoss = " << m_pathLoss);
-  itpp::cvec input = tag->GetRxedSamples ();
-  itpp::cvec output = input * sqrt (pow (10, (-1.0) * m_pathLoss / 10.0));
   tag->SetPathLoss (m_pathLoss);
-  tag->SetRxSamples (output);
+  tag->ScaleRxSamples (sqrt (pow (10, (-1.0) * m_pathLoss / 10.0)));
+}
+
+double
+PhySimConstantPropagationLoss::DoGetMaxGainDb (double distance, double frequency) const
+{
+  return (-1.0) * m_pathLoss;
 }
 
 // ------------------------------------------------------------------------- //
@@ -303,10 +337,18 @@ PhySimLogDistancePropagationLoss::DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag,
   m_pathLoss = (-1.0) * m_pathLoss;
   NS_LOG_DEBUG ("PhySimLogDistancePropagationLoss::DoCalcRxPower() m_pathLoss = " << m_pathLoss);
 
-  itpp::cvec input = tag->GetRxedSamples ();
-  itpp::cvec output = input * sqrt (pow (10, m_pathLoss / 10.0));
   tag->SetPathLoss (m_pathLoss);
-  tag->SetRxSamples (output);
+  tag->ScaleRxSamples (sqrt (pow (10, m_pathLoss / 10.0)));
+}
+
+double
+PhySimLogDistancePropagationLoss::DoGetMaxGainDb (double distance, double frequency) const
+{
+  if (distance <= 0)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  return (-1.0) * (m_referenceLoss + 10 * m_exponent * log10 (distance / m_referenceDistance));
 }
 
 // ------------------------------------------------------------------------- //
@@ -398,10 +440,34 @@ PhySimThreeLogDistancePropagationLoss::DoCalcRxPower (
   m_pathLoss = (-1.0) * m_pathLoss;
   NS_LOG_DEBUG ("PhySimThreeLogDistancePropagationLoss::DoCalcRxPower() m_pathLoss = " << m_pathLoss);
 
-  itpp::cvec input = tag->GetRxedSamples ();
-  itpp::cvec output = input * sqrt (pow (10, m_pathLoss / 10.0));
   tag->SetPathLoss (m_pathLoss);
-  tag->SetRxSamples (output);
+  tag->ScaleRxSamples (sqrt (pow (10, m_pathLoss / 10.0)));
+}
+
+double
+PhySimThreeLogDistancePropagationLoss::DoGetMaxGainDb (double distance, double frequency) const
+{
+  // Below distance0 no loss is applied, beyond the loss grows with the distance
+  double pathLoss;
+  if (distance < m_distance0)
+    {
+      return std::max (0.0, (-1.0) * m_referenceLoss);
+    }
+  else if (distance < m_distance1)
+    {
+      pathLoss = m_referenceLoss + 10 * m_exponent0 * log10 (distance / m_distance0);
+    }
+  else if (distance < m_distance2)
+    {
+      pathLoss = m_referenceLoss + 10 * m_exponent0 * log10 (m_distance1 / m_distance0)
+        + 10 * m_exponent1 * log10 (distance / m_distance1);
+    }
+  else
+    {
+      pathLoss = m_referenceLoss + 10 * m_exponent0 * log10 (m_distance1 / m_distance0)
+        + 10 * m_exponent1 * log10 (m_distance2 / m_distance1) + 10 * m_exponent2 * log10 (distance / m_distance2);
+    }
+  return (-1.0) * pathLoss;
 }
 
 // ------------------------------------------------------------------------- //
@@ -471,9 +537,7 @@ PhySimShadowingPropagationLoss::DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<
 
   NS_LOG_DEBUG ("PhySimShadowingPropagationLoss::DoCalcRxPower() m_pathLoss = " << m_pathLoss);
 
-  itpp::cvec input = tag->GetRxedSamples ();
-  itpp::cvec output = input * sqrt (pow (10, m_pathLoss / 10.0));
-  tag->SetRxSamples (output);
+  tag->ScaleRxSamples (sqrt (pow (10, m_pathLoss / 10.0)));
 }
 
 // ------------------------------------------------------------------------- //
@@ -523,7 +587,7 @@ void
 PhySimRicianPropagationLoss::DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<
                                               MobilityModel> a, Ptr<MobilityModel> b) const
 {
-  itpp::cvec input (tag->GetRxedSamples ());
+  const itpp::cvec &input = tag->PeekRxedSamples ();
   NS_LOG_DEBUG ("PhySimRicianPropagationLoss::DoCalcRxPower() input.size() = " << input.size ());
   itpp::cvec output (input.size ());
   itpp::cvec coeff (output.size ());
@@ -705,7 +769,7 @@ PhySimTappedDelayLinePropagationLoss::DoCalcRxPower (
   NS_LOG_DEBUG ("PhySimTappedDelayLinePropagationLoss::DoCalcRxPower() m_maxDoppler = " << m_maxDoppler);
   NS_LOG_DEBUG ("PhySimTappedDelayLinePropagationLoss::DoCalcRxPower() m_normDoppler = " << m_normDoppler);
 
-  itpp::cvec input = tag->GetRxedSamples ();
+  const itpp::cvec &input = tag->PeekRxedSamples ();
   itpp::Array<itpp::cvec> coeff;
   itpp::cvec output = m_channel.filter (input, coeff);
 
@@ -793,7 +857,7 @@ PhySimVehicularChannelPropagationLoss::DoCalcRxPower (
 
   m_channel->set_relative_speed (relativeSpeed);
   NS_LOG_DEBUG ("PhySimVehicularChannelPropagationLoss::DoCalcRxPower() relativeSpeed = " << relativeSpeed);
-  itpp::cvec input = tag->GetRxedSamples ();
+  const itpp::cvec &input = tag->PeekRxedSamples ();
   itpp::Array<itpp::cvec> coeff;
   itpp::cvec output;
   m_channel->filter (input, output, coeff);
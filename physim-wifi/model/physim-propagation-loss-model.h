@@ -64,11 +64,26 @@ public:
    * \param b the mobility model of the destination
    */
   void CalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  /**
+   * Returns an upper bound of the gain (in dB, i.e. usually negative) that this model and all chained models
+   * apply to the power of a signal, for any link whose length is at least the given distance. The bound does
+   * not increase with the distance. Models that apply random fading, or whose loss does not only depend on the
+   * distance, provide no bound (positive infinity).
+   * \param distance  The minimum length of the link (m)
+   * \param frequency The center frequency of the signal (Hz)
+   * \return          The upper bound of the gain (dB)
+   */
+  double GetMaxGainDb (double distance, double frequency) const;
 
 private:
   PhySimPropagationLossModel (const PhySimPropagationLossModel &o);
   PhySimPropagationLossModel &operator = (const PhySimPropagationLossModel &o);
   virtual void DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  /**
+   * Returns the bound of GetMaxGainDb for this model only. The dummy entry point applies no gain, every other
+   * model which does not override this method provides no bound.
+   */
+  virtual double DoGetMaxGainDb (double distance, double frequency) const;
 
   Ptr<PhySimPropagationLossModel> m_next;
 };
@@ -121,6 +136,7 @@ private:
   PhySimFriisSpacePropagationLoss (const PhySimFriisSpacePropagationLoss &o);
   PhySimFriisSpacePropagationLoss &operator = (const PhySimFriisSpacePropagationLoss &o);
   virtual void DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual double DoGetMaxGainDb (double distance, double frequency) const;
 
   double m_speedOfLight;
   double m_systemLoss;
@@ -171,6 +187,7 @@ private:
   PhySimConstantPropagationLoss (const PhySimConstantPropagationLoss &o);
   PhySimConstantPropagationLoss & operator = (const PhySimConstantPropagationLoss &o);
   virtual void DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual double DoGetMaxGainDb (double distance, double frequency) const;
 
   double m_pathLoss;
 };
@@ -221,6 +238,7 @@ private:
   PhySimLogDistancePropagationLoss (const PhySimLogDistancePropagationLoss &o);
   PhySimLogDistancePropagationLoss &operator = (const PhySimLogDistancePropagationLoss &o);
   virtual void DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual double DoGetMaxGainDb (double distance, double frequency) const;
 
   double m_exponent;
   double m_referenceDistance;
@@ -250,6 +268,7 @@ private:
   PhySimThreeLogDistancePropagationLoss (const PhySimThreeLogDistancePropagationLoss &o);
   PhySimThreeLogDistancePropagationLoss &operator = (const PhySimThreeLogDistancePropagationLoss &o);
   virtual void DoCalcRxPower (Ptr<PhySimWifiPhyTag> tag, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual double DoGetMaxGainDb (double distance, double frequency) const;
 
   double m_distance0;
   double m_distance1;
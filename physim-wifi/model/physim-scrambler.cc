@@ -22,7 +22,10 @@
 
 #include "ns3/log.h"
 #include "ns3/boolean.h"
+#include "ns3/assert.h"
 #include "physim-scrambler.h"
+#include <algorithm>
+#include <cstring>
 
 NS_LOG_COMPONENT_DEFINE ("PhySimScrambler");
 
@@ -41,11 +44,44 @@ PhySimScrambler::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PhySimScrambler::m_fixedScrambler),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseLookupTable",
+                   "Flag indicating whether to scramble with precomputed scrambling sequences on packed bits (bit-exact, but faster) "
+                   "instead of advancing the shift register bit by bit",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&PhySimScrambler::m_useLookupTable),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
+/*
+ * The scrambling sequences of all 128 initial states, each for 8 periods of 127 bits, packed into 127 bytes
+ */
+class PhySimScramblerTable
+{
+public:
+  PhySimScramblerTable ()
+  {
+    for (uint32_t state = 0; state < 128; state++)
+      {
+        uint8_t reg = state;
+        memset (m_sequences[state], 0, 127);
+        for (uint32_t i = 0; i < 8 * 127; i++)
+          {
+            uint8_t feedback = ((reg >> 3) ^ (reg >> 6)) & 1; // x^4 + x^7
+            m_sequences[state][i / 8] |= feedback << (i % 8);
+            reg = ((reg << 1) | feedback) & 0x7f;
+          }
+      }
+  }
+  uint8_t m_sequences[128][127];
+};
+
+static const PhySimScramblerTable g_scramblerTable;
+
 PhySimScrambler::PhySimScrambler ()
+  : m_fixedScrambler (false),
+    m_useLookupTable (true)
 {
 }
 
@@ -60,7 +96,15 @@ PhySimScrambler::~PhySimScrambler ()
 itpp::bvec
 PhySimScrambler::Scramble (const itpp::bvec& input)
 {
+  return Scramble (input, GetInitialState ());
+}
 
+/*!
+ * \brief Returns the initial state of the scrambler for the next frame.
+ */
+itpp::bvec
+PhySimScrambler::GetInitialState (void)
+{
   itpp::bvec initialState (7);
   if (m_fixedScrambler)
     {
@@ -73,8 +117,7 @@ PhySimScrambler::Scramble (const itpp::bvec& input)
       NS_LOG_DEBUG ("PhySimScrambler:Scramble() using random initialState for scrambler");
       initialState = itpp::randb (7);
     }
-
-  return Scramble (input, initialState);
+  return initialState;
 }
 
 /*!
@@ -82,6 +125,22 @@ PhySimScrambler::Scramble (const itpp::bvec& input)
  */
 itpp::bvec
 PhySimScrambler::Scramble (const itpp::bvec& input, itpp::bvec initialState)
+{
+  if (!m_useLookupTable)
+    {
+      return ScrambleBitwise (input, initialState);
+    }
+  PhySimPackedBits packed (input);
+  ApplySequence (packed.GetBytes (), packed.GetNBytes (), GetStateIndex (initialState));
+  packed.Resize (input.size ());
+  return packed.ToBvec ();
+}
+
+/*!
+ * \brief Scramble input bits using a given initial state, advancing the shift register bit by bit.
+ */
+itpp::bvec
+PhySimScrambler::ScrambleBitwise (const itpp::bvec& input, itpp::bvec initialState) const
 {
 
   itpp::bvec shiftRegister (initialState);
@@ -121,4 +180,67 @@ PhySimScrambler::DeScramble (const itpp::bvec& input, itpp::bvec initialState)
   return data;
 }
 
+PhySimPackedBits
+PhySimScrambler::Scramble (const PhySimPackedBits& input, itpp::bvec initialState) const
+{
+  PhySimPackedBits output (input);
+  ApplySequence (output.GetBytes (), output.GetNBytes (), GetStateIndex (initialState));
+  output.Resize (input.GetNBits ());
+  return output;
+}
+
+PhySimPackedBits
+PhySimScrambler::DeScramble (const PhySimPackedBits& input, itpp::bvec initialState) const
+{
+  PhySimPackedBits data = Scramble (input, itpp::reverse (initialState));
+
+  // Prepend seven 0-bits, i.e. shift all bits by 7 positions
+  PhySimPackedBits output;
+  output.Resize (input.GetNBits () + 7);
+  const uint8_t *in = data.GetBytes ();
+  uint8_t *out = output.GetBytes ();
+  uint8_t previous = 0;
+  for (uint32_t i = 0; i < output.GetNBytes (); i++)
+    {
+      uint8_t current = (i < data.GetNBytes ()) ? in[i] : 0;
+      out[i] = ((current << 7) & 0xff) | (previous >> 1);
+      previous = current;
+    }
+  return output;
+}
+
+uint8_t
+PhySimScrambler::GetStateIndex (const itpp::bvec& state)
+{
+  NS_ASSERT (state.size () == 7);
+  uint8_t index = 0;
+  for (uint32_t k = 0; k < 7; k++)
+    {
+      index |= state (k).value () << k;
+    }
+  return index;
+}
+
+const uint8_t *
+PhySimScrambler::GetSequence (const itpp::bvec& initialState)
+{
+  return g_scramblerTable.m_sequences[GetStateIndex (initialState)];
+}
+
+void
+PhySimScrambler::ApplySequence (uint8_t *bytes, uint32_t numBytes, uint8_t state)
+{
+  const uint8_t *sequence = g_scramblerTable.m_sequences[state];
+  uint32_t offset = 0;
+  while (offset < numBytes)
+    {
+      uint32_t chunk = std::min (numBytes - offset, (uint32_t) 127);
+      for (uint32_t i = 0; i < chunk; i++)
+        {
+          bytes[offset + i] ^= sequence[i];
+        }
+      offset += chunk;
+    }
+}
+
 } // namespace ns3
@@ -24,12 +24,18 @@
 #define PHYSIM_SCRAMBLER_H
 
 #include "ns3/object.h"
+#include "physim-packed-bits.h"
 #include <itpp/itcomm.h>
 
 namespace ns3 {
 
 /**
  * \brief Bit scrambler module (17.3.5.4 in Std).
+ *
+ * Since the scrambling sequence of the generator polynomial x^7 + x^4 + 1 has a period of 127 bits, the
+ * sequence of each of the 128 possible initial states is precomputed once for 8 periods (127 bytes), such
+ * that scrambling reduces to a byte-wise XOR on packed bits. The original shift register implementation
+ * is used if the attribute 'UseLookupTable' is set to false.
  */
 class PhySimScrambler : public Object
 {
@@ -43,8 +49,52 @@ public:
   itpp::bvec Scramble (const itpp::bvec& input, itpp::bvec initialState);
   itpp::bvec DeScramble (const itpp::bvec& input, itpp::bvec initialState);
 
+  /**
+   * Scrambles the given packed bits using the precomputed scrambling sequences
+   * \param input        The packed bits to scramble
+   * \param initialState The initial state of the shift register (7 bits)
+   * \return             The scrambled bits
+   */
+  PhySimPackedBits Scramble (const PhySimPackedBits& input, itpp::bvec initialState) const;
+  /**
+   * Descrambles the given packed bits using the precomputed scrambling sequences. As for the bit vector version,
+   * the state is given in reverse and seven 0-bits are added at the beginning of the returned sequence.
+   * \param input        The packed bits to descramble
+   * \param initialState The (reversed) initial state of the shift register (7 bits)
+   * \return             The descrambled bits, preceded by seven 0-bits
+   */
+  PhySimPackedBits DeScramble (const PhySimPackedBits& input, itpp::bvec initialState) const;
+
+  /**
+   * \return The initial state of the shift register for the next frame, i.e. the fixed state of the IEEE testing
+   *         mode if 'UseFixedScrambler' is set, or a random state otherwise
+   */
+  itpp::bvec GetInitialState (void);
+  /**
+   * Returns the precomputed scrambling sequence of the given initial state, e.g. to scramble a stream of bytes.
+   * Byte i of a frame is scrambled by XOR with element (i % 127) of the sequence.
+   * \param initialState The initial state of the shift register (7 bits)
+   * \return             Pointer to the 127 bytes of the sequence
+   */
+  static const uint8_t * GetSequence (const itpp::bvec& initialState);
+
 private:
+  /**
+   * Converts the bit vector representation of a shift register state into an index, where element k of the
+   * bit vector becomes bit k of the index
+   */
+  static uint8_t GetStateIndex (const itpp::bvec& state);
+  /**
+   * XORs the scrambling sequence of the given initial state into the given bytes
+   */
+  static void ApplySequence (uint8_t *bytes, uint32_t numBytes, uint8_t state);
+  /**
+   * The original implementation that advances the shift register bit by bit
+   */
+  itpp::bvec ScrambleBitwise (const itpp::bvec& input, itpp::bvec initialState) const;
+
   bool m_fixedScrambler;
+  bool m_useLookupTable;
 
 };
 
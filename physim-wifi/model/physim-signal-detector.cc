@@ -27,6 +27,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/boolean.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("PhySimSignalDetector");
 
@@ -54,7 +56,33 @@ PhySimSignalDetector::GetTypeId (void)
                    "Minimum correlation between signals to assume that there is a frame",
                    DoubleValue (0.85),
                    MakeDoubleAccessor (&PhySimSignalDetector::m_corrThresh),
-                   MakeDoubleChecker<double> ());
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("EarlyExit",
+                   "Flag indicating whether the scan for the short training symbols shall stop 'EarlyExitSamples' samples after the "
+                   "correlation threshold has been exceeded for the first time, and whether the scan for the long training symbols "
+                   "shall be bounded to the window expected from the position of the short training symbols. In this mode, "
+                   "correlation values are only recorded if a sink is connected to the correlation trace sources.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PhySimSignalDetector::m_earlyExit),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EarlyExitSamples",
+                   "The number of sample positions that are still evaluated after the first threshold crossing in early exit mode",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&PhySimSignalDetector::m_earlyExitSamples),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LongSymbolSearchMargin",
+                   "The number of samples by which the scan for the long training symbols is extended on both sides of the "
+                   "expected window in early exit mode",
+                   UintegerValue (32),
+                   MakeUintegerAccessor (&PhySimSignalDetector::m_longSymbolSearchMargin),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("ShortSymbolCorrelations",
+                     "The correlation values computed during the scan for the short training symbols",
+                     MakeTraceSourceAccessor (&PhySimSignalDetector::m_shortSymbolCorrelationsTrace))
+    .AddTraceSource ("LongSymbolCorrelations",
+                     "The correlation values computed during the scan for the long training symbols",
+                     MakeTraceSourceAccessor (&PhySimSignalDetector::m_longSymbolCorrelationsTrace))
+  ;
   return tid;
 }
 
@@ -84,7 +112,21 @@ PhySimSignalDetector::DetectPreamble (Ptr<Packet> packet, Ptr<PhySimWifiPhyTag>
     {
       // If we were successful, we try to perform finer time synchronization using the long training symbols
       // Note: due to the guard interval, the time sample number has to be reduced by 32.
-      beginLongSymbols = ScanForLongTrainingSymbols (tag, input(beginShortSymbols + 80, input.size() - 1));
+      itpp::cvec remainder = input(beginShortSymbols + 80, input.size() - 1);
+      int32_t first = 0;
+      int32_t last = remainder.size () - 64;
+      if (m_earlyExit)
+        {
+          // The two long training symbols are expected 112 and 176 samples after the start of the remaining input
+          first = std::max (first, 112 - (int32_t) m_longSymbolSearchMargin);
+          last = std::min (last, 176 + (int32_t) m_longSymbolSearchMargin);
+          NS_LOG_DEBUG ("PhySimSignalDetector:DetectPreamble() bounded long symbol search to [" << first << "," << last << "]");
+        }
+      if (first > last)
+        {
+          return false;
+        }
+      beginLongSymbols = ScanForLongTrainingSymbols (tag, remainder, first, last);
       beginLongSymbols = beginLongSymbols - 32 + 80;
 
       NS_LOG_DEBUG ("PhySimSignalDetector:DetectPreamble() beginLongSymbols = " << beginLongSymbols);
@@ -112,7 +154,7 @@ PhySimSignalDetector::ScanForShortTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, co
   int32_t begin = -1;
 
   // Define some helper variables
-  uint32_t scanWindowSize;
+  int32_t scanWindowSize;
 
   // Configure ourselves, depending on the selected correlation method
   if (m_autoCorrelation)
@@ -126,47 +168,61 @@ PhySimSignalDetector::ScanForShortTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, co
       scanWindowSize = 16;
     }
 
-  // Define some further helper variables
-  itpp::vec norminput (input.size());
-  for (int i = 0; i < input.size(); ++i)
-    {
-      norminput(i) = std::norm (input(i));
-    }
-
+  // Perform the actual correlation scan. The sums over the sliding window are updated
+  // incrementally from one position to the next, and recomputed from scratch once per
+  // window length in order to bound the accumulation of rounding errors.
+  const std::complex<double> *x = input._data ();
+  int32_t max = input.size () - scanWindowSize;
 
-  // Collect correlation values to store them in the tag later
+  // Collect correlation values to store them in the tag later. In early exit mode, this is
+  // only done if somebody is listening.
+  bool record = !m_earlyExit || !m_shortSymbolCorrelationsTrace.IsEmpty ();
   std::vector<double> correlations;
+  if (record)
+    {
+      correlations.reserve (max + 1);
+    }
 
-  // Perform the actual correlation scan
+  std::complex<double> product = 0;
+  double energy = 0;
   double value;
-  int32_t start = 0;
-  int32_t end = start + (scanWindowSize - 1);
-  int32_t max = input.size () - scanWindowSize;
-
-  while (start <= max && end < input.size ())
+  for (int32_t start = 0; start <= max; start++)
     {
-      //NS_LOG_DEBUG ("PhySimSignalDetector:ScanForShortTrainingSymbols() start = " << start);
-      //NS_LOG_DEBUG ("PhySimSignalDetector:ScanForShortTrainingSymbols() end = " << end);
-      //NS_LOG_DEBUG ("PhySimSignalDetector:ScanForShortTrainingSymbols() max = " << max);
-
-      // Calculate the correlation for this sample window
       if (m_autoCorrelation)
         {
-          itpp::cvec window = input(start, end);
-          itpp::vec normalized = norminput(start+16, end);
-          value = ComputeAutoCorrelation (window, normalized, scanWindowSize);
+          // Upper branch: sum of x(j) * conj (x(j-16)), lower branch: sum of |x(j)|^2, both for j in [start+16, start+47]
+          if (start % 32 == 0)
+            {
+              product = 0;
+              energy = 0;
+              for (int32_t j = start + 16; j < start + 48; j++)
+                {
+                  product += x[j] * conj (x[j - 16]);
+                  energy += norm (x[j]);
+                }
+            }
+          else
+            {
+              int32_t in = start + 47;
+              int32_t out = start + 15;
+              product += x[in] * conj (x[in - 16]) - x[out] * conj (x[out - 16]);
+              energy += norm (x[in]) - norm (x[out]);
+            }
+          value = std::abs (product) / energy;
         }
       else
         {
-          itpp::cvec window = input(start, end);
-          itpp::vec normalized = norminput(start, end);
-          value = ComputeCorrelation (window, normalized, scanWindowSize);
+          energy = SlideEnergy (x, start, scanWindowSize, energy);
+          value = CorrelateWithReference (x + start, scanWindowSize, energy);
         }
 
       NS_LOG_DEBUG ("PhySimSignalDetector:ScanForShortTrainingSymbols() --> correlation(" << start << ") = " << value);
 
       // Save correlation value for possible later usage
-      correlations.push_back (value);
+      if (record)
+        {
+          correlations.push_back (value);
+        }
 
       // Update begin variable in case the threshold is exceeded for the first time
       if (value >= m_corrThresh)
@@ -178,16 +234,24 @@ PhySimSignalDetector::ScanForShortTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, co
             }
         }
 
-      start++;
-      end++;
+      // In early exit mode, there is no need to evaluate the rest of the input
+      if (m_earlyExit && begin >= 0 && (uint32_t) (start - begin) >= m_earlyExitSamples)
+        {
+          NS_LOG_DEBUG ("PhySimSignalDetector:ScanForShortTrainingSymbols() early exit at " << start);
+          break;
+        }
+    }
+  if (record)
+    {
+      tag->SetShortTrainingSymbolCorrelations (correlations);
+      m_shortSymbolCorrelationsTrace (tag, correlations);
     }
-  tag->SetShortTrainingSymbolCorrelations (correlations);
 
   return begin;
 }
 
 int32_t
-PhySimSignalDetector::ScanForLongTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, const itpp::cvec &input)
+PhySimSignalDetector::ScanForLongTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, const itpp::cvec &input, int32_t first, int32_t last)
 {
   NS_LOG_FUNCTION (tag);
   // The input should be at least 64 samples long for proper detection of long training symbols
@@ -200,33 +264,32 @@ PhySimSignalDetector::ScanForLongTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, con
   double maxSeenFirst = 0;
   double maxSeenSecond = 0;
 
-  itpp::vec norminput (input.size ());
-  for (int32_t i = 0; i < input.size (); i++)
-    {
-      norminput(i) = std::norm (input(i));
-    }
+  NS_ASSERT (first >= 0 && last <= input.size () - 64);
 
-  // collect correlation values for the TraceSource 'm_longSymbolsTrace'
-  std::vector<double> correlations;
+  const std::complex<double> *x = input._data ();
 
-  int32_t start = 0;
-  int32_t end = start + 63;
-
-  while ( (start <= input.size () - 64) && (end < input.size ()) )
+  // collect correlation values for the TraceSource 'm_longSymbolCorrelationsTrace'
+  bool record = !m_earlyExit || !m_longSymbolCorrelationsTrace.IsEmpty ();
+  std::vector<double> correlations;
+  if (record)
     {
+      correlations.reserve (last - first + 1);
+    }
 
-      NS_LOG_DEBUG ("PhySimSignalDetector:ScanForLongTrainingSymbols() start = " << start);
-      NS_LOG_DEBUG ("PhySimSignalDetector:ScanForLongTrainingSymbols() end = " << end);
-
-      // Calculate correlation
-      itpp::cvec window = input (start, end);
-      itpp::vec normalized = norminput (start, end);
-      value = ComputeCorrelation (window, normalized, 64);
+  double energy = 0;
+  for (int32_t start = first; start <= last; start++)
+    {
+      // Calculate correlation, the first window of a bounded scan has to be computed from scratch
+      energy = SlideEnergy (x, start, 64, energy, start == first);
+      value = CorrelateWithReference (x + start, 64, energy);
 
       NS_LOG_DEBUG ("PhySimSignalDetector:ScanForLongTrainingSymbols() --> correlation(" << start << ") = " << value);
 
       // Save correlation value for possible later usage
-      correlations.push_back (value);
+      if (record)
+        {
+          correlations.push_back (value);
+        }
 
       if (value > maxSeenFirst)
         { // new global maximum
@@ -240,13 +303,13 @@ PhySimSignalDetector::ScanForLongTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, con
           maxSeenSecond = value;
           maxPosSecond = start;
         }
-
-      // Update counters
-      start++;
-      end++;
     }
 
-  tag->SetLongTrainingSymbolCorrelations (correlations);
+  if (record)
+    {
+      tag->SetLongTrainingSymbolCorrelations (correlations);
+      m_longSymbolCorrelationsTrace (tag, correlations);
+    }
 
   // TODO: There is probably some checks to be done w.r.t. the distance between the two peaks but for now this will do
   if (maxSeenFirst == -1)
@@ -262,41 +325,32 @@ PhySimSignalDetector::ScanForLongTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, con
 }
 
 /*!
- * \brief Returns correlation for a given input using method 1 (auto-correlation).
- *
+ * \brief Returns the energy of the window [start, start+window-1], given the energy of the window one sample earlier.
+ * Every window-th position, or if requested, the energy is recomputed from scratch.
  */
-double PhySimSignalDetector::ComputeAutoCorrelation (const itpp::cvec& input, const itpp::vec& norminput, const int32_t window)
+double
+PhySimSignalDetector::SlideEnergy (const std::complex<double> *input, int32_t start, int32_t window, double energy, bool restart) const
 {
-  double L = 32;
-  std::complex<double> sum = 0; // The moving sum
-
-  // Calculate upper branch: C_n
-  uint32_t N = input.size() - 1;
-  for (int32_t k = 0; k < L; ++k)
+  if (restart || start % window == 0)
     {
-      sum += ( input(N-k) * conj( input(N-k-16) ) );
-    }
-
-  // Calculate lower branch
-  double sumConj = 0;
-  for (int32_t i = 0; i < norminput.size(); ++i)
-    {
-      sumConj += norminput (i);
+      energy = 0;
+      for (int32_t i = start; i < start + window; i++)
+        {
+          energy += norm (input[i]);
+        }
+      return energy;
     }
-
-  // Now divide the two to come up with a correlation
-  return std::abs (sum) / sumConj;
+  return energy + norm (input[start + window - 1]) - norm (input[start - 1]);
 }
 
 /*!
  * \brief Returns correlation for a given input using method 2 (expected values).
- * Note that for this method the input must be 16 or 64 samples long
+ * Note that for this method the window must be 16 or 64 samples long
  * which means short and long training sequences respectively.
  */
-double PhySimSignalDetector::ComputeCorrelation (const itpp::cvec& input, const itpp::vec& norminput, const int32_t window)
+double
+PhySimSignalDetector::CorrelateWithReference (const std::complex<double> *input, int32_t window, double energy) const
 {
-  NS_ASSERT ( input.size () == window );
-
   const itpp::cvec* refSymbols;
 
   if (window == 16)
@@ -325,28 +379,12 @@ double PhySimSignalDetector::ComputeCorrelation (const itpp::cvec& input, const
     }
   else
     {
-      NS_LOG_DEBUG ("PhySimSignalDetector:ComputeCorrelation() wrong window size");
+      NS_LOG_DEBUG ("PhySimSignalDetector:CorrelateWithReference() wrong window size");
       return 0;
     }
 
-  std::complex<double> sum = 0; // the moving sum
-  double sumConj = 0;
-
-  for (int32_t i = 0; i < window; i++)
-    {
-      sumConj += norminput (i);
-    }
-
-  double normFactor = sqrt (sumConj);
-  for (int32_t k = 0; k < window; k++)
-    {
-      sum += input (k) * (*refSymbols)(k); // itpp::conj(refSymbols(k));
-    }
-
-  NS_LOG_DEBUG ("PhySimSignalDetector:ComputeCorrelation() --> sumConj = " << sumConj);
-  NS_LOG_DEBUG ("PhySimSignalDetector:ComputeCorrelation() --> sum = " << sum);
-
-  sum *= normFactor; // apply normalization
-  return abs (sum) / sumConj;
+  std::complex<double> sum = PhySimHelper::ComplexMac (input, refSymbols->_data (), window);
+  sum *= sqrt (energy); // apply normalization
+  return abs (sum) / energy;
 }
 } // namespace ns3
@@ -72,18 +72,45 @@ private:
   virtual int32_t ScanForShortTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, const itpp::cvec &input);
   /**
    * Scans for the repeating pattern of the long training symbols in the given time sample vector and stores the
-   * results into the provided PhySimWifiPhyTag object
+   * results into the provided PhySimWifiPhyTag object. Only windows starting at the sample positions first to last
+   * (inclusive) are evaluated.
    *
    * \return The index where the start of the long training symbols is assumed
    */
-  virtual int32_t ScanForLongTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, const itpp::cvec &input);
+  virtual int32_t ScanForLongTrainingSymbols (Ptr<PhySimWifiPhyTag> tag, const itpp::cvec &input, int32_t first, int32_t last);
 
-  virtual double ComputeAutoCorrelation (const itpp::cvec& input, const itpp::vec& norminput, const int32_t window);
-  virtual double ComputeCorrelation (const itpp::cvec& input, const itpp::vec& norminput, const int32_t window);
+  /**
+   * Returns the energy (sum of |x|^2) of the sliding window that starts at the given position, by updating the
+   * energy of the window that started one sample earlier
+   *
+   * \param input  The complex time samples
+   * \param start  The first sample of the window
+   * \param window The length of the window
+   * \param energy The energy of the window starting at start - 1
+   * \param restart Whether to compute the energy from scratch, e.g. for the first window of a scan
+   * \return       The energy of the window starting at start
+   */
+  double SlideEnergy (const std::complex<double> *input, int32_t start, int32_t window, double energy, bool restart = false) const;
+  /**
+   * Correlates the given window of time samples against the known short (window of 16) or long (window of 64)
+   * training symbol and normalizes the result by the energy of the window
+   *
+   * \param input  Pointer to the first sample of the window
+   * \param window The length of the window, either 16 or 64
+   * \param energy The energy of the window, as returned by SlideEnergy
+   * \return       The normalized correlation
+   */
+  double CorrelateWithReference (const std::complex<double> *input, int32_t window, double energy) const;
 
   double m_corrThresh;
   bool m_autoCorrelation;
   bool m_ieeeCompliantMode;
+  bool m_earlyExit;
+  uint32_t m_earlyExitSamples;
+  uint32_t m_longSymbolSearchMargin;
+
+  TracedCallback<Ptr<const PhySimWifiPhyTag>, std::vector<double> > m_shortSymbolCorrelationsTrace;
+  TracedCallback<Ptr<const PhySimWifiPhyTag>, std::vector<double> > m_longSymbolCorrelationsTrace;
 };
 
 } // namespace ns3
@@ -0,0 +1,233 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "physim-soft-demapper.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE ("PhySimSoftDemapper");
+
+namespace ns3 {
+
+template <uint32_t M>
+PhySimMaxLogDemapper<M>::PhySimMaxLogDemapper ()
+  : m_initialised (false),
+    m_valid (false),
+    m_rotation (1.0, 0.0),
+    m_invStep (0.0)
+{
+}
+
+template <uint32_t M>
+bool
+PhySimMaxLogDemapper<M>::Initialise (const itpp::Modulator<std::complex<double> > &modulator)
+{
+  if (!m_initialised)
+    {
+      m_initialised = true;
+      itpp::cvec symbols = modulator.get_symbols ();
+      itpp::ivec bits2symbols = modulator.get_bits2symbols ();
+      m_valid = TryInitialise (symbols, bits2symbols, std::complex<double> (1.0, 0.0))
+        || TryInitialise (symbols, bits2symbols, std::polar (1.0, M_PI / 4));
+      if (!m_valid)
+        {
+          NS_LOG_WARN ("PhySimMaxLogDemapper:Initialise() - constellation with " << M << " points is not separable per axis");
+        }
+    }
+  return m_valid;
+}
+
+template <uint32_t M>
+bool
+PhySimMaxLogDemapper<M>::TryInitialise (const itpp::cvec &symbols, const itpp::ivec &bits2symbols, std::complex<double> rotation)
+{
+  if (symbols.size () != M || bits2symbols.size () != M)
+    {
+      return false;
+    }
+  const uint32_t numAxes = (M == 2) ? 1 : 2;
+
+  // The levels on each axis have to be the odd multiples of step, i.e. -(NLEVELS - 1) * step ... (NLEVELS - 1) * step
+  double maximum = 0;
+  for (uint32_t j = 0; j < M; j++)
+    {
+      maximum = std::max (maximum, std::fabs ((symbols (j) * rotation).real ()));
+    }
+  double step = maximum / (NLEVELS - 1);
+  if (step <= 0)
+    {
+      return false;
+    }
+
+  // Level index on each axis and bit label of every constellation point
+  uint32_t levels[M][2];
+  uint32_t labels[M];
+  for (uint32_t p = 0; p < M; p++)
+    {
+      labels[bits2symbols (p)] = p;
+    }
+  for (uint32_t j = 0; j < M; j++)
+    {
+      std::complex<double> point = symbols (j) * rotation;
+      double coordinates[2] = { point.real (), point.imag () };
+      if (M == 2 && std::fabs (coordinates[1]) > 1e-6 * step)
+        {
+          return false;
+        }
+      for (uint32_t a = 0; a < numAxes; a++)
+        {
+          double index = (coordinates[a] / step + NLEVELS - 1) / 2;
+          int32_t level = (int32_t) floor (index + 0.5);
+          if (level < 0 || level >= (int32_t) NLEVELS || std::fabs (index - level) > 1e-6)
+            {
+              return false;
+            }
+          levels[j][a] = level;
+        }
+    }
+
+  for (uint32_t i = 0; i < NBITS; i++)
+    {
+      // Find the axis that determines the bit, i.e. the bit value is a function of the level on this axis
+      int32_t bitOfLevel[NLEVELS];
+      bool found = false;
+      for (uint32_t a = 0; a < numAxes && !found; a++)
+        {
+          found = true;
+          for (uint32_t m = 0; m < NLEVELS; m++)
+            {
+              bitOfLevel[m] = -1;
+            }
+          for (uint32_t j = 0; j < M && found; j++)
+            {
+              int32_t bit = (labels[j] >> (NBITS - 1 - i)) & 1; // the first bit is the MSB of the label
+              int32_t &expected = bitOfLevel[levels[j][a]];
+              found = (expected == -1 || expected == bit);
+              expected = bit;
+            }
+          m_axis[i] = a;
+        }
+      if (!found)
+        {
+          return false;
+        }
+
+      // For each region [(r - NLEVELS) * step, (r - NLEVELS + 1) * step) the closest levels with bit 0 and 1 are fixed
+      for (uint32_t r = 0; r < NREGIONS; r++)
+        {
+          double x = (r - (double) NLEVELS + 0.5) * step;
+          double best[2] = { std::numeric_limits<double>::max (), std::numeric_limits<double>::max () };
+          double closest[2] = { 0, 0 };
+          for (uint32_t m = 0; m < NLEVELS; m++)
+            {
+              double level = (2.0 * m + 1 - NLEVELS) * step;
+              int32_t bit = bitOfLevel[m];
+              if (bit >= 0 && std::fabs (x - level) < best[bit])
+                {
+                  best[bit] = std::fabs (x - level);
+                  closest[bit] = level;
+                }
+            }
+          if (best[0] == std::numeric_limits<double>::max () || best[1] == std::numeric_limits<double>::max ())
+            {
+              return false;
+            }
+          // (x - a1)^2 - (x - a0)^2 = 2 (a0 - a1) x - (a0 - a1) (a0 + a1)
+          m_slope[i][r] = 2 * (closest[0] - closest[1]);
+          m_offset[i][r] = -(closest[0] - closest[1]) * (closest[0] + closest[1]);
+        }
+    }
+
+  m_rotation = rotation;
+  m_invStep = 1.0 / step;
+  return true;
+}
+
+template <uint32_t M>
+void
+PhySimMaxLogDemapper<M>::DemodulateSymbol (std::complex<double> symbol, double invN0, double *llrs) const
+{
+  std::complex<double> point = symbol * m_rotation;
+  double coordinates[2] = { point.real (), point.imag () };
+  for (uint32_t i = 0; i < NBITS; i++)
+    {
+      double x = coordinates[m_axis[i]];
+      int32_t region = (int32_t) floor (x * m_invStep) + (int32_t) NLEVELS;
+      region = std::min (std::max (region, 0), (int32_t) NREGIONS - 1);
+      llrs[i] = (m_slope[i][region] * x + m_offset[i][region]) * invN0;
+    }
+}
+
+template <uint32_t M>
+void
+PhySimMaxLogDemapper<M>::Demodulate (const std::complex<double> *input, uint32_t numSymbols, double N0, double *output) const
+{
+  NS_ASSERT (m_valid);
+  double invN0 = 1.0 / N0;
+  for (uint32_t j = 0; j < numSymbols; j++)
+    {
+      DemodulateSymbol (input[j], invN0, output + j * NBITS);
+    }
+}
+
+template <uint32_t M>
+void
+PhySimMaxLogDemapper<M>::Demodulate (const std::complex<double> *input, uint32_t numSymbols, double N0, double *output,
+                                     const uint16_t *positions, uint32_t blockSymbols) const
+{
+  NS_ASSERT (m_valid);
+  NS_ASSERT (numSymbols % blockSymbols == 0);
+  double invN0 = 1.0 / N0;
+  double llrs[NBITS];
+  for (uint32_t block = 0; block < numSymbols; block += blockSymbols)
+    {
+      double *blockOutput = output + block * NBITS;
+      for (uint32_t j = 0; j < blockSymbols; j++)
+        {
+          DemodulateSymbol (input[block + j], invN0, llrs);
+          const uint16_t *targets = positions + j * NBITS;
+          for (uint32_t i = 0; i < NBITS; i++)
+            {
+              blockOutput[targets[i]] = llrs[i];
+            }
+        }
+    }
+}
+
+template <uint32_t M>
+itpp::vec
+PhySimMaxLogDemapper<M>::Demodulate (const itpp::cvec &input, double N0) const
+{
+  itpp::vec output (NBITS * input.size ());
+  Demodulate (input._data (), input.size (), N0, output._data ());
+  return output;
+}
+
+template class PhySimMaxLogDemapper<2>;
+template class PhySimMaxLogDemapper<4>;
+template class PhySimMaxLogDemapper<16>;
+template class PhySimMaxLogDemapper<64>;
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#ifndef PHYSIM_SOFT_DEMAPPER_H
+#define PHYSIM_SOFT_DEMAPPER_H
+
+#include <itpp/itcomm.h>
+#include <complex>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief Max-log soft demapper for Gray-mapped BPSK, QPSK, 16-QAM and 64-QAM constellations (M = 2, 4, 16, 64).
+ *
+ * For a square constellation with Gray mapping, every bit depends on only one axis, and the max-log LLR of a bit
+ * is a linear function of the coordinate on that axis within each interval between two multiples of half the
+ * level spacing. The demapper therefore computes each LLR with one table lookup and one multiply-add, instead of
+ * evaluating the distances to all constellation points as itpp::Modulator::demodulate_soft_bits does.
+ *
+ * The tables are derived from the IT++ modulator, so the output follows the IT++ conventions: positive values
+ * represent a 0-bit, and the result equals demodulate_soft_bits with the itpp::APPROX method. If the constellation
+ * of the modulator is not separable per axis (also after a rotation by pi/4, as used by itpp::QPSK),
+ * Initialise returns false.
+ */
+template <uint32_t M>
+class PhySimMaxLogDemapper
+{
+public:
+  static const uint32_t NBITS = (M == 2) ? 1 : (M == 4) ? 2 : (M == 16) ? 4 : 6;
+  static const uint32_t NLEVELS = (M == 2 || M == 4) ? 2 : (M == 16) ? 4 : 8;
+  static const uint32_t NREGIONS = 2 * NLEVELS;
+
+  PhySimMaxLogDemapper ();
+
+  /**
+   * Derives the per-axis tables from the constellation of the given modulator. Only the first call has an effect.
+   * \param modulator The IT++ modulator whose output shall be demapped
+   * \return          Whether the constellation is supported by the demapper
+   */
+  bool Initialise (const itpp::Modulator<std::complex<double> > &modulator);
+  /**
+   * Computes the max-log LLRs of the given received symbols
+   * \param input      The received symbols
+   * \param numSymbols The number of symbols
+   * \param N0         The spectral noise density
+   * \param output     Buffer of NBITS * numSymbols values
+   */
+  void Demodulate (const std::complex<double> *input, uint32_t numSymbols, double N0, double *output) const;
+  itpp::vec Demodulate (const itpp::cvec &input, double N0) const;
+  /**
+   * Computes the max-log LLRs of the given received symbols and writes them directly to permuted positions, e.g. to
+   * deinterleave them without an intermediate vector. The input is split into blocks of blockSymbols symbols, and
+   * the LLR k of a block is written to position positions[k] of the same block.
+   * \param input        The received symbols
+   * \param numSymbols   The number of symbols, a multiple of blockSymbols
+   * \param N0           The spectral noise density
+   * \param output       Buffer of NBITS * numSymbols values
+   * \param positions    Target position of each of the NBITS * blockSymbols LLRs of a block
+   * \param blockSymbols The number of symbols per block
+   */
+  void Demodulate (const std::complex<double> *input, uint32_t numSymbols, double N0, double *output,
+                   const uint16_t *positions, uint32_t blockSymbols) const;
+
+private:
+  void DemodulateSymbol (std::complex<double> symbol, double invN0, double *llrs) const;
+  bool TryInitialise (const itpp::cvec &symbols, const itpp::ivec &bits2symbols, std::complex<double> rotation);
+
+  bool m_initialised;
+  bool m_valid;
+  std::complex<double> m_rotation;
+  double m_invStep;
+  uint8_t m_axis[NBITS];
+  double m_slope[NBITS][NREGIONS];
+  double m_offset[NBITS][NREGIONS];
+};
+
+} // namespace ns3
+
+#endif /* PHYSIM_SOFT_DEMAPPER_H */
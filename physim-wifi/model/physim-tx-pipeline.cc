@@ -0,0 +1,150 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "physim-tx-pipeline.h"
+#include "physim-scrambler.h"
+#include "physim-helper.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("PhySimTxPipeline");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (PhySimTxPipeline);
+
+TypeId
+PhySimTxPipeline::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PhySimTxPipeline")
+    .SetParent<Object> ()
+    .AddConstructor<PhySimTxPipeline> ()
+  ;
+  return tid;
+}
+
+PhySimTxPipeline::PhySimTxPipeline ()
+  : m_NCBPS (0)
+{
+}
+
+PhySimTxPipeline::~PhySimTxPipeline ()
+{
+}
+
+void
+PhySimTxPipeline::SetComponents (Ptr<PhySimConvolutionalEncoder> encoder, Ptr<PhySimBlockInterleaver> interleaver,
+                                 Ptr<PhySimOFDMSymbolCreator> symbolCreator)
+{
+  m_encoder = encoder;
+  m_interleaver = interleaver;
+  m_symbolCreator = symbolCreator;
+}
+
+itpp::cvec
+PhySimTxPipeline::ConstructData (const PhySimPackedBits &psdu, const WifiMode mode, const itpp::bvec &scramblerState)
+{
+  NS_ASSERT (m_encoder && m_interleaver && m_symbolCreator);
+
+  // Calculate no. of symbols needed, see PhySimWifiPhy::ConstructData ()
+  uint32_t NDBPS = PhySimHelper::GetNDBPS (mode);
+  uint32_t NSYM = (16 + psdu.GetNBits () + 6 + NDBPS - 1) / NDBPS; // 17-11
+  uint32_t NDATA = NSYM * NDBPS; // 17-12 - length of data field
+  m_NCBPS = PhySimHelper::GetNCBPS (mode);
+
+  m_encoder->SetCodingRate (mode.GetCodeRate ());
+  m_interleaver->SetWifiMode (mode);
+  m_symbolCreator->SetModulationType (PhySimHelper::GetModulationType (mode), mode.GetConstellationSize ());
+  m_coded.set_size (m_NCBPS + 16, false);
+  m_interleaved.set_size (m_NCBPS, false);
+
+  NS_LOG_DEBUG ("PhySimTxPipeline:ConstructData() - " << psdu.GetNBits () << " bits in " << NSYM << " OFDM symbols");
+
+  // The output for all symbols, with one additional sample overlapping with the next symbol
+  itpp::cvec output (NSYM * 80 + 1);
+  std::complex<double> *samples = output._data ();
+
+  const uint8_t *sequence = PhySimScrambler::GetSequence (scramblerState);
+  const uint8_t *psduBytes = psdu.GetBytes ();
+  uint32_t psduBytesEnd = 2 + psdu.GetNBytes ();
+  uint32_t tailStart = 16 + psdu.GetNBits ();
+  uint32_t state = 0;
+  uint32_t phase = 0;
+  uint32_t numCoded = 0;
+  uint32_t symbol = 0;
+  itpp::bin *coded = m_coded._data ();
+  for (uint32_t i = 0; 8 * i < NDATA; i++)
+    {
+      // SERVICE field (2 bytes of zeros), PSDU, tail and pad bits (zeros), 17.3.5.4 scrambled
+      uint8_t byte = (i >= 2 && i < psduBytesEnd) ? psduBytes[i - 2] : 0;
+      byte ^= sequence[i % 127];
+
+      // 17.3.2.1 (f) After scrambling we have to reset the tail bits to 0
+      if (8 * i + 8 > tailStart && 8 * i < tailStart + 6)
+        {
+          for (uint32_t bit = 0; bit < 8; bit++)
+            {
+              if (8 * i + bit >= tailStart && 8 * i + bit < tailStart + 6)
+                {
+                  byte &= ~(1 << bit);
+                }
+            }
+        }
+
+      // 17.3.5.5 Do convolutional encoding, the last byte may be incomplete
+      uint32_t numBits = std::min (NDATA - 8 * i, (uint32_t) 8);
+      byte &= (1 << numBits) - 1;
+      numCoded += m_encoder->EncodeByte (byte, numBits, state, phase, coded + numCoded);
+
+      // 17.3.5.6 - 17.3.5.9 Interleave and modulate each OFDM symbol as soon as its coded bits are complete
+      if (numCoded >= m_NCBPS)
+        {
+          ModulateSymbol (symbol++, samples);
+          numCoded -= m_NCBPS;
+          std::copy (coded + m_NCBPS, coded + m_NCBPS + numCoded, coded);
+        }
+    }
+  NS_ASSERT (symbol == NSYM && numCoded == 0);
+
+  samples[NSYM * 80] = 0.5 * samples[(NSYM - 1) * 80 + 16];
+  return output;
+}
+
+void
+PhySimTxPipeline::ModulateSymbol (uint32_t symbol, std::complex<double> *samples)
+{
+  m_interleaver->InterleaveBlock (m_coded._data (), m_interleaved._data ());
+  m_symbolCreator->ModulateSymbols (m_interleaved, symbol + 1, samples + symbol * 80);
+
+  // Windowing function (17-5), where consecutive symbols overlap by one sample
+  if (symbol == 0)
+    {
+      samples[0] *= 0.5;
+    }
+  else
+    {
+      samples[symbol * 80] = 0.5 * samples[(symbol - 1) * 80 + 16] + 0.5 * samples[symbol * 80];
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,88 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#ifndef PHYSIM_TX_PIPELINE_H
+#define PHYSIM_TX_PIPELINE_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/wifi-mode.h"
+#include "physim-packed-bits.h"
+#include "physim-convolutional-encoder.h"
+#include "physim-blockinterleaver.h"
+#include "physim-ofdm-symbolcreator.h"
+#include <itpp/itcomm.h>
+
+namespace ns3 {
+
+/**
+ * \brief Streaming construction of the DATA field of a frame (17.3.5.3 - 17.3.5.9).
+ *
+ * Instead of scrambling, encoding and interleaving/modulating the whole frame in separate passes, each of which
+ * returns a new bit vector, the pipeline scrambles and encodes the frame byte by byte. As soon as the coded bits
+ * of one OFDM symbol are complete, they are interleaved, mapped and transformed by the IFFT into the output buffer,
+ * which is allocated once for all NSYM symbols. The working set per symbol is a few hundred bytes, i.e. it stays
+ * in the L1 cache. Scrambling, encoding and interleaving use the precomputed tables of PhySimScrambler,
+ * PhySimConvolutionalEncoder and PhySimBlockInterleaver, so the result is identical to the frame-wise chain.
+ */
+class PhySimTxPipeline : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  PhySimTxPipeline ();
+  virtual ~PhySimTxPipeline ();
+
+  /**
+   * Sets the components whose tables and settings (e.g. the IEEE compliant mode of the symbol creator) are used
+   */
+  void SetComponents (Ptr<PhySimConvolutionalEncoder> encoder, Ptr<PhySimBlockInterleaver> interleaver,
+                      Ptr<PhySimOFDMSymbolCreator> symbolCreator);
+  /**
+   * Constructs the time samples of the DATA field, i.e. SERVICE field, PSDU, tail and pad bits
+   * \param psdu           The bits of the PSDU
+   * \param mode           The WiFi mode of the frame
+   * \param scramblerState The initial state of the scrambler (7 bits)
+   * \return               The windowed time samples of all NSYM OFDM symbols, plus the sample that overlaps with
+   *                       the following symbol (NSYM * 80 + 1 samples)
+   */
+  itpp::cvec ConstructData (const PhySimPackedBits &psdu, const WifiMode mode, const itpp::bvec &scramblerState);
+
+private:
+  /**
+   * Interleaves, maps and transforms the first NCBPS bits of the coded bit buffer into the given OFDM symbol
+   * of the output, and applies the window function towards the previous symbol
+   */
+  void ModulateSymbol (uint32_t symbol, std::complex<double> *samples);
+
+  Ptr<PhySimConvolutionalEncoder> m_encoder;
+  Ptr<PhySimBlockInterleaver> m_interleaver;
+  Ptr<PhySimOFDMSymbolCreator> m_symbolCreator;
+
+  uint32_t m_NCBPS;
+  itpp::bvec m_coded;           // Coded bits that are not yet interleaved, at most NCBPS + 16
+  itpp::bvec m_interleaved;     // Interleaved bits of the current OFDM symbol
+};
+
+} // namespace ns3
+
+#endif /* PHYSIM_TX_PIPELINE_H */
@@ -0,0 +1,310 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "physim-viterbi-decoder.h"
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE ("PhySimViterbiDecoder");
+
+namespace ns3 {
+
+static uint32_t
+Parity (uint32_t value)
+{
+  uint32_t parity = 0;
+  while (value)
+    {
+      parity ^= value & 1;
+      value >>= 1;
+    }
+  return parity;
+}
+
+PhySimViterbiDecoder::PhySimViterbiDecoder ()
+{
+  // The encoder register is (s << 1) | x when entering state s from the predecessor with lowest bit x,
+  // where bit 6 holds the current input bit (17.3.5.5)
+  const uint32_t g0 = 0133;
+  const uint32_t g1 = 0171;
+  for (uint32_t s = 0; s < NUM_STATES; s++)
+    {
+      for (uint32_t x = 0; x < 2; x++)
+        {
+          uint32_t reg = (s << 1) | x;
+          m_codewords[s][x] = (Parity (reg & g0) << 1) | Parity (reg & g1);
+        }
+    }
+  SetCodingRate (WIFI_CODE_RATE_1_2);
+  SetTracebackDepth (0);
+}
+
+void
+PhySimViterbiDecoder::SetCodingRate (enum WifiCodeRate rate)
+{
+  // Same puncturing matrices as in PhySimConvolutionalEncoder::SetCodingRate (rows: outputs, columns: time)
+  switch (rate)
+    {
+    case WIFI_CODE_RATE_2_3:
+      m_period = 2;
+      m_puncture[0][0] = true; m_puncture[0][1] = true;
+      m_puncture[1][0] = true; m_puncture[1][1] = false;
+      break;
+    case WIFI_CODE_RATE_3_4:
+      m_period = 3;
+      m_puncture[0][0] = true; m_puncture[0][1] = true; m_puncture[0][2] = false;
+      m_puncture[1][0] = true; m_puncture[1][1] = false; m_puncture[1][2] = true;
+      break;
+    case WIFI_CODE_RATE_1_2:
+    default:
+      m_period = 1;
+      m_puncture[0][0] = true;
+      m_puncture[1][0] = true;
+    }
+}
+
+void
+PhySimViterbiDecoder::SetTracebackDepth (uint32_t depth)
+{
+  NS_ASSERT_MSG (depth == 0 || depth >= MEMORY, "PhySimViterbiDecoder::SetTracebackDepth() - depth shorter than the tail");
+  m_tracebackDepth = depth;
+  // The ring buffer holds the traceback depth plus one block of bits to emit
+  m_decisions.clear ();
+  m_decisions.resize (2 * depth);
+}
+
+void
+PhySimViterbiDecoder::Depuncture (const itpp::vec &received)
+{
+  int32_t total = 0;
+  for (uint32_t p = 0; p < m_period; p++)
+    {
+      total += m_puncture[0][p] + m_puncture[1][p];
+    }
+
+  // Number of complete puncturing periods, plus the columns needed for the remaining values
+  int32_t size = received.size ();
+  int32_t remaining = size - (size / total) * total;
+  uint32_t length = (size / total) * m_period * 2;
+  uint32_t columns = 0;
+  while (remaining > 0)
+    {
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          if (m_puncture[j][columns])
+            {
+              remaining--;
+            }
+        }
+      columns++;
+    }
+  length += 2 * columns;
+
+  m_depunctured.resize (length);
+  int32_t i = 0;
+  uint32_t j = 0;
+  uint32_t p = 0;
+  for (uint32_t k = 0; k < length; k++)
+    {
+      if (m_puncture[j][p] && i < size)
+        {
+          m_depunctured[k] = received (i++);
+        }
+      else
+        {
+          m_depunctured[k] = 0;
+        }
+      if (++j == 2)
+        {
+          j = 0;
+          p = (p + 1) % m_period;
+        }
+    }
+}
+
+itpp::bvec
+PhySimViterbiDecoder::Decode (const itpp::vec &received, bool hard)
+{
+  Depuncture (received);
+  uint32_t blockLength = m_depunctured.size () / 2;
+  NS_ASSERT_MSG (blockLength > MEMORY, "PhySimViterbiDecoder::Decode() - input too short");
+
+  itpp::bvec output;
+  if (hard)
+    {
+      m_hardValues.resize (m_depunctured.size ());
+      for (uint32_t k = 0; k < m_depunctured.size (); k++)
+        {
+          NS_ASSERT (m_depunctured[k] == 1 || m_depunctured[k] == -1 || m_depunctured[k] == 0);
+          m_hardValues[k] = (int32_t) m_depunctured[k];
+        }
+      DecodeBlock<int32_t> (&m_hardValues[0], blockLength, output);
+    }
+  else
+    {
+      DecodeBlock<double> (&m_depunctured[0], blockLength, output);
+    }
+  return output;
+}
+
+template <typename T>
+void
+PhySimViterbiDecoder::DecodeBlock (const T *input, uint32_t blockLength, itpp::bvec &output)
+{
+  const T unreachable = std::numeric_limits<T>::max ();
+  T metrics[NUM_STATES];
+  T next[NUM_STATES];
+  T branch[4];
+  bool visited[NUM_STATES];
+  bool nextVisited[NUM_STATES];
+
+  // Without a traceback depth the decisions of the whole frame are kept
+  m_windowLength = m_tracebackDepth ? 2 * m_tracebackDepth : blockLength;
+  if (m_decisions.size () < m_windowLength)
+    {
+      m_decisions.resize (m_windowLength);
+    }
+  output.set_size (blockLength - MEMORY);
+  uint32_t emitted = 0;
+
+  for (uint32_t s = 0; s < NUM_STATES; s++)
+    {
+      metrics[s] = 0;
+      visited[s] = false;
+    }
+  visited[0] = true; // the encoder starts in the zero state
+  for (uint32_t s = 0; s < NUM_STATES; s++)
+    {
+      nextVisited[s] = visited[s];
+    }
+
+  for (uint32_t l = 0; l < blockLength; l++)
+    {
+      // Branch metrics of the four code words, a positive value votes for a 0-bit
+      T r0 = input[2 * l];
+      T r1 = input[2 * l + 1];
+      branch[0] = -r0 - r1;
+      branch[1] = -r0 + r1;
+      branch[2] = r0 - r1;
+      branch[3] = r0 + r1;
+
+      uint64_t decisions = 0;
+      if (l < MEMORY)
+        {
+          // Not all states are reachable yet
+          for (uint32_t s = 0; s < NUM_STATES; s++)
+            {
+              uint32_t s0 = (s << 1) & (NUM_STATES - 1);
+              uint32_t s1 = s0 | 1;
+              T zero = unreachable;
+              T one = unreachable;
+              if (visited[s0])
+                {
+                  zero = metrics[s0] + branch[m_codewords[s][0]];
+                  nextVisited[s] = true;
+                }
+              if (visited[s1])
+                {
+                  one = metrics[s1] + branch[m_codewords[s][1]];
+                  nextVisited[s] = true;
+                }
+              if (zero < one)
+                {
+                  next[s] = zero;
+                }
+              else
+                {
+                  next[s] = one;
+                  decisions |= (uint64_t) 1 << s;
+                }
+            }
+          for (uint32_t s = 0; s < NUM_STATES; s++)
+            {
+              visited[s] = nextVisited[s];
+            }
+        }
+      else
+        {
+          // Butterflies: states k and k + 32 share the predecessors 2k and 2k + 1
+          const uint32_t half = NUM_STATES / 2;
+          uint8_t survivor[NUM_STATES];
+          for (uint32_t k = 0; k < half; k++)
+            {
+              T m0 = metrics[2 * k];
+              T m1 = metrics[2 * k + 1];
+              T zeroLow = m0 + branch[m_codewords[k][0]];
+              T oneLow = m1 + branch[m_codewords[k][1]];
+              T zeroHigh = m0 + branch[m_codewords[k + half][0]];
+              T oneHigh = m1 + branch[m_codewords[k + half][1]];
+              survivor[k] = !(zeroLow < oneLow);
+              survivor[k + half] = !(zeroHigh < oneHigh);
+              next[k] = survivor[k] ? oneLow : zeroLow;
+              next[k + half] = survivor[k + half] ? oneHigh : zeroHigh;
+            }
+          for (uint32_t s = 0; s < NUM_STATES; s++)
+            {
+              decisions |= (uint64_t) survivor[s] << s;
+            }
+        }
+      m_decisions[l % m_windowLength] = decisions;
+      for (uint32_t s = 0; s < NUM_STATES; s++)
+        {
+          metrics[s] = next[s];
+        }
+
+      if (m_tracebackDepth && l + 1 - emitted == m_windowLength)
+        {
+          // The ring buffer is full: trace back from the best state and emit the oldest block
+          uint32_t best = 0;
+          for (uint32_t s = 1; s < NUM_STATES; s++)
+            {
+              if (metrics[s] < metrics[best])
+                {
+                  best = s;
+                }
+            }
+          Traceback (best, l, emitted, emitted + m_tracebackDepth, output);
+          emitted += m_tracebackDepth;
+        }
+    }
+
+  // The tail terminates the trellis in the zero state, so the remaining bits are traced back from there
+  Traceback (0, blockLength - 1, emitted, blockLength - MEMORY, output);
+}
+
+uint32_t
+PhySimViterbiDecoder::Traceback (uint32_t state, int32_t from, int32_t to, int32_t emitLimit, itpp::bvec &output) const
+{
+  // The input bit of a step is the highest bit of the state it leads to
+  for (int32_t l = from; l >= to; l--)
+    {
+      if (l < emitLimit)
+        {
+          output (l) = (state >> (MEMORY - 1)) & 1;
+        }
+      state = ((state << 1) & (NUM_STATES - 1)) | ((m_decisions[l % m_windowLength] >> state) & 1);
+    }
+  return state;
+}
+
+} // namespace ns3
@@ -0,0 +1,104 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Jens Mittag <jens.mittag@kit.edu>
+ * Stylianos Papanastasiou <stylianos@gmail.com>
+ *
+ */
+
+#ifndef PHYSIM_VITERBI_DECODER_H
+#define PHYSIM_VITERBI_DECODER_H
+
+#include "ns3/wifi-mode.h"
+#include <itpp/itcomm.h>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Viterbi decoder dedicated to the IEEE 802.11 convolutional code (K = 7, generators 0133 and 0171).
+ *
+ * The decoder expects the same input as itpp::Punctured_Convolutional_Code::decode in tail mode, i.e. punctured
+ * soft values where positive values represent a 0-bit, followed by the (zero) soft values of the 6 tail bits.
+ * Depuncturing, branch metrics and the add-compare-select tie-breaking follow the IT++ implementation. Hard decisions (values of +1, -1 or 0) are decoded
+ * with integer path metrics, soft values with double precision path metrics.
+ *
+ * The add-compare-select step is written as 32 butterflies over plain arrays, without architecture-specific
+ * intrinsics. Survivor decisions are packed into one 64-bit word per trellis step and kept in a ring buffer of
+ * traceback depth plus block length steps. Whenever the buffer is full, the decoder traces back from the state with
+ * the best path metric through the traceback depth and emits the oldest block of decoded bits, so the memory needed
+ * does not depend on the frame length. Only the bits at the end of the frame are traced back from the zero state
+ * reached by the tail. With a window, the result may differ from IT++ if the survivor paths have not merged within
+ * the traceback depth, which gets more likely for the punctured rates. The default traceback depth of 0 keeps the
+ * decisions of the whole frame and traces back once from the zero state, so the decoded bits are identical to IT++.
+ */
+class PhySimViterbiDecoder
+{
+public:
+  PhySimViterbiDecoder ();
+
+  /**
+   * Sets the puncturing pattern of the given coding rate (1/2, 2/3 or 3/4)
+   */
+  void SetCodingRate (enum WifiCodeRate rate);
+  /**
+   * Sets the traceback depth of the sliding window, which is also the number of bits emitted per traceback.
+   * \param depth The traceback depth in trellis steps, or 0 to trace back the whole frame at once
+   */
+  void SetTracebackDepth (uint32_t depth);
+  /**
+   * Decodes the given soft values, which include the tail.
+   * \param received The punctured soft values
+   * \param hard     Whether the values are hard decisions (+1, -1 or 0), which enables integer path metrics
+   * \return         The decoded bits, without tail
+   */
+  itpp::bvec Decode (const itpp::vec &received, bool hard);
+
+private:
+  static const uint32_t NUM_STATES = 64;
+  static const uint32_t MEMORY = 6;
+
+  /**
+   * Inserts zero values at the punctured positions, exactly as itpp::Punctured_Convolutional_Code does
+   */
+  void Depuncture (const itpp::vec &received);
+  template <typename T>
+  void DecodeBlock (const T *input, uint32_t blockLength, itpp::bvec &output);
+
+  /**
+   * Traces back from the given state after trellis step 'from' down to step 'to' and writes the decoded bits of
+   * the steps below 'emitLimit' into the output. Decisions are taken from the ring buffer.
+   * \return The state before step 'to'
+   */
+  uint32_t Traceback (uint32_t state, int32_t from, int32_t to, int32_t emitLimit, itpp::bvec &output) const;
+
+  uint32_t m_period;
+  uint32_t m_tracebackDepth;
+  uint32_t m_windowLength;
+  bool m_puncture[2][3];
+  // Index (c0 << 1 | c1) of the code word of the transition into state s from the predecessor with lowest bit x
+  uint8_t m_codewords[NUM_STATES][2];
+
+  std::vector<double> m_depunctured;
+  std::vector<int32_t> m_hardValues;
+  std::vector<uint64_t> m_decisions;
+};
+
+} // namespace ns3
+
+#endif /* PHYSIM_VITERBI_DECODER_H */
@@ -30,10 +30,16 @@
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/object-factory.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "physim-wifi-channel.h"
 #include "physim-wifi-phy.h"
 #include "physim-propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include "physim-helper.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 NS_LOG_COMPONENT_DEFINE ("PhySimWifiChannel");
 
@@ -66,11 +72,30 @@ PhySimWifiUniformChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&PhySimWifiUniformChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("RangeCulling",
+                   "Flag indicating whether frames are only delivered to PHYs whose received signal strength may reach their "
+                   "energy detection threshold, according to an upper bound of the gain of the (deterministic) propagation "
+                   "loss models. Culled PHYs do not report an EnergyDetectionFailed event.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PhySimWifiUniformChannel::m_rangeCulling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RangeCullingCellSize",
+                   "The edge length (in m) of the cells of the spatial grid that is used for the range culling",
+                   DoubleValue (250.0),
+                   MakeDoubleAccessor (&PhySimWifiUniformChannel::m_cellSize),
+                   MakeDoubleChecker<double> (1.0))
   ;
   return tid;
 }
 
 PhySimWifiUniformChannel::PhySimWifiUniformChannel ()
+  : m_rangeCulling (false),
+    m_cellSize (250.0),
+    m_gridValid (false),
+    m_maxSpeed (0.0),
+    m_minDetectableDbm (0.0),
+    m_culled (0),
+    m_delivered (0)
 {
 }
 PhySimWifiUniformChannel::~PhySimWifiUniformChannel ()
@@ -94,6 +119,7 @@ void
 PhySimWifiUniformChannel::Add (Ptr<PhySimWifiPhy> phy)
 {
   m_phyList.push_back (phy);
+  m_gridValid = false;
 }
 
 void
@@ -113,34 +139,242 @@ PhySimWifiUniformChannel::Send (Ptr<PhySimWifiPhy> sender, Ptr<const Packet> pac
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+
+  std::vector<uint32_t> receivers;
+  if (m_rangeCulling)
+    {
+      GetReceivers (sender, senderMobility, tag, receivers);
+    }
+  else
     {
-      if (sender != (*i))
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
         {
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+          if (sender != m_phyList[j])
+            {
+              receivers.push_back (j);
+            }
+        }
+    }
+  m_culled += m_phyList.size () - 1 - receivers.size ();
+  m_delivered += receivers.size ();
 
-          // copy packet and tag object
-          Ptr<Packet> packetcopy = packet->Copy ();
-          Ptr<PhySimWifiPhyTag> tagcopy = Create<PhySimWifiPhyTag> (*tag);
+  for (std::vector<uint32_t>::const_iterator j = receivers.begin (); j != receivers.end (); j++)
+    {
+      Ptr<PhySimWifiPhy> receiver = m_phyList[*j];
+      Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+      Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
 
-          // set rx net device object on the tag
-          tagcopy->SetRxNetDevice ((*i)->GetDevice ()->GetObject<NetDevice> ());
+      // copy packet and tag object (the copy shares the sample buffers of the tag)
+      Ptr<Packet> packetcopy = packet->Copy ();
+      Ptr<PhySimWifiPhyTag> tagcopy = Create<PhySimWifiPhyTag> (*tag);
 
-          // apply propagation loss models
-          m_loss->CalcRxPower (tagcopy, senderMobility, receiverMobility);
+      // set rx net device object on the tag
+      tagcopy->SetRxNetDevice (receiver->GetDevice ()->GetObject<NetDevice> ());
 
-          // determine receiver node id
-          uint32_t dstNode = (*i)->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
+      // apply propagation loss models
+      m_loss->CalcRxPower (tagcopy, senderMobility, receiverMobility);
 
-          // schedule the reception event at the receiver
-          Simulator::ScheduleWithContext (dstNode, delay, &PhySimWifiUniformChannel::Receive, this,
-                                          j, packetcopy, tagcopy);
+      // determine receiver node id
+      uint32_t dstNode = receiver->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
+
+      // schedule the reception event at the receiver
+      Simulator::ScheduleWithContext (dstNode, delay, &PhySimWifiUniformChannel::Receive, this,
+                                      *j, packetcopy, tagcopy);
+    }
+}
+
+uint64_t
+PhySimWifiUniformChannel::GetNCulledReceivers (void) const
+{
+  return m_culled;
+}
+
+uint64_t
+PhySimWifiUniformChannel::GetNDeliveredReceivers (void) const
+{
+  return m_delivered;
+}
+
+PhySimWifiUniformChannel::GridCell
+PhySimWifiUniformChannel::GetCell (const Vector &position) const
+{
+  return GridCell ((int64_t) std::floor (position.x / m_cellSize), (int64_t) std::floor (position.y / m_cellSize));
+}
+
+bool
+PhySimWifiUniformChannel::IsCellInRange (const GridCell &cell, const Vector &position, double range) const
+{
+  double dx = std::max (std::max (cell.first * m_cellSize - position.x, position.x - (cell.first + 1) * m_cellSize), 0.0);
+  double dy = std::max (std::max (cell.second * m_cellSize - position.y, position.y - (cell.second + 1) * m_cellSize), 0.0);
+  return dx * dx + dy * dy < range * range;
+}
+
+double
+PhySimWifiUniformChannel::GetMaxDrift (void) const
+{
+  return m_maxSpeed * (Simulator::Now () - m_gridTime).GetSeconds ();
+}
 
+void
+PhySimWifiUniformChannel::UpdateGrid (void)
+{
+  if (m_gridValid && GetMaxDrift () <= m_cellSize)
+    {
+      return;
+    }
+  m_grid.clear ();
+  m_cells.resize (m_phyList.size ());
+  m_maxSpeed = 0.0;
+  m_minDetectableDbm = std::numeric_limits<double>::infinity ();
+  for (uint32_t j = 0; j < m_phyList.size (); j++)
+    {
+      Ptr<MobilityModel> mobility = m_phyList[j]->GetMobility ()->GetObject<MobilityModel> ();
+      if (m_mobilityIndices.find (PeekPointer (mobility)) == m_mobilityIndices.end ())
+        {
+          mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&PhySimWifiUniformChannel::CourseChanged, this));
         }
-      j++;
+      m_mobilityIndices[PeekPointer (mobility)] = j;
+      m_cells[j] = GetCell (mobility->GetPosition ());
+      m_grid[m_cells[j]].push_back (j);
+      Vector velocity = mobility->GetVelocity ();
+      m_maxSpeed = std::max (m_maxSpeed, std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y));
+      m_minDetectableDbm = std::min (m_minDetectableDbm, m_phyList[j]->GetEdThresholdDbm () - m_phyList[j]->GetRxGainDb ());
+    }
+  m_gridValid = true;
+  m_gridTime = Simulator::Now ();
+  NS_LOG_DEBUG ("PhySimWifiUniformChannel::UpdateGrid() - sorted " << m_phyList.size () << " PHYs into " << m_grid.size () << " cells");
+}
+
+void
+PhySimWifiUniformChannel::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  std::map<const MobilityModel *, uint32_t>::const_iterator index = m_mobilityIndices.find (PeekPointer (mobility));
+  if (!m_gridValid || index == m_mobilityIndices.end ())
+    {
+      return;
+    }
+  uint32_t j = index->second;
+  Vector velocity = mobility->GetVelocity ();
+  m_maxSpeed = std::max (m_maxSpeed, std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y));
+  GridCell cell = GetCell (mobility->GetPosition ());
+  if (cell == m_cells[j])
+    {
+      return;
+    }
+  std::vector<uint32_t> &old = m_grid[m_cells[j]];
+  old.erase (std::find (old.begin (), old.end (), j));
+  if (old.empty ())
+    {
+      m_grid.erase (m_cells[j]);
     }
+  m_grid[cell].push_back (j);
+  m_cells[j] = cell;
+}
+
+void
+PhySimWifiUniformChannel::GetReceivers (Ptr<PhySimWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                                        Ptr<const PhySimWifiPhyTag> tag, std::vector<uint32_t> &receivers)
+{
+  // Tolerance for rounding errors between the bound and the signal strength computed from the samples
+  const double tolerance = 1e-6;
+  UpdateGrid ();
+
+  const itpp::cvec &samples = tag->PeekRxedSamples ();
+  double txPowerDbm = PhySimHelper::RatioToDb (PhySimHelper::GetOFDMSymbolSignalStrength (samples._data (), samples.size ()));
+  double frequency = tag->GetFrequency ();
+
+  // Find a range beyond which not even the most sensitive PHY can detect the frame: double the distance until the
+  // bound drops below the threshold, then narrow it down by bisection
+  double required = m_minDetectableDbm - txPowerDbm - tolerance;
+  double range = 1.0;
+  while (range < 1e8 && m_loss->GetMaxGainDb (range, frequency) >= required)
+    {
+      range *= 2;
+    }
+  if (range >= 1e8)
+    {
+      range = std::numeric_limits<double>::infinity ();
+    }
+  else
+    {
+      double lower = range / 2;
+      for (uint32_t k = 0; k < 16; k++)
+        {
+          double middle = (lower + range) / 2;
+          if (m_loss->GetMaxGainDb (middle, frequency) >= required)
+            {
+              lower = middle;
+            }
+          else
+            {
+              range = middle;
+            }
+        }
+    }
+  NS_LOG_DEBUG ("PhySimWifiUniformChannel::GetReceivers() - txPowerDbm = " << txPowerDbm << ", range = " << range << " m");
+
+  // Collect the PHYs of all cells that intersect with the range around the sender, widened by the distance the PHYs
+  // may have moved since they were sorted into their cells. Only the cells within the box [position - margin,
+  // position + margin] are looked up, unless the box holds more cells than the grid. Without a finite range, all
+  // PHYs are candidates.
+  Vector position = senderMobility->GetPosition ();
+  double margin = range + GetMaxDrift ();
+  if (margin == std::numeric_limits<double>::infinity ())
+    {
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          receivers.push_back (j);
+        }
+    }
+  else
+    {
+      GridCell low = GetCell (Vector (position.x - margin, position.y - margin, 0.0));
+      GridCell high = GetCell (Vector (position.x + margin, position.y + margin, 0.0));
+      double boxCells = (double) (high.first - low.first + 1) * (double) (high.second - low.second + 1);
+      if (boxCells <= m_grid.size ())
+        {
+          for (int64_t x = low.first; x <= high.first; x++)
+            {
+              for (int64_t y = low.second; y <= high.second; y++)
+                {
+                  std::map<GridCell, std::vector<uint32_t> >::const_iterator cell = m_grid.find (GridCell (x, y));
+                  if (cell != m_grid.end () && IsCellInRange (cell->first, position, margin))
+                    {
+                      receivers.insert (receivers.end (), cell->second.begin (), cell->second.end ());
+                    }
+                }
+            }
+        }
+      else
+        {
+          for (std::map<GridCell, std::vector<uint32_t> >::const_iterator cell = m_grid.begin (); cell != m_grid.end (); cell++)
+            {
+              if (IsCellInRange (cell->first, position, margin))
+                {
+                  receivers.insert (receivers.end (), cell->second.begin (), cell->second.end ());
+                }
+            }
+        }
+      std::sort (receivers.begin (), receivers.end ());
+    }
+
+  // Check the remaining PHYs individually with their actual distance and threshold
+  std::vector<uint32_t>::iterator last = receivers.begin ();
+  for (std::vector<uint32_t>::const_iterator j = receivers.begin (); j != receivers.end (); j++)
+    {
+      Ptr<PhySimWifiPhy> receiver = m_phyList[*j];
+      if (receiver == sender)
+        {
+          continue;
+        }
+      double distance = senderMobility->GetDistanceFrom (receiver->GetMobility ()->GetObject<MobilityModel> ());
+      double maxRxPowerDbm = txPowerDbm + m_loss->GetMaxGainDb (distance, frequency) + receiver->GetRxGainDb ();
+      if (maxRxPowerDbm >= receiver->GetEdThresholdDbm () - tolerance)
+        {
+          *last++ = *j;
+        }
+    }
+  receivers.erase (last, receivers.end ());
 }
 
 void
@@ -175,6 +409,7 @@ PhySimWifiManualChannel::GetTypeId (void)
 }
 
 PhySimWifiManualChannel::PhySimWifiManualChannel ()
+  : m_linksValid (false)
 {
 }
 PhySimWifiManualChannel::~PhySimWifiManualChannel ()
@@ -198,6 +433,7 @@ void
 PhySimWifiManualChannel::Add (Ptr<PhySimWifiPhy> phy)
 {
   m_phyList.push_back (phy);
+  m_linksValid = false;
 }
 
 void
@@ -210,6 +446,7 @@ void
 PhySimWifiManualChannel::SetExplicitPropagationLossModel (uint32_t sender, uint32_t receiver, Ptr<PhySimPropagationLossModel> loss)
 {
   m_loss[sender].insert ( std::pair<uint32_t, Ptr<PhySimPropagationLossModel> > (receiver, loss) );
+  m_linksValid = false;
 }
 
 void
@@ -222,30 +459,83 @@ void
 PhySimWifiManualChannel::SetExplicitPropagationDelayModel (uint32_t sender, uint32_t receiver, Ptr<PropagationDelayModel> delay)
 {
   m_delay[sender].insert ( std::pair<uint32_t, Ptr<PropagationDelayModel> > (receiver, delay) );
+  m_linksValid = false;
+}
+
+void
+PhySimWifiManualChannel::UpdateLinkTable (void)
+{
+  const uint32_t n = m_phyList.size ();
+  NS_LOG_DEBUG ("PhySimWifiManualChannel::UpdateLinkTable() - building link table for " << n << " PHYs");
+
+  m_nodeIds.resize (n);
+  m_mobilities.resize (n);
+  m_devices.resize (n);
+  m_phyIndices.clear ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_phyIndices[PeekPointer (m_phyList[i])] = i;
+      m_devices[i] = m_phyList[i]->GetDevice ()->GetObject<NetDevice> ();
+      m_nodeIds[i] = m_devices[i]->GetNode ()->GetId ();
+      m_mobilities[i] = m_phyList[i]->GetMobility ()->GetObject<MobilityModel> ();
+    }
+
+  // Entries without an explicitly configured model remain zero, i.e. the default models are used for them
+  m_links.assign (n * n, LinkModels ());
+  for (uint32_t s = 0; s < n; s++)
+    {
+      std::map<uint32_t, std::map<uint32_t, Ptr<PhySimPropagationLossModel> > >::const_iterator loss = m_loss.find (m_nodeIds[s]);
+      std::map<uint32_t, std::map<uint32_t, Ptr<PropagationDelayModel> > >::const_iterator delay = m_delay.find (m_nodeIds[s]);
+      for (uint32_t r = 0; r < n; r++)
+        {
+          LinkModels &link = m_links[s * n + r];
+          if (loss != m_loss.end ())
+            {
+              std::map<uint32_t, Ptr<PhySimPropagationLossModel> >::const_iterator model = loss->second.find (m_nodeIds[r]);
+              if (model != loss->second.end ())
+                {
+                  link.loss = model->second;
+                }
+            }
+          if (delay != m_delay.end ())
+            {
+              std::map<uint32_t, Ptr<PropagationDelayModel> >::const_iterator model = delay->second.find (m_nodeIds[r]);
+              if (model != delay->second.end ())
+                {
+                  link.delay = model->second;
+                }
+            }
+        }
+    }
+  m_linksValid = true;
 }
 
 void
 PhySimWifiManualChannel::Send (Ptr<PhySimWifiPhy> sender, Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag)
 {
-  Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
-  const uint32_t senderId = sender->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
+  if (!m_linksValid)
+    {
+      UpdateLinkTable ();
+    }
+  const uint32_t n = m_phyList.size ();
+  std::map<const PhySimWifiPhy *, uint32_t>::const_iterator index = m_phyIndices.find (PeekPointer (sender));
+  NS_ASSERT (index != m_phyIndices.end ());
+  const uint32_t s = index->second;
+  Ptr<MobilityModel> senderMobility = m_mobilities[s];
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  const LinkModels *links = &m_links[s * n];
+  for (uint32_t j = 0; j < n; j++)
     {
-      if (sender != (*i))
+      if (j != s)
         {
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-
-          const uint32_t receiverId = (*i)->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
+          Ptr<MobilityModel> receiverMobility = m_mobilities[j];
 
           // Check if we have a manually configured delay model
           Time delay;
-          if ( m_delay.find (senderId) != m_delay.end ()
-               && (m_delay.find (senderId)->second).find (receiverId) != (m_delay.find (senderId)->second).end () )
+          if (links[j].delay != 0)
             {
               NS_LOG_DEBUG ("PhySimWifiManualChannel::Send() - using manually selected delay model.");
-              delay = ((m_delay.find (senderId)->second).find (receiverId)->second)->GetDelay (senderMobility, receiverMobility);
+              delay = links[j].delay->GetDelay (senderMobility, receiverMobility);
             }
           else
             {
@@ -253,16 +543,15 @@ PhySimWifiManualChannel::Send (Ptr<PhySimWifiPhy> sender, Ptr<const Packet> pack
               delay = m_defaultDelay->GetDelay (senderMobility, receiverMobility);
             }
 
-          // copy packet and tag object
+          // copy packet and tag object (the copy shares the sample buffers of the tag)
           Ptr<Packet> packetcopy = packet->Copy ();
           Ptr<PhySimWifiPhyTag> tagcopy = Create<PhySimWifiPhyTag> (*tag);
 
           // Check if we have a manually configured propagation loss models
-          if ( m_loss.find (senderId) != m_loss.end ()
-               && (m_loss.find (senderId)->second).find (receiverId) != (m_loss.find (senderId)->second).end () )
+          if (links[j].loss != 0)
             {
               NS_LOG_DEBUG ("PhySimWifiManualChannel::Send() - using manually selected propagation loss model(s).");
-              ((m_loss.find (senderId)->second).find (receiverId)->second)->CalcRxPower (tagcopy, senderMobility, receiverMobility);
+              links[j].loss->CalcRxPower (tagcopy, senderMobility, receiverMobility);
             }
           else
             {
@@ -271,13 +560,11 @@ PhySimWifiManualChannel::Send (Ptr<PhySimWifiPhy> sender, Ptr<const Packet> pack
             }
 
           // set rx net device object on the tag
-          tagcopy->SetRxNetDevice ((*i)->GetDevice ()->GetObject<NetDevice> ());
+          tagcopy->SetRxNetDevice (m_devices[j]);
 
-          uint32_t dstNode = (*i)->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
-          Simulator::ScheduleWithContext (dstNode, delay, &PhySimWifiManualChannel::Receive, this,
+          Simulator::ScheduleWithContext (m_nodeIds[j], delay, &PhySimWifiManualChannel::Receive, this,
                                           j, packetcopy, tagcopy);
         }
-      j++;
     }
 }
 
@@ -31,10 +31,13 @@
 #include "ns3/wifi-channel.h"
 #include "ns3/wifi-mode.h"
 #include "ns3/wifi-preamble.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
 
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PhySimPropagationLossModel;
 class PropagationDelayModel;
 class PhySimWifiPhy;
@@ -147,14 +150,67 @@ public:
    *               the vector with all the complex time samples
    */
   void Send (Ptr<PhySimWifiPhy> sender, Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag);
+  /**
+   * Returns the number of receivers to which a frame was not delivered by the range culling (attribute 'RangeCulling'),
+   * because its signal strength would have been below their energy detection threshold
+   */
+  uint64_t GetNCulledReceivers (void) const;
+  /**
+   * Returns the number of receivers to which a frame was delivered, i.e. for which the propagation loss was computed
+   */
+  uint64_t GetNDeliveredReceivers (void) const;
 
 private:
   typedef std::vector<Ptr<PhySimWifiPhy> > PhyList;
+  typedef std::pair<int64_t, int64_t> GridCell;
   void Receive (uint32_t i, Ptr<Packet> packet, Ptr<PhySimWifiPhyTag> tag) const;
+  /**
+   * Determines the indices of all PHYs whose received signal strength may be above their energy detection threshold,
+   * based on the upper bound of the gain of the propagation loss models (PhySimPropagationLossModel::GetMaxGainDb)
+   * \param sender         The sending PHY
+   * \param senderMobility The mobility model of the sender
+   * \param tag            The tag of the transmitted frame
+   * \param receivers      The indices of the PHYs, in ascending order
+   */
+  void GetReceivers (Ptr<PhySimWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<const PhySimWifiPhyTag> tag,
+                     std::vector<uint32_t> &receivers);
+  /**
+   * Sorts all PHYs into the cells of the spatial grid according to their current positions. This is done when PHYs
+   * have been added, or when the PHYs may have moved by more than a cell since the grid was built. In between, a PHY
+   * changes its cell only when its mobility model reports a course change (see CourseChanged).
+   */
+  void UpdateGrid (void);
+  /**
+   * Moves the PHY of the given mobility model into the cell of its new position
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  GridCell GetCell (const Vector &position) const;
+  /**
+   * Returns whether the closest point of the given cell is closer than 'range' to the given position (x/y plane)
+   */
+  bool IsCellInRange (const GridCell &cell, const Vector &position, double range) const;
+  /**
+   * Returns an upper bound of the distance that any PHY may have moved away from the cell it is sorted into, since
+   * PHYs with a constant velocity do not report course changes
+   */
+  double GetMaxDrift (void) const;
 
   PhyList m_phyList;
   Ptr<PhySimPropagationLossModel> m_loss;
   Ptr<PropagationDelayModel> m_delay;
+
+  // Range culling: spatial grid (x/y plane) of the PHY indices, and the lowest signal strength that any PHY can detect
+  bool m_rangeCulling;
+  double m_cellSize;
+  std::map<GridCell, std::vector<uint32_t> > m_grid;
+  std::vector<GridCell> m_cells;
+  std::map<const MobilityModel *, uint32_t> m_mobilityIndices;
+  bool m_gridValid;
+  Time m_gridTime;
+  double m_maxSpeed;
+  double m_minDetectableDbm;
+  uint64_t m_culled;
+  uint64_t m_delivered;
 };
 
 /**
@@ -224,7 +280,21 @@ public:
 
 private:
   typedef std::vector<Ptr<PhySimWifiPhy> > PhyList;
+  /**
+   * The explicitly configured models of a link, or zero if the default model applies
+   */
+  struct LinkModels
+  {
+    Ptr<PhySimPropagationLossModel> loss;
+    Ptr<PropagationDelayModel> delay;
+  };
   void Receive (uint32_t i, Ptr<Packet> packet, Ptr<PhySimWifiPhyTag> tag) const;
+  /**
+   * Caches the index, node identifier, NetDevice and mobility model of every PHY and resolves the explicitly configured
+   * models of every link, indexed by the positions of the PHYs in m_phyList. This is done on the first transmission
+   * after PHYs or models have been added, since PHYs are attached to the channel before their device is set.
+   */
+  void UpdateLinkTable (void);
 
 
   PhyList m_phyList;
@@ -236,6 +306,14 @@ private:
   std::map<uint32_t, std::map<uint32_t, Ptr<PhySimPropagationLossModel> > > m_loss;
   std::map<uint32_t, std::map<uint32_t, Ptr<PropagationDelayModel> > > m_delay;
 
+  // Per-PHY attributes and the dense link table (row = sending PHY, column = receiving PHY), see UpdateLinkTable
+  std::vector<uint32_t> m_nodeIds;
+  std::map<const PhySimWifiPhy *, uint32_t> m_phyIndices;
+  std::vector<Ptr<MobilityModel> > m_mobilities;
+  std::vector<Ptr<NetDevice> > m_devices;
+  std::vector<LinkModels> m_links;
+  bool m_linksValid;
+
 };
 
 } // namespace ns3
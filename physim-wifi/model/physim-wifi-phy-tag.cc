@@ -39,7 +39,7 @@ PhySimWifiPhyTag::GetTypeId ()
 
 PhySimWifiPhyTag::PhySimWifiPhyTag ()
   : m_txed (false),
-    m_rxSamples (0),
+    m_rxGain (1.0, 0.0),
     m_beginLongSymbols (-1),
     m_captured (false),
     m_length (0)
@@ -60,8 +60,8 @@ PhySimWifiPhyTag::SetTxParameters (WifiPreamble wifiPreamble,
   m_wifiPreamble = wifiPreamble;
   m_txWifiMode = wifiMode;
   m_duration = duration;
-  m_txDataBits = databits;
-  m_txSamples = samples;
+  m_txDataBits = Create<PhySimSharedVector<itpp::bvec> > (databits);
+  m_txSamples = Create<PhySimSharedVector<itpp::cvec> > (samples);
   m_frequency = frequency;
   m_sampleDuration = sampleDuration;
   m_txNetDevice = txDevice;
@@ -102,22 +102,51 @@ PhySimWifiPhyTag::GetDuration () const
 
 itpp::bvec
 PhySimWifiPhyTag::GetTxedDataBits () const
+{
+  return PeekTxedDataBits ();
+}
+
+const itpp::bvec &
+PhySimWifiPhyTag::PeekTxedDataBits () const
 {
   NS_ASSERT (m_txed);
-  return m_txDataBits;
+  return m_txDataBits->Get ();
 }
 
 itpp::cvec
 PhySimWifiPhyTag::GetTxedSamples () const
+{
+  return PeekTxedSamples ();
+}
+
+const itpp::cvec &
+PhySimWifiPhyTag::PeekTxedSamples () const
 {
   NS_ASSERT (m_txed);
-  return m_txSamples;
+  return m_txSamples->Get ();
 }
 
 itpp::cvec
 PhySimWifiPhyTag::GetRxedSamples () const
 {
-  return m_rxSamples;
+  return PeekRxedSamples ();
+}
+
+const itpp::cvec &
+PhySimWifiPhyTag::PeekRxedSamples () const
+{
+  static const itpp::cvec empty (0);
+  if (m_rxSamples == 0)
+    {
+      return empty;
+    }
+  if (m_rxGain != std::complex<double> (1.0, 0.0))
+    {
+      // Apply all gains accumulated by ScaleRxSamples in one pass
+      m_rxSamples = Create<PhySimSharedVector<itpp::cvec> > (m_rxSamples->Get () * m_rxGain);
+      m_rxGain = std::complex<double> (1.0, 0.0);
+    }
+  return m_rxSamples->Get ();
 }
 
 double
@@ -135,7 +164,22 @@ PhySimWifiPhyTag::GetSampleDuration () const
 void
 PhySimWifiPhyTag::SetRxSamples (itpp::cvec samples)
 {
-  m_rxSamples = samples;
+  m_rxSamples = Create<PhySimSharedVector<itpp::cvec> > (samples);
+  m_rxGain = std::complex<double> (1.0, 0.0);
+}
+
+void
+PhySimWifiPhyTag::SetRxSamplesToTxSamples ()
+{
+  NS_ASSERT (m_txed);
+  m_rxSamples = m_txSamples;
+  m_rxGain = std::complex<double> (1.0, 0.0);
+}
+
+void
+PhySimWifiPhyTag::ScaleRxSamples (std::complex<double> gain)
+{
+  m_rxGain *= gain;
 }
 
 void
@@ -318,6 +362,18 @@ PhySimWifiPhyTag::GetShortTrainingSymbolCorrelations () const
   return m_shortTrainingSymbolCorrelations;
 }
 
+void
+PhySimWifiPhyTag::SetSymbolSinrs (std::vector<double> values)
+{
+  m_symbolSinrs = values;
+}
+
+std::vector<double>
+PhySimWifiPhyTag::GetSymbolSinrs () const
+{
+  return m_symbolSinrs;
+}
+
 void
 PhySimWifiPhyTag::SetLongTrainingSymbolCorrelations (std::vector<double> correlations)
 {
@@ -381,10 +437,10 @@ PhySimWifiPhyTag::Print (std::ostream &os) const
          << " txWifiMode=" << m_txWifiMode
          << " rxWifiMode=" << m_rxWifiMode
          << " duration=" << m_duration
-         << " txDataBits=" << m_txDataBits
-         << " txSamples=" << m_txSamples;
+         << " txDataBits=" << PeekTxedDataBits ()
+         << " txSamples=" << PeekTxedSamples ();
     }
-  os << " rxSamples=" << m_rxSamples;
+  os << " rxSamples=" << PeekRxedSamples ();
 }
 
 std::ostream& operator<< (std::ostream& os, const PhySimWifiPhyTag& tag)
@@ -30,11 +30,36 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "ns3/ref-count-base.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/net-device.h"
 #include <itpp/itcomm.h>
+#include <complex>
 
 namespace ns3 {
 
+/**
+ * \brief Immutable, reference-counted vector of IT++ samples or bits.
+ *
+ * Copies of a PhySimWifiPhyTag share these buffers instead of duplicating the waveform, which matters
+ * since the channel creates one copy of the tag per receiver of a transmission.
+ */
+template <typename T>
+class PhySimSharedVector : public SimpleRefCount<PhySimSharedVector<T> >
+{
+public:
+  PhySimSharedVector (const T &data)
+    : m_data (data)
+  {
+  }
+  const T & Get () const
+  {
+    return m_data;
+  }
+
+private:
+  const T m_data;
+};
+
 /**
  * \brief Annotate a packet sent through a PhySimWifiPhy with transmission parameters
  * and other additional information (for cross-layer information handling or evaluation purposes).
@@ -42,6 +67,13 @@ namespace ns3 {
  * This tag is created when a PhySimWifiPhy instance starts to transmit a packet, and it is passed
  * through the layers and the PhySimWifiChannel to the receiving PhySimWifiPhy. During that process,
  * transmission information is collected and used by PhySimWifiPhy for further calculations.
+ *
+ * The transmitted samples and bits are stored in shared, immutable buffers, such that the per-receiver
+ * copies of the tag created by the channel do not duplicate them. The received samples initially refer
+ * to the transmitted samples as well (see SetRxSamplesToTxSamples), and a separate vector is only created
+ * once a propagation loss model or the receiver stores modified samples via SetRxSamples. Scalar gains,
+ * as applied by the deterministic propagation loss models, are accumulated by ScaleRxSamples and only
+ * multiplied into the samples when they are read for the first time.
  */
 class PhySimWifiPhyTag : public Tag,
                          public RefCountBase
@@ -73,6 +105,18 @@ public:
    * \param samples The vector of complex samples which represents the received waveform
    */
   void SetRxSamples (itpp::cvec samples);
+  /**
+   * Lets the received samples refer to the transmitted samples without copying them. This is used by
+   * the transmitting PhySimWifiPhy before the tag is handed over to the channel.
+   */
+  void SetRxSamplesToTxSamples ();
+  /**
+   * Multiplies the received samples with a scalar (amplitude) gain. The gain is not applied immediately,
+   * but accumulated with other pending gains and applied in a single pass when the received samples are
+   * read next, e.g. by a fading model or the receiving PhySimWifiPhy.
+   * \param gain The complex gain factor
+   */
+  void ScaleRxSamples (std::complex<double> gain);
   /**
    * Sets the background noise, for instance generated by the PhySimInterferenceHelper, that was present during the reception of
    * the corresponding frame reception. This is done in order to allow later checks by individual simulation scripts and scenarios,
@@ -132,6 +176,12 @@ public:
    * \param value The calculated SINR
    */
   void SetOverallSinr (double value);
+  /**
+   * Set the SINR of each OFDM symbol (block of 80 time samples) of the frame, as computed by
+   * PhySimInterferenceHelper::CalculateSinrs
+   * \param values The per-symbol SINR values in dB
+   */
+  void SetSymbolSinrs (std::vector<double> values);
   /**
    * Set the pathloss that was applied by a propagation loss model. Please note that if propagation loss
    * models are chained, they have to read this value and calculate the total pathloss first before setting
@@ -195,6 +245,10 @@ public:
    * \return The transmitted data bits as an IT++ bit vector
    */
   itpp::bvec GetTxedDataBits () const;
+  /**
+   * Returns a const reference to the Tx data bits, i.e. without copying them.
+   */
+  const itpp::bvec & PeekTxedDataBits () const;
   /**
    * Returns the Rx data bit vector, which can be used by a callback for instance to show the difference between transmitted and
    * received data bits (e.g. by a visualizer, frontend or demonstrator)
@@ -206,6 +260,10 @@ public:
    * \return The transmitted complex time samples
    */
   itpp::cvec GetTxedSamples () const;
+  /**
+   * Returns a const reference to the transmitted complex time samples, i.e. without copying them.
+   */
+  const itpp::cvec & PeekTxedSamples () const;
   /**
    * Returns the center carrier frequency that was used in this transmission
    * \return The center frequency of the carrier used
@@ -235,6 +293,11 @@ public:
    * if the attribute 'CalculateOverallSinr' is set to false in PhySimWifiPhy.
    */
   double GetOverallSinr () const;
+  /**
+   * Returns the SINR of each OFDM symbol of the frame (in dB). Please note that this information might be missing,
+   * if the attribute 'CalculateSymbolSinr' is set to false in PhySimWifiPhy.
+   */
+  std::vector<double> GetSymbolSinrs () const;
   /**
    * Returns the stored value for the applied pathloss (in dB)
    */
@@ -253,6 +316,11 @@ public:
    * \return The received samples represented as an IT++ complex vector
    */
   itpp::cvec GetRxedSamples () const;
+  /**
+   * Returns a const reference to the received samples. In contrast to GetRxedSamples, no copy of the
+   * samples is made, which is what the PhySimInterferenceHelper uses when accumulating overlapping frames.
+   */
+  const itpp::cvec & PeekRxedSamples () const;
   /**
    * Returns the background noise that was present during the reception of this signal or frame
    */
@@ -300,8 +368,8 @@ public:
 
 private:
   // *** Parameters set by the transmitting PhySimWifiPhy ***
-  itpp::bvec            m_txDataBits;
-  itpp::cvec            m_txSamples;
+  Ptr<const PhySimSharedVector<itpp::bvec> > m_txDataBits;
+  Ptr<const PhySimSharedVector<itpp::cvec> > m_txSamples;
   bool                  m_txed;
   WifiPreamble          m_wifiPreamble;
   WifiMode              m_txWifiMode;
@@ -315,7 +383,8 @@ private:
   double                m_pathLoss;
 
   // *** Parameters set by the receiving PhySimWifiPhy ***
-  itpp::cvec            m_rxSamples;
+  mutable Ptr<const PhySimSharedVector<itpp::cvec> > m_rxSamples;
+  mutable std::complex<double> m_rxGain; // pending gain of the received samples, see ScaleRxSamples
   itpp::bvec            m_rxDatabits;
   uint32_t              m_beginShortSymbols;
   uint32_t              m_beginLongSymbols;
@@ -329,6 +398,7 @@ private:
   double                m_headerSinr;
   double                m_payloadSinr;
   double                m_overallSinr;
+  std::vector<double>   m_symbolSinrs;
   itpp::cvec            m_bgNoise;
   std::vector<double>   m_shortTrainingSymbolCorrelations;
   std::vector<double>   m_longTrainingSymbolCorrelations;
@@ -28,6 +28,7 @@
 #include "physim-wifi-channel.h"
 #include "physim-ofdm-symbolcreator.h"
 #include "physim-wifi-phy-state-helper.h"
+#include "physim-packed-bits.h"
 #include "ns3/wifi-mode.h"
 #include "ns3/wifi-preamble.h"
 #include "ns3/error-rate-model.h"
@@ -45,6 +46,7 @@
 #include "ns3/enum.h"
 #include "ns3/pointer.h"
 #include "ns3/net-device.h"
+#include "ns3/node.h"
 #include "ns3/wifi-phy-standard.h"
 #include "ns3/trace-source-accessor.h"
 
@@ -55,7 +57,7 @@ namespace ns3 {
 NS_OBJECT_ENSURE_REGISTERED (PhySimWifiPhy);
 
 const double PhySimWifiPhy::m_normFactor = sqrt (64.0 * 64.0 / 52.0);
-itpp::cvec PhySimWifiPhy::m_cachedPreamble;
+std::map<int64_t, itpp::cvec> PhySimWifiPhy::m_cachedPreambles;
 bool PhySimWifiPhy::m_rngReset;
 
 TypeId
@@ -134,6 +136,43 @@ PhySimWifiPhy::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PhySimWifiPhy::m_calculateOverallSinr),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseSinrLookup",
+                   "Flag indicating whether the reception of a payload shall be decided by a lookup of its effective SINR "
+                   "in the PER curves of the attribute 'PerTable' whenever this SINR is clearly above or below the decoding "
+                   "threshold of its WiFi mode and length. Only frames whose effective SINR lies within the band defined by "
+                   "'SinrLookupBand', and frames without a calibrated PER curve, are decoded bit by bit.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PhySimWifiPhy::m_useSinrLookup),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SinrLookupBand",
+                   "Half-width (in dB) of the uncertainty band around the decoding threshold (the SINR at which 10% of the "
+                   "frames are lost) in which the full bit-level decoding chain is used, although 'UseSinrLookup' is enabled.",
+                   DoubleValue (3.0),
+                   MakeDoubleAccessor (&PhySimWifiPhy::m_sinrLookupBand),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("PerTable",
+                   "The PER curves (as written by the example physim-per-calibration) used by the SINR lookup. The curves "
+                   "calibrated without fading (PhySimPerTable::AWGN_PROFILE) are used.",
+                   PointerValue (),
+                   MakePointerAccessor (&PhySimWifiPhy::m_perTable),
+                   MakePointerChecker<PhySimPerTable> ())
+    .AddAttribute ("CalculateSymbolSinr",
+                   "Flag indicating whether to calculate the SINR of each OFDM symbol of a frame or not (will be stored inside of PhySimWifiPhyTag and reported through the SymbolSinr trace source, but increases processing time)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PhySimWifiPhy::m_calculateSymbolSinr),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SignalCacheSize",
+                   "Maximum number of modulated SIGNAL fields, one per combination of rate and length, that are kept "
+                   "for reuse in later transmissions (0 disables the cache)",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&PhySimWifiPhy::m_signalCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("UseTxPipeline",
+                   "Flag indicating whether the DATA field of a frame is constructed by the streaming PhySimTxPipeline, "
+                   "which processes one OFDM symbol at a time, instead of separate passes over the whole frame (bit-exact)",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&PhySimWifiPhy::m_useTxPipeline),
+                   MakeBooleanChecker ())
     .AddAttribute ("State", "The state of the PHY layer",
                    PointerValue (),
                    MakePointerAccessor (&PhySimWifiPhy::m_state),
@@ -177,6 +216,10 @@ PhySimWifiPhy::GetTypeId (void)
     .AddTraceSource ("HeaderError",
                      "A signal header has not been decoded successfully.",
                      MakeTraceSourceAccessor (&PhySimWifiPhy::m_headerErrorTrace))
+    .AddTraceSource ("SymbolSinr",
+                     "The payload of a packet has been decoded and the SINR of each of its OFDM symbols is available in the tag. "
+                     "The last parameter indicates whether the payload has been decoded successfully. Requires CalculateSymbolSinr.",
+                     MakeTraceSourceAccessor (&PhySimWifiPhy::m_symbolSinrTrace))
     .AddTraceSource ("Tx", "Packet transmission is starting.",
                      MakeTraceSourceAccessor (&PhySimWifiPhy::m_txTrace))
     .AddTraceSource ("StartRx", "First signal of a packet has arrived at the receiving node and the signal strength is above energy detection threshold",
@@ -192,7 +235,12 @@ PhySimWifiPhy::GetTypeId (void)
 }
 
 PhySimWifiPhy::PhySimWifiPhy ()
-  : m_estimator (0)
+  : m_estimator (0),
+    m_lookupSuccesses (0),
+    m_lookupFailures (0),
+    m_fullDecodings (0),
+    m_signalCacheSize (64),
+    m_useTxPipeline (true)
 {
   NS_LOG_FUNCTION (this);
   m_random = CreateObject<UniformRandomVariable>();
@@ -224,6 +272,8 @@ PhySimWifiPhy::PhySimWifiPhy ()
   m_scrambler = CreateObject<PhySimScrambler> ();
   m_interference = CreateObject<PhySimInterferenceHelper> ();
   m_estimator = m_ofdmSymbolCreator->GetChannelEstimator ();
+  m_txPipeline = CreateObject<PhySimTxPipeline> ();
+  m_txPipeline->SetComponents (m_convEncoder, m_interleaver, m_ofdmSymbolCreator);
 }
 
 PhySimWifiPhy::~PhySimWifiPhy ()
@@ -253,6 +303,8 @@ PhySimWifiPhy::SetSymbolTime (Time duration)
   m_symbolTime = duration;
   m_sampleTime = 0.05e-6 * (duration.GetMicroSeconds () / 4);
   m_interference->SetSymbolTime (duration);
+  m_signalCache.clear ();
+  m_signalCacheOrder.clear ();
 }
 
 void
@@ -273,6 +325,13 @@ void
 PhySimWifiPhy::SetMobility (Ptr<Object> mobility)
 {
   m_mobility = mobility;
+
+  // Use the node id as the stream of the counter based background noise
+  Ptr<Node> node = mobility->GetObject<Node> ();
+  if (node != 0)
+    {
+      m_interference->SetNoiseStream (node->GetId ());
+    }
 }
 
 Ptr<Object>
@@ -461,6 +520,7 @@ PhySimWifiPhy::DoDispose (void)
   m_channel = 0;
   m_deviceRateSet.clear ();
   m_device = 0;
+  m_perTable = 0;
 }
 
 void
@@ -577,11 +637,30 @@ PhySimWifiPhy::ResetRNG ()
   m_rngReset = false;
 }
 
+void
+PhySimWifiPhy::ResetRNG (uint32_t seed)
+{
+  itpp::RNG_reset (seed);
+  m_rngReset = true;
+}
+
 void
 PhySimWifiPhy::ClearCache ()
 {
-  m_cachedPreamble.clear ();
-  m_cachedPreamble.set_size (0);
+  m_cachedPreambles.clear ();
+}
+
+bool
+PhySimWifiPhy::IsPreambleCached (Time symbolTime)
+{
+  std::map<int64_t, itpp::cvec>::const_iterator it = m_cachedPreambles.find (symbolTime.GetNanoSeconds ());
+  return (it != m_cachedPreambles.end () && it->second.size () >= 320);
+}
+
+bool
+PhySimWifiPhy::IsSignalFieldCached (uint32_t length, WifiMode mode) const
+{
+  return (m_signalCache.find (SignalCacheKey (mode.GetUid (), length)) != m_signalCache.end ());
 }
 
 void
@@ -601,33 +680,24 @@ PhySimWifiPhy::StartReceivePacket (Ptr<Packet> packet,
   double phaseFactor = 2.0 * M_PI * Df * m_sampleTime;
   NS_LOG_DEBUG ("PhySimWifiPhy:StartReceivePacket() - phaseFactor = " << phaseFactor);
 
-  // Received samples used to apply frequency offset error
-  itpp::cvec receivedSamples = tag->GetRxedSamples();
-
-  itpp::cvec oscillatedInput(receivedSamples.size());
+  // Received samples used to apply frequency offset error. Without an offset, the (possibly shared)
+  // samples of the tag are left untouched instead of storing an identical copy
   if (phaseFactor != 0)
     {
+      const itpp::cvec &receivedSamples = tag->PeekRxedSamples ();
+      itpp::cvec oscillatedInput(receivedSamples.size());
       for (int32_t i = 0; i < oscillatedInput.size(); ++i)
         {
           oscillatedInput(i) = receivedSamples(i) * std::complex<double>(cos(phaseFactor * (i + 1)), sin(phaseFactor * (i + 1)));
         }
-    }
-  else
-    {
-      oscillatedInput = receivedSamples;
-    }
-
-  //set what the receiver gets after applying oscillatory effects
-  tag->SetRxSamples(oscillatedInput);
 
-  // Apply rxAntennaGain
-  itpp::cvec rxedSamples = tag->GetRxedSamples ();
-  if (m_rxGainDb != 0)
-    {
-      rxedSamples *= sqrt (PhySimHelper::DbToRatio (m_rxGainDb));
+      //set what the receiver gets after applying oscillatory effects
+      tag->SetRxSamples(oscillatedInput);
     }
 
-  double rxPower = PhySimHelper::RatioToDb (PhySimHelper::GetOFDMSymbolSignalStrength (rxedSamples));
+  // Apply rxAntennaGain, directly in dB instead of scaling a copy of the received samples
+  const itpp::cvec &rxedSamples = tag->PeekRxedSamples ();
+  double rxPower = PhySimHelper::RatioToDb (PhySimHelper::GetOFDMSymbolSignalStrength (rxedSamples._data (), rxedSamples.size ())) + m_rxGainDb;
   NS_LOG_DEBUG ("PhySimWifiPhy:StartReceivePacket() " << Simulator::Now ().GetSeconds () << " sec - current state = " << m_state->GetState ());
   NS_LOG_DEBUG ("PhySimWifiPhy:StartReceivePacket() " << Simulator::Now ().GetSeconds () << " sec - rxedSamples.size() = " << rxedSamples.size ());
   NS_LOG_DEBUG ("PhySimWifiPhy:StartReceivePacket() " << Simulator::Now ().GetSeconds () << " sec - first OFDM symbol has signal strength of " << rxPower << " dBm");
@@ -737,6 +807,7 @@ PhySimWifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector,
                         enum WifiPreamble preamble, enum mpduType mpdutype)
 {
   uint8_t txPowerLevel = txVector.GetTxPowerLevel();
+  WifiMode mode = txVector.GetMode ();
   NS_LOG_FUNCTION (this << packet << preamble << (uint32_t) txPowerLevel);
   NS_LOG_DEBUG ("PhySimWifiPhy:SendPacket() " << Simulator::Now ());
   NS_LOG_DEBUG ("PhySimWifiPhy:SendPacket() current state = " << m_state->GetState ());
@@ -767,41 +838,46 @@ PhySimWifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector,
   // otherwise, we take the bits that are available via packet->PeekData ()
   uint32_t length = packet->GetSize ();
   uint32_t sSizeBefore = packet->GetSerializedSize();
-  uint8_t *payload = (uint8_t*) malloc (packet->GetSize ());
-  memset (payload, 0, packet->GetSize ());
-  packet->CopyData (payload, packet->GetSize ());
+  PhySimPackedBits payload;
+  payload.Resize (8 * length);
+  packet->CopyData (payload.GetBytes (), length);
   uint32_t sSizeAfter = packet->GetSerializedSize();
   itpp::bvec bits;
 
   if (sSizeBefore == sSizeAfter)
     { // if there is custom payload provided, we'll use it
-      for (uint32_t i = 0; i < length; i++)
-        {
-          uint8_t byte = payload[i];
-          bits.ins (bits.size (), PhySimHelper::DecToBin (byte, 8));
-        }
+      bits = payload.ToBvec ();
     }
   else
     { // else we create a random bit sequence
       bits = itpp::randb (length*8);
+      payload = PhySimPackedBits (bits);
     }
-  free (payload);
 
   NS_LOG_DEBUG ("PhySimWifiPhy:SendPacket() - packet->GetSize() = " << length << " bytes & bits.length() = " << bits.length ());
   NS_ASSERT (length >= 1 && length <= 4095); // MSPDU must adhere to these (Table 17-15 in Std.)
 
-  // use cached preamble if existing
-  if (m_cachedPreamble.size () < 320)
+  // use cached preamble of this symbol time if existing
+  itpp::cvec &cachedPreamble = m_cachedPreambles[m_symbolTime.GetNanoSeconds ()];
+  if (cachedPreamble.size () < 320)
     {
       NS_LOG_DEBUG ("PhySimWifiPhy:SendPacket() - constructing preamble");
-      m_cachedPreamble = ConstructPreamble ();
+      cachedPreamble = ConstructPreamble ();
     }
 
-  itpp::cvec c_header = ConstructSignalHeader (bits.length (), mode);
-  itpp::cvec c_data = ConstructData (bits, mode);
+  itpp::cvec c_header = GetSignalHeader (bits.length (), mode);
+  itpp::cvec c_data;
+  if (m_useTxPipeline)
+    {
+      c_data = m_txPipeline->ConstructData (payload, mode, m_scrambler->GetInitialState ());
+    }
+  else
+    {
+      c_data = ConstructData (payload, mode);
+    }
 
   // compose final result
-  itpp::cvec endresult = itpp::cvec (m_cachedPreamble);
+  itpp::cvec endresult = itpp::cvec (cachedPreamble);
   // add overlap of header with preamble
   endresult (endresult.size () - 1) += c_header (0);
   // add rest of header
@@ -842,14 +918,14 @@ PhySimWifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector,
   phyTag->SetTxParameters (preamble, mode, txDuration, bits, endresult, m_frequency, m_sampleTime, m_device->GetObject<NetDevice> ());
   phyTag->SetTxPower (txPowerDbm);
 
-  phyTag->SetRxSamples (endresult);
+  phyTag->SetRxSamplesToTxSamples ();
 
   m_txTrace (packet, phyTag);
   m_state->SwitchToTx (txDuration, packet, phyTag);
 
   NS_LOG_LOGIC ("PhySimWifiPhy:SendPacket() transmit packet " << packet->GetUid () << " with size of " << (8 * packet->GetSize ()) << " bits");
   NS_LOG_INFO ("PhySimWifiPhy:SendPacket() transmit duration: " << txDuration.GetMicroSeconds () << " microseconds");
-  NS_LOG_DEBUG ("PhySimWifiPhy:SendPacket() samples consist of " << phyTag->GetTxedSamples ().size () << " samples");
+  NS_LOG_DEBUG ("PhySimWifiPhy:SendPacket() samples consist of " << phyTag->PeekTxedSamples ().size () << " samples");
 
   m_channel->Send (this, packet, phyTag);
 }
@@ -906,7 +982,8 @@ PhySimWifiPhy::ConstructSignalHeader (uint32_t length, const WifiMode mode)
   PLCP_Header (17) = PhySimHelper::CalcEvenParity (PLCP_Header); // add parity bit
 
   // Do convolutional encoding
-  itpp::bvec encoded = m_convEncoder->Encode (PLCP_Header);
+  itpp::bvec encoded (m_convEncoder->GetEncodedSize (PLCP_Header.size ()));
+  m_convEncoder->Encode (PhySimPackedBits (PLCP_Header), encoded._data ());
 
   // Do interleaving
   m_interleaver->SetWifiMode (WifiPhy::GetOfdmRate6Mbps ());
@@ -923,39 +1000,60 @@ PhySimWifiPhy::ConstructSignalHeader (uint32_t length, const WifiMode mode)
 }
 
 itpp::cvec
-PhySimWifiPhy::ConstructData (const itpp::bvec& bits, const WifiMode mode)
+PhySimWifiPhy::GetSignalHeader (uint32_t length, const WifiMode mode)
 {
-  itpp::bvec serviceField (16);
-  serviceField.zeros (); // 16-bit all zero service field
-  itpp::bvec tailField (6);
-  tailField.zeros (); // 6-bit zero tail field
+  SignalCacheKey key (mode.GetUid (), length);
+  std::map<SignalCacheKey, itpp::cvec>::const_iterator it = m_signalCache.find (key);
+  if (it != m_signalCache.end ())
+    {
+      return it->second;
+    }
+
+  NS_LOG_DEBUG ("PhySimWifiPhy:GetSignalHeader() - constructing SIGNAL field for " << mode.GetUniqueName () << " and " << length << " bits");
+  itpp::cvec header = ConstructSignalHeader (length, mode);
+  if (m_signalCacheSize > 0)
+    {
+      // Evict the oldest entry if the cache is full
+      if (m_signalCache.size () >= m_signalCacheSize)
+        {
+          m_signalCache.erase (m_signalCacheOrder.front ());
+          m_signalCacheOrder.pop_front ();
+        }
+      m_signalCache[key] = header;
+      m_signalCacheOrder.push_back (key);
+    }
+  return header;
+}
 
+itpp::cvec
+PhySimWifiPhy::ConstructData (const PhySimPackedBits& psdu, const WifiMode mode)
+{
   // Calculate no. of symbols needed and creating padding
-  // Note that in the calculations below we use bits.length rather than 8 * length (in bytes)
+  // Note that in the calculations below we use psdu.GetNBits () rather than 8 * length (in bytes)
   uint32_t NDBPS = PhySimHelper::GetNDBPS (mode); // No. of data bits per symbol
-  uint32_t NSYM = ceil (static_cast<double> (16 + bits.length () + 6) / static_cast<double> (NDBPS)); // 17-11
+  uint32_t NSYM = ceil (static_cast<double> (16 + psdu.GetNBits () + 6) / static_cast<double> (NDBPS)); // 17-11
   uint32_t NDATA = NSYM * NDBPS; // 17-12 - length of data field
-  uint32_t NPAD = NDATA - (16 + bits.length () + 6); // no. of pad bits needed
 
-  // Create the data bits (SERVICE+PSDU+Tail+Pad)
-  itpp::bvec dataBits (NDATA);
-  dataBits.zeros ();
-  dataBits.replace_mid (0, serviceField); // 0..15 service field
-  dataBits.replace_mid (16, bits); // 16..16+bits.length()-1 the bits
-  dataBits.replace_mid (16 + bits.length (), tailField);
+  // Create the data bits (SERVICE+PSDU+Tail+Pad): the 16-bit all zero service field is byte aligned, so the
+  // PSDU bytes are copied as they are, and tail and pad bits are zero after the resize
+  PhySimPackedBits dataBits;
+  dataBits.Resize (NDATA);
+  std::copy (psdu.GetBytes (), psdu.GetBytes () + psdu.GetNBytes (), dataBits.GetBytes () + 2);
 
   // 17.3.5.4 apply PLCP scrambler
-  itpp::bvec scrambledDATA = m_scrambler->Scramble (dataBits);
+  PhySimPackedBits scrambledDATA = m_scrambler->Scramble (dataBits, m_scrambler->GetInitialState ());
 
   // 17.3.2.1 (f) After scrambling we have to reset the tail bits to 0
-  for (int i = 0; i < 6; ++i)
+  uint8_t *scrambledBytes = scrambledDATA.GetBytes ();
+  for (uint32_t i = 16 + psdu.GetNBits (); i < 16 + psdu.GetNBits () + 6; ++i)
     {
-      scrambledDATA (scrambledDATA.size () - 1 - NPAD - i) = 0;
+      scrambledBytes[i / 8] &= ~(1 << (i % 8));
     }
 
   // 17.3.5.5 Do convolutional encoding
   m_convEncoder->SetCodingRate (mode.GetCodeRate ());
-  itpp::bvec encodedScrambledDATA = m_convEncoder->Encode (scrambledDATA);
+  itpp::bvec encodedScrambledDATA (m_convEncoder->GetEncodedSize (NDATA));
+  m_convEncoder->Encode (scrambledDATA, encodedScrambledDATA._data ());
 
   // 17.3.5.6 Do interleaving and 17.3.5.7 - 17.3.5.9 OFDM
   // for each block -- return the result
@@ -1004,11 +1102,12 @@ PhySimWifiPhy::DeconstructData (Ptr<Packet> packet, Ptr<PhySimWifiPhyTag> tag)
 
   // Descramble
   itpp::bvec initialState = scrambledData (0, 6); // read the scrambling sequence from decoded DATA
-  itpp::bvec DATA = m_scrambler->DeScramble ( scrambledData ( 7, scrambledData.size () - 1 ), initialState );
+  PhySimPackedBits DATA = m_scrambler->DeScramble (PhySimPackedBits (scrambledData (7, scrambledData.size () - 1)), initialState);
 
-  // Calculate no. of symbols needed
-  uint32_t nDATA = numSymbols * ndbps; // Equation 17-12 - length of data field
-  itpp::bvec finalData = DATA (16, nDATA - padding - 6 - 1);
+  // The PSDU follows the 16-bit service field, i.e. it starts at the third byte
+  NS_ASSERT (DATA.GetNBits () >= 16 + length);
+  itpp::bvec finalData (length);
+  PhySimPackedBits::Unpack (DATA.GetBytes () + 2, length, finalData._data ());
 
   return finalData;
 }
@@ -1020,55 +1119,38 @@ PhySimWifiPhy::InterleaveAndModulate (const itpp::bvec &encodedScrambledData, co
   m_interleaver->SetWifiMode (mode);
   m_ofdmSymbolCreator->SetModulationType (PhySimHelper::GetModulationType (mode), mode.GetConstellationSize ());
 
-  int32_t startIndex = 0;
-  int32_t endIndex = NCBPS - 1;
-  int32_t blockIndex = 0;
-  itpp::cvec finalModulatedData;
-  itpp::cvec block;
+  uint32_t numSymbols = encodedScrambledData.size () / NCBPS;
+  NS_ASSERT (numSymbols > 0);
 
-  while ( endIndex < encodedScrambledData.size () )
+  // Interleave all blocks into one bit vector
+  itpp::bvec interleaved;
+  if (encodedScrambledData.size () == (int32_t)(numSymbols * NCBPS))
     {
-      blockIndex++; // Next block
-
-      // Interleave and modulate the block. Then apply the window function
-      block = InterleaveAndModulateBlock (encodedScrambledData (startIndex, endIndex), blockIndex);
-
-      // Need to add the first element of the actual OFDM time sample (not the prefix)
-      // at the end. This will be added as an overlap with the next time sample
-      std::complex<double> (lastelement) = block (16);
-      block.ins (block.size (), lastelement);
+      interleaved = m_interleaver->Interleave (encodedScrambledData);
+    }
+  else
+    {
+      interleaved = m_interleaver->Interleave (encodedScrambledData.left (numSymbols * NCBPS));
+    }
 
-      // Windowing function for block
-      PhySimHelper::WindowFunction (block);
+  // Modulate all OFDM symbols at once. The additional last sample is the first element of the actual
+  // OFDM time sample (not the prefix) of the last block, which overlaps with the next time sample.
+  const uint32_t sampleSize = 80;
+  itpp::cvec finalModulatedData (numSymbols * sampleSize + 1);
+  std::complex<double> *samples = finalModulatedData._data ();
+  m_ofdmSymbolCreator->ModulateSymbols (interleaved, 1, samples);
 
-      // Consider the block overlap
-      if (blockIndex == 1)
-        {       // First block just add...
-          finalModulatedData.ins (finalModulatedData.size (), block);
-        }
-      else
-        {
-          // Overlap block with Data
-          finalModulatedData (finalModulatedData.size () - 1) += block (0);
-          finalModulatedData.ins (finalModulatedData.size (), block (1, block.size () - 1));
-        }
-      startIndex += NCBPS;
-      endIndex += NCBPS;
+  // Windowing function for each block (17-5), where consecutive blocks overlap by one sample
+  samples[0] *= 0.5;
+  for (uint32_t i = 1; i < numSymbols; i++)
+    {
+      samples[i * sampleSize] = 0.5 * samples[(i - 1) * sampleSize + 16] + 0.5 * samples[i * sampleSize];
     }
+  samples[numSymbols * sampleSize] = 0.5 * samples[(numSymbols - 1) * sampleSize + 16];
 
   return finalModulatedData;
 }
 
-itpp::cvec
-PhySimWifiPhy::InterleaveAndModulateBlock (const itpp::bvec& input, const uint32_t index)
-{
-  NS_ASSERT ( index > 0 );
-  itpp::bvec interleaved = m_interleaver->InterleaveBlock (input);
-  itpp::cvec modulated = m_ofdmSymbolCreator->Modulate (interleaved, index);
-
-  return modulated;
-}
-
 itpp::vec
 PhySimWifiPhy::DeinterleaveAndModulate (const itpp::cvec &input, const WifiMode mode)
 {
@@ -1077,31 +1159,8 @@ PhySimWifiPhy::DeinterleaveAndModulate (const itpp::cvec &input, const WifiMode
   m_interleaver->SetWifiMode (mode);
   m_ofdmSymbolCreator->SetModulationType (PhySimHelper::GetModulationType (mode), mode.GetConstellationSize ());
 
-  // There are 80 time samples per OFDM symbol
-  const uint32_t sampleSize = 80;
-  int32_t startIndex = 0;
-  int32_t endIndex = sampleSize - 1;
-  int32_t blockIndex = 0;
-  itpp::vec finalDecodedData;
-  itpp::vec block;
-
-  while (endIndex < input.size ())
-    {
-      blockIndex++; // next block
-      block = DeinterleaveAndModulateBlock ( input (startIndex, endIndex), blockIndex );
-      finalDecodedData.ins ( finalDecodedData.size (), block );
-      startIndex += sampleSize;
-      endIndex += sampleSize;
-    }
-
-  return finalDecodedData;
-}
-
-itpp::vec
-PhySimWifiPhy::DeinterleaveAndModulateBlock (const itpp::cvec& input, uint32_t symbolNo)
-{
-  itpp::vec demodulated = m_ofdmSymbolCreator->DeModulate (input, symbolNo);
-  return m_interleaver->DeinterleaveBlock (demodulated);
+  // Demodulate all OFDM symbols at once, writing the (soft) bits directly to their deinterleaved positions
+  return m_ofdmSymbolCreator->DeModulateSymbols (input, 1, m_interleaver->GetDeinterleavingPositions ());
 }
 
 void
@@ -1322,37 +1381,75 @@ PhySimWifiPhy::EndRx (Ptr<Packet> packet, Ptr<PhySimWifiPhyTag> tag, Ptr<PhySimI
   // First make sure that this event is removed from the m_packets list
   m_packets.erase (event);
 
-  itpp::bvec finalData = DeconstructData (packet, tag);
-  tag->SetRxDataBits (finalData);
+  // Compute the SINR values of this frame, if needed either for the tag or for the SINR lookup. All
+  // are computed from a single pass over the frame.
+  PhySimInterferenceHelper::SinrValues sinrs;
+  if (m_useSinrLookup || m_calculatePayloadSinr || m_calculateOverallSinr || m_calculateSymbolSinr)
+    {
+      sinrs = m_interference->CalculateSinrs (event);
+    }
+
+  // Decide on the outcome of the reception. If the SINR lookup is enabled and the effective SINR is clearly
+  // above or below the decoding threshold, we skip the bit-level decoding chain
+  enum LookupDecision decision = LOOKUP_UNCERTAIN;
+  if (m_useSinrLookup)
+    {
+      decision = LookupPayloadOutcome (tag->GetRxWifiMode (), packet->GetSize (), sinrs.perSymbol);
+    }
+
+  itpp::bvec finalData;
+  bool success;
+  if (decision == LOOKUP_SUCCESS)
+    {
+      NS_LOG_DEBUG ("PhySimWifiPhy:EndRx() payload of packet " << packet->GetUid () << " decided successful by SINR lookup");
+      finalData = tag->PeekTxedDataBits ();
+      tag->SetRxDataBits (finalData);
+      success = true;
+      m_lookupSuccesses++;
+    }
+  else if (decision == LOOKUP_FAILURE)
+    {
+      // The bit errors themselves are not known, hence no received data bits are stored in the tag
+      NS_LOG_DEBUG ("PhySimWifiPhy:EndRx() payload of packet " << packet->GetUid () << " decided erroneous by SINR lookup");
+      success = false;
+      m_lookupFailures++;
+    }
+  else
+    {
+      finalData = DeconstructData (packet, tag);
+      tag->SetRxDataBits (finalData);
+      success = (finalData == tag->PeekTxedDataBits ());
+      m_fullDecodings++;
+    }
 
 #ifdef NS3_LOG_ENABLE
-  uint32_t bytes = finalData.size () / 8;
-  std::string rxPayload;
-  for (uint32_t i = 0; i < bytes; i++)
+  if (finalData.size () > 0)
     {
-      itpp::bvec extract = finalData ((i * 8), (i * 8) + 8 - 1);
-      const char c = itpp::bin2dec ( extract, false );
-      rxPayload.append (&c);
+      PhySimPackedBits rxBytes (finalData);
+      std::string rxPayload ((const char *) rxBytes.GetBytes (), finalData.size () / 8);
+      NS_LOG_INFO ("PhySimWifiPhy:EndRx() received " << finalData.size () << " data bits: " << finalData);
+      NS_LOG_INFO ("PhySimWifiPhy:EndRx() message:  " << rxPayload);
     }
-  NS_LOG_INFO ("PhySimWifiPhy:EndRx() received " << finalData.size () << " data bits: " << finalData);
-  NS_LOG_INFO ("PhySimWifiPhy:EndRx() message:  " << rxPayload);
 #endif
 
-  // Save information about the average SINR of the data part
+  // Save information about the average SINR of the data part, the overall average SINR
+  // and/or the per-symbol SINR of this frame.
   if (m_calculatePayloadSinr)
     {
-      double sinr = m_interference->CalculatePayloadSinr (event);
-      NS_LOG_DEBUG ("PhySimWifiPhy:EndRx() payload of packet " << packet->GetUid () << " has SINR of " << sinr);
-      tag->SetPayloadSinr (sinr);
+      NS_LOG_DEBUG ("PhySimWifiPhy:EndRx() payload of packet " << packet->GetUid () << " has SINR of " << sinrs.payload);
+      tag->SetPayloadSinr (sinrs.payload);
     }
-  // If we want to know the overall average SINR of this frame later
   if (m_calculateOverallSinr)
     {
-      double sinr = m_interference->CalculateOverallSinr (event);
-      tag->SetOverallSinr (sinr);
+      tag->SetOverallSinr (sinrs.overall);
+    }
+  if (m_calculateSymbolSinr)
+    {
+      tag->SetSymbolSinrs (sinrs.perSymbol);
+      m_symbolSinrTrace (packet, tag, success);
     }
 
-  if ( finalData == tag->GetTxedDataBits () )
+  if (success)
     {
       NS_LOG_LOGIC ("PhySimWifiPhy:EndRx() payload of packet " << packet->GetUid () << " decoded successfully");
       m_state->SwitchFromRxEndOk (packet, tag);
@@ -1375,6 +1472,97 @@ PhySimWifiPhy::EndRx (Ptr<Packet> packet, Ptr<PhySimWifiPhyTag> tag, Ptr<PhySimI
   CheckForNextCcaBusyStart ();
 }
 
+enum PhySimWifiPhy::LookupDecision
+PhySimWifiPhy::LookupPayloadOutcome (WifiMode mode, uint32_t length, const std::vector<double> &symbolSinrs)
+{
+  // The effective SINR is mapped onto the PER curve calibrated without fading
+  std::string name = mode.GetUniqueName ();
+  if (m_perTable == 0 || !m_perTable->HasCurve (name, PhySimPerTable::AWGN_PROFILE))
+    {
+      NS_LOG_DEBUG ("PhySimWifiPhy:LookupPayloadOutcome() no PER curve for mode " << name);
+      return LOOKUP_UNCERTAIN;
+    }
+  // The payload starts after the preamble (4 symbols) and the signal header (1 symbol)
+  if (symbolSinrs.size () <= 5)
+    {
+      return LOOKUP_UNCERTAIN;
+    }
+
+  // EESM calibration factors per modulation and coding rate, in the order of the rate field index, i.e.
+  // BPSK_1/2, BPSK_3/4, QPSK_1/2, QPSK_3/4, QAM16_1/2, QAM16_3/4, QAM64_2/3, QAM64_3/4
+  static const double betas[8] = { 0.8, 1.0, 1.6, 1.9, 4.5, 6.5, 16.0, 18.0 };
+  uint32_t index;
+  uint32_t constellation = mode.GetConstellationSize ();
+  bool highRate = (mode.GetCodeRate () == WIFI_CODE_RATE_3_4);
+  if (constellation == 2)
+    {
+      index = highRate ? 1 : 0;
+    }
+  else if (constellation == 4)
+    {
+      index = highRate ? 3 : 2;
+    }
+  else if (constellation == 16)
+    {
+      index = highRate ? 5 : 4;
+    }
+  else
+    {
+      index = highRate ? 7 : 6;
+    }
+  double beta = betas[index];
+  double sum = 0;
+  for (uint32_t i = 5; i < symbolSinrs.size (); i++)
+    {
+      sum += exp (-PhySimHelper::DbToRatio (symbolSinrs[i]) / beta);
+    }
+  double effective = PhySimHelper::RatioToDb (-beta * log (sum / (symbolSinrs.size () - 5)));
+
+  // Within the band around the SINR at which 10% of the frames are lost, the outcome is left to the decoder
+  double threshold = m_perTable->GetSnrForPer (name, length, PhySimPerTable::AWGN_PROFILE, 0.1);
+  NS_LOG_DEBUG ("PhySimWifiPhy:LookupPayloadOutcome() effective SINR = " << effective << " dB, threshold = " << threshold << " dB");
+  if (effective > threshold - m_sinrLookupBand && effective < threshold + m_sinrLookupBand)
+    {
+      return LOOKUP_UNCERTAIN;
+    }
+  double per = m_perTable->GetPer (name, length, PhySimPerTable::AWGN_PROFILE, effective);
+  if (m_random->GetValue () < per)
+    {
+      return LOOKUP_FAILURE;
+    }
+  return LOOKUP_SUCCESS;
+}
+
+uint64_t
+PhySimWifiPhy::GetNLookupSuccesses (void) const
+{
+  return m_lookupSuccesses;
+}
+
+uint64_t
+PhySimWifiPhy::GetNLookupFailures (void) const
+{
+  return m_lookupFailures;
+}
+
+uint64_t
+PhySimWifiPhy::GetNFullDecodings (void) const
+{
+  return m_fullDecodings;
+}
+
+double
+PhySimWifiPhy::GetEdThresholdDbm (void) const
+{
+  return m_edThresholdDbm;
+}
+
+double
+PhySimWifiPhy::GetRxGainDb (void) const
+{
+  return m_rxGainDb;
+}
+
 bool
 PhySimWifiPhy::ScanSignalField (Ptr<PhySimWifiPhyTag> tag, const itpp::cvec &input)
 {
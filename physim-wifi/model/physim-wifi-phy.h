@@ -44,12 +44,16 @@
 #include "physim-convolutional-encoder.h"
 #include "physim-blockinterleaver.h"
 #include "physim-scrambler.h"
+#include "physim-tx-pipeline.h"
 #include "physim-interference-helper.h"
 #include "physim-signal-detector.h"
 #include "physim-channel-estimator.h"
+#include "physim-per-table.h"
 #include "physim-wifi-phy-tag.h"
 
 #include <itpp/itcomm.h>
+#include <deque>
+#include <map>
 
 namespace ns3 {
 
@@ -284,11 +288,63 @@ public:
    */
   static void ResetRNG ();
   /**
-   * Resets all cached data structures, e.g. the once created time samples of the OFDM preamble
+   * Seeds the IT++ random number generator with the given seed right away, such that the next frame construction
+   * process does not reset it to the ns-3 seed again
+   * \param seed The seed for itpp::RNG_reset
+   */
+  static void ResetRNG (uint32_t seed);
+  /**
+   * Resets all cached data structures shared by all PHYs, e.g. the once created time samples of the OFDM preamble
+   * of each symbol time. The SIGNAL field cache of a PHY is reset whenever its symbol time changes.
    */
   static void ClearCache ();
+  /**
+   * Returns whether the time samples of the OFDM preamble for the given symbol time are cached (see ClearCache)
+   * \param symbolTime The OFDM symbol time, i.e. 4, 8 or 16 microseconds for 20, 10 or 5 MHz channels
+   */
+  static bool IsPreambleCached (Time symbolTime);
+  /**
+   * Returns whether the modulated SIGNAL field for the given length and mode is in the SIGNAL field cache of this
+   * PHY (attribute 'SignalCacheSize')
+   * \param length The length of the payload in bits
+   * \param mode   The WiFi mode of the payload
+   */
+  bool IsSignalFieldCached (uint32_t length, WifiMode mode) const;
+  /**
+   * Returns the number of frames whose payload was declared successfully received by the SINR lookup
+   * (attribute 'UseSinrLookup') without running the bit-level decoding chain.
+   */
+  uint64_t GetNLookupSuccesses (void) const;
+  /**
+   * Returns the number of frames whose payload was declared erroneous by the SINR lookup
+   * (attribute 'UseSinrLookup') without running the bit-level decoding chain.
+   */
+  uint64_t GetNLookupFailures (void) const;
+  /**
+   * Returns the number of frames whose payload was decoded with the full bit-level decoding chain.
+   */
+  uint64_t GetNFullDecodings (void) const;
+  /**
+   * Returns the energy detection threshold (attribute 'EnergyDetectionThreshold') in dBm, below which a
+   * frame is not considered at all
+   */
+  double GetEdThresholdDbm (void) const;
+  /**
+   * Returns the receive antenna gain (attribute 'RxGain') in dB
+   */
+  double GetRxGainDb (void) const;
 
 private:
+  /**
+   * Result of the SINR lookup for the payload of a frame
+   */
+  enum LookupDecision
+  {
+    LOOKUP_SUCCESS,
+    LOOKUP_FAILURE,
+    LOOKUP_UNCERTAIN
+  };
+
   PhySimWifiPhy (const PhySimWifiPhy &o);
   virtual void DoDispose (void);
   void Configure80211a (void);
@@ -329,14 +385,29 @@ private:
 
   itpp::cvec ConstructPreamble ();
   itpp::cvec ConstructSignalHeader (uint32_t length, const WifiMode mode);
-  itpp::cvec ConstructData (const itpp::bvec& bits, const WifiMode mode);
+  /**
+   * Returns the modulated SIGNAL field for the given length and mode from the SIGNAL field cache, constructing
+   * it through ConstructSignalHeader if it is not cached yet
+   */
+  itpp::cvec GetSignalHeader (uint32_t length, const WifiMode mode);
+  itpp::cvec ConstructData (const PhySimPackedBits& psdu, const WifiMode mode);
   itpp::bvec DeconstructData (Ptr<Packet> packet, Ptr<PhySimWifiPhyTag> tag);
   bool ScanSignalField (Ptr<PhySimWifiPhyTag> tag, const itpp::cvec &input);
+  /**
+   * Decides on the outcome of the payload reception by means of its effective SINR, which is obtained from the
+   * per-symbol SINR values by exponential effective SINR mapping (EESM). If the effective SINR is more than
+   * 'SinrLookupBand' dB above or below the decoding threshold of the given WiFi mode and length in the PER table
+   * (attribute 'PerTable'), the outcome is drawn with the PER of the effective SINR. Otherwise, or without a PER
+   * curve for the mode, the full bit-level decoding chain has to be executed.
+   * \param mode        The WiFi mode of the payload
+   * \param length      The length of the frame in bytes
+   * \param symbolSinrs The per-symbol SINR values (in dB) of the whole frame, including preamble and signal header
+   * \return            The decision of the lookup
+   */
+  enum LookupDecision LookupPayloadOutcome (WifiMode mode, uint32_t length, const std::vector<double> &symbolSinrs);
 
   itpp::cvec InterleaveAndModulate (const itpp::bvec &encodedScrambledData, const WifiMode mode);
-  itpp::cvec InterleaveAndModulateBlock (const itpp::bvec& input, const uint32_t index);
   itpp::vec DeinterleaveAndModulate (const itpp::cvec &input, const WifiMode mode);
-  itpp::vec DeinterleaveAndModulateBlock (const itpp::cvec& input, uint32_t symbolNo);
 
   void CancelAllRunningEndPreambleEvents (enum PhySimWifiPhy::ErrorReason reason);
   void CancelRunningEndHeaderEvent (enum PhySimWifiPhy::ErrorReason reason);
@@ -427,6 +498,7 @@ private:
   Ptr<PhySimConvolutionalEncoder> m_convEncoder;
   Ptr<PhySimBlockInterleaver> m_interleaver;
   Ptr<PhySimScrambler> m_scrambler;
+  Ptr<PhySimTxPipeline> m_txPipeline;
   Ptr<PhySimSignalDetector> m_signalDetector;
   Ptr<PhySimChannelEstimator> m_estimator;
 
@@ -437,6 +509,13 @@ private:
   bool m_calculateHeaderSinr;
   bool m_calculatePayloadSinr;
   bool m_calculateOverallSinr;
+  bool m_calculateSymbolSinr;
+  bool m_useSinrLookup;
+  double m_sinrLookupBand;
+  Ptr<PhySimPerTable> m_perTable;
+  uint64_t m_lookupSuccesses;
+  uint64_t m_lookupFailures;
+  uint64_t m_fullDecodings;
   Time m_symbolTime;
   uint32_t m_txCenterFreqTolerance;
   double m_sampleTime;
@@ -456,6 +535,9 @@ private:
   TracedCallback<Ptr<const Packet>, Ptr<const PhySimWifiPhyTag>, enum PhySimWifiPhy::ErrorReason > m_headerErrorTrace;
   TracedCallback<Ptr<const Packet>, Ptr<const PhySimWifiPhyTag>, enum PhySimWifiPhy::ErrorReason > m_rxErrorTrace;
 
+    // Trace to export the per-OFDM-symbol SINR of a frame at the end of the reception
+  TracedCallback<Ptr<const Packet>, Ptr<const PhySimWifiPhyTag>, bool> m_symbolSinrTrace;
+
     // Traces to signal the transmission of a new packet
   TracedCallback<Ptr<const Packet>, Ptr<const PhySimWifiPhyTag> > m_txTrace;
 
@@ -469,7 +551,17 @@ private:
     // to a single "reception" event
   std::map<Ptr<PhySimInterferenceHelper::Event>, Ptr<const Packet> > m_packets;
 
-  static itpp::cvec m_cachedPreamble;
+  // Time samples of the OFDM preamble, one per symbol time (in ns), i.e. per channel bandwidth
+  static std::map<int64_t, itpp::cvec> m_cachedPreambles;
+
+  // Modulated SIGNAL fields, keyed by (mode uid, length in bits), and their insertion order for eviction
+  typedef std::pair<uint32_t, uint32_t> SignalCacheKey;
+  std::map<SignalCacheKey, itpp::cvec> m_signalCache;
+  std::deque<SignalCacheKey> m_signalCacheOrder;
+  uint32_t m_signalCacheSize;
+
+  // Whether the DATA field is constructed by the streaming TX pipeline
+  bool m_useTxPipeline;
 
   // A random variable for frequency offset generation
   Ptr<RandomVariableStream> m_frequencyOffsetGenerator;
@@ -79,6 +79,37 @@ PhySimWifiConvolutionalTest::DoRun (void)
       NS_LOG_DEBUG ("PASS: Convolutional test for input as in standard annex G");
     }
   NS_TEST_EXPECT_MSG_EQ ( success, true, "Convolutional test failed as encoded bits do not match standard annex G");
+
+  // The table-driven encoder has to produce exactly the same output as IT++
+  uint32_t encoderLengths[] = { 24, 48, 72, 144, 216, 12000 };
+  for (int i = 0; i < 3; ++i)
+    {
+      for (int j = 0; j < 6; ++j)
+        {
+          success = RunTableEncoder (rate[i], encoderLengths[j]);
+          NS_TEST_EXPECT_MSG_EQ ( success, true, "Table-driven encoder differs from IT++ for " << description[i] << " (" << encoderLengths[j] << " bits)");
+        }
+    }
+
+  // With the default traceback depth (no window) the native Viterbi decoder has to produce exactly the same output
+  // as IT++, also for corrupted input. With a window of 35 steps it has to decode error-free input and lose no more
+  // than 1% of the bits against IT++ on moderately corrupted input.
+  uint32_t lengths[] = { 24, 144, 1530 };
+  for (int i = 0; i < 3; ++i)
+    {
+      for (int j = 0; j < 3; ++j)
+        {
+          for (int soft = 0; soft < 2; ++soft)
+            {
+              success = RunNativeViterbi (rate[i], soft, lengths[j], 0);
+              NS_TEST_EXPECT_MSG_EQ ( success, true, "Native Viterbi decoder differs from IT++ for " << description[i]
+                                                                                                    << (soft ? " (soft" : " (hard") << " decision, " << lengths[j] << " bits)");
+              success = RunNativeViterbi (rate[i], soft, lengths[j], 35);
+              NS_TEST_EXPECT_MSG_EQ ( success, true, "Windowed Viterbi decoder fails for " << description[i]
+                                                                                          << (soft ? " (soft" : " (hard") << " decision, " << lengths[j] << " bits)");
+            }
+        }
+    }
 }
 
 bool
@@ -106,5 +137,86 @@ PhySimWifiConvolutionalTest::RunAnnexG (void)
     "0 0 1 0 1 0 1 1 0 0 0 0 1 0 0 0 1 0 1 0 0 0 0 1 1 1 1 1 0 0 0 0 1 0 0 1 1 1 0 1 1 0 1 1 0 1 0 1 1 0 0 1 1 0 1 0 0 0 0 1 1 1 0 1 0 1 0 0 1 0 1 0 1 1 1 1 1 0 1 1 1 1 1 0 1 0 0 0 1 1 0 0 0 0 1 0 1 0 0 0 1 1 1 1 1 1 0 0 0 0 0 0 1 1 0 0 1 0 0 0 0 1 1 1 0 0 1 1 1 1 0 0 0 0 0 0 0 1 0 0 0 0 1 1 1 1 1 0 0 0 0 0 0 0 0 1 1 0 0 1 1 1 1 0 0 0 0 0 1 1 0 1 0 0 1 1 1 1 1 0 1 0 1 1 1 0 1 1 0 0 1 0";
   m_convolutional->SetCodingRate (WIFI_CODE_RATE_3_4);
   itpp::bvec encodedBits = m_convolutional->Encode (first144BitsAfterScrambling);
-  return (encodedBits == encoded192Bits);
+  itpp::bvec tableEncodedBits (m_convolutional->GetEncodedSize (first144BitsAfterScrambling.size ()));
+  m_convolutional->Encode (PhySimPackedBits (first144BitsAfterScrambling), tableEncodedBits._data ());
+  return (encodedBits == encoded192Bits) && (tableEncodedBits == encoded192Bits);
+}
+
+// Compare the table-driven encoder on packed bits against the IT++ encoder
+bool
+PhySimWifiConvolutionalTest::RunTableEncoder (WifiCodeRate rate, uint32_t numBits)
+{
+  itpp::bvec bits = itpp::randb (numBits);
+  m_convolutional->SetCodingRate (rate);
+  itpp::bvec expected = m_convolutional->Encode (bits);
+  itpp::bvec encodedBits (m_convolutional->GetEncodedSize (numBits));
+  uint32_t written = m_convolutional->Encode (PhySimPackedBits (bits), encodedBits._data ());
+  return (written == (uint32_t) encodedBits.size ()) && (encodedBits == expected);
+}
+
+// Compare the native Viterbi decoder against the IT++ decoder on noisy input. A depth of 0 keeps the default of the
+// encoder, which has to give identical output. A sliding traceback window has to decode error-free input and may
+// lose at most 1% of the bits against IT++ up to moderate corruption.
+bool
+PhySimWifiConvolutionalTest::RunNativeViterbi (WifiCodeRate rate, bool soft, uint32_t numBits, uint32_t depth)
+{
+  Ptr<PhySimConvolutionalEncoder> reference = CreateObject<PhySimConvolutionalEncoder> ();
+  Ptr<PhySimConvolutionalEncoder> native = CreateObject<PhySimConvolutionalEncoder> ();
+  reference->SetAttribute ("SoftViterbiDecision", BooleanValue (soft));
+  native->SetAttribute ("SoftViterbiDecision", BooleanValue (soft));
+  native->SetAttribute ("UseNativeViterbi", BooleanValue (true));
+  if (depth > 0)
+    {
+      native->SetAttribute ("ViterbiTracebackDepth", UintegerValue (depth));
+    }
+  reference->SetCodingRate (rate);
+  native->SetCodingRate (rate);
+
+  bool success = true;
+  uint32_t referenceErrors = 0;
+  uint32_t nativeErrors = 0;
+  for (uint32_t trial = 0; trial < 20; ++trial)
+    {
+      itpp::bvec bits = itpp::randb (numBits);
+      itpp::bvec encodedBits = reference->Encode (bits);
+      itpp::vec received (encodedBits.size ());
+      // Increase the amount of corruption with every trial, from error-free up to undecodable
+      double level = trial / 20.0;
+      for (int k = 0; k < encodedBits.size (); ++k)
+        {
+          if (soft)
+            {
+              received (k) = (encodedBits (k) == 1 ? -1.0 : 1.0) + 2 * level * itpp::randn ();
+            }
+          else
+            {
+              received (k) = (itpp::randu () < level / 4) ? 1 - encodedBits (k) : encodedBits (k);
+            }
+        }
+      itpp::bvec expected = reference->Decode (received);
+      itpp::bvec decoded = native->Decode (received);
+      if (depth == 0 && !(decoded == expected))
+        {
+          NS_LOG_DEBUG ("PhySimWifiConvolutionalTest:RunNativeViterbi() - mismatch in trial " << trial);
+          success = false;
+        }
+      if (depth > 0 && trial == 0 && !(decoded == bits))
+        {
+          NS_LOG_DEBUG ("PhySimWifiConvolutionalTest:RunNativeViterbi() - error-free input decoded wrongly with depth " << depth);
+          success = false;
+        }
+      // Compare the bit errors only up to moderate corruption, beyond that both decoders fail
+      for (uint32_t k = 0; trial < 6 && k < numBits; ++k)
+        {
+          referenceErrors += (expected (k) != bits (k));
+          nativeErrors += (decoded (k) != bits (k));
+        }
+    }
+  if (depth > 0 && nativeErrors > referenceErrors + 6 * numBits / 100)
+    {
+      NS_LOG_DEBUG ("PhySimWifiConvolutionalTest:RunNativeViterbi() - " << nativeErrors << " bit errors with depth " << depth
+                                                                        << ", IT++ has " << referenceErrors);
+      success = false;
+    }
+  return success;
 }
@@ -42,6 +42,8 @@ private:
   void DoRun (void);
   bool RunSingle (WifiCodeRate rate);
   bool RunAnnexG (void);
+  bool RunTableEncoder (WifiCodeRate rate, uint32_t numBits);
+  bool RunNativeViterbi (WifiCodeRate rate, bool soft, uint32_t numBits, uint32_t depth);
   Ptr<PhySimConvolutionalEncoder> m_convolutional;
 };
 
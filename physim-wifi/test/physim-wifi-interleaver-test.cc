@@ -67,6 +67,13 @@ PhySimWifiInterleaverTest::DoRun (void)
         }
       NS_TEST_EXPECT_MSG_EQ ( success, true, "Interlever test failed for " << modes[i] << " : Input bits before interleaving and output bits after de-interleavind do not match");
     }
+
+  // Whole frames have to give the same result as block by block processing
+  for (int i = 0; i < 8; ++i)
+    {
+      success = RunFrame (modes[i]);
+      NS_TEST_EXPECT_MSG_EQ ( success, true, "Frame interleaver test failed for " << modes[i] << " : (De-)interleaving of whole frames does not match (de-)interleaving of single blocks");
+    }
 }
 
 bool
@@ -81,3 +88,41 @@ PhySimWifiInterleaverTest::RunSingle (std::string wifiMode)
   itpp::bvec deinterleavedBits = itpp::to_bvec (m_interleaver.DeinterleaveBlock (itpp::to_vec (interleavedBits)));
   return (deinterleavedBits == bits);
 }
+
+bool
+PhySimWifiInterleaverTest::RunFrame (std::string wifiMode)
+{
+  WifiMode mode = wifiMode;
+  uint32_t NCBPS = PhySimHelper::GetNCBPS (mode);
+  const uint32_t numBlocks = 25;
+  itpp::bvec bits = itpp::randb (numBlocks * NCBPS);
+  itpp::vec softBits = itpp::randn (numBlocks * NCBPS);
+  m_interleaver.SetWifiMode (mode);
+
+  itpp::bvec interleaved = m_interleaver.Interleave (bits);
+  itpp::vec deinterleaved = m_interleaver.Deinterleave (softBits);
+  const uint16_t *positions = m_interleaver.GetDeinterleavingPositions ();
+  for (uint32_t block = 0; block < numBlocks; block++)
+    {
+      if (!(interleaved.mid (block * NCBPS, NCBPS) == m_interleaver.InterleaveBlock (bits.mid (block * NCBPS, NCBPS))))
+        {
+          NS_LOG_DEBUG ("FAIL: Frame interleaving differs in block " << block << " for " << wifiMode);
+          return false;
+        }
+      if (!(deinterleaved.mid (block * NCBPS, NCBPS) == m_interleaver.DeinterleaveBlock (softBits.mid (block * NCBPS, NCBPS))))
+        {
+          NS_LOG_DEBUG ("FAIL: Frame deinterleaving differs in block " << block << " for " << wifiMode);
+          return false;
+        }
+      for (uint32_t k = 0; k < NCBPS; k++)
+        {
+          if (deinterleaved (block * NCBPS + positions[k]) != softBits (block * NCBPS + k))
+            {
+              NS_LOG_DEBUG ("FAIL: Deinterleaving positions differ in block " << block << " for " << wifiMode);
+              return false;
+            }
+        }
+    }
+  NS_LOG_DEBUG ("PASS: Frame interleaver test for " << wifiMode);
+  return true;
+}
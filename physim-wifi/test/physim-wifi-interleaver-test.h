@@ -41,6 +41,7 @@ public:
 private:
   void DoRun (void);
   bool RunSingle (std::string wifiMode);
+  bool RunFrame (std::string wifiMode);
 
   PhySimBlockInterleaver m_interleaver;
 };
@@ -0,0 +1,127 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-preamble.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/double.h"
+#include "ns3/physim-wifi-channel.h"
+#include "ns3/physim-propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "physim-wifi-manual-channel-test.h"
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhySimWifiManualChannelTest");
+
+PhySimWifiManualChannelTest::PhySimWifiManualChannelTest ()
+  : TestCase ("PhySim WiFi manual channel test case")
+{
+}
+
+PhySimWifiManualChannelTest::~PhySimWifiManualChannelTest ()
+{
+}
+
+void
+PhySimWifiManualChannelTest::DoRun (void)
+{
+  PhySimWifiPhy::ClearCache ();
+  PhySimWifiPhy::ResetRNG ();
+
+  Ptr<PhySimWifiManualChannel> channel = CreateObject<PhySimWifiManualChannel> ();
+  Ptr<PhySimConstantPropagationLoss> defaultLoss = CreateObject<PhySimConstantPropagationLoss> ();
+  defaultLoss->SetAttribute ("PathLoss", DoubleValue (50.0));
+  channel->SetPropagationLossModel (defaultLoss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  Ptr<PhySimWifiPhy> phy0 = CreatePhy (channel, 0);
+  Ptr<PhySimWifiPhy> phy1 = CreatePhy (channel, 1);
+  Ptr<PhySimWifiPhy> phy2 = CreatePhy (channel, 2);
+  uint32_t id0 = phy0->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
+  uint32_t id1 = phy1->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
+
+  // Only the link from node 0 to node 1 has explicit models
+  Ptr<PhySimConstantPropagationLoss> explicitLoss = CreateObject<PhySimConstantPropagationLoss> ();
+  explicitLoss->SetAttribute ("PathLoss", DoubleValue (30.0));
+  channel->SetExplicitPropagationLossModel (id0, id1, explicitLoss);
+  Ptr<ConstantSpeedPropagationDelayModel> explicitDelay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  explicitDelay->SetAttribute ("Speed", DoubleValue (1e6)); // 10 ms for the 10000 m between node 0 and 1
+  channel->SetExplicitPropagationDelayModel (id0, id1, explicitDelay);
+
+  Simulator::Schedule (MilliSeconds (1), &PhySimWifiManualChannelTest::Send, this, phy0);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_pathLoss["1"], 30.0, 1e-9, "Explicit loss model has not been applied to link 0->1");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_pathLoss["2"], 50.0, 1e-9, "Default loss model has not been applied to link 0->2");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTime["1"], MilliSeconds (1) + MilliSeconds (10), "Explicit delay model has not been applied to link 0->1");
+
+  // The reverse link uses the default models, also for a PHY that is added after the first transmission
+  m_pathLoss.clear ();
+  Ptr<PhySimWifiPhy> phy3 = CreatePhy (channel, 3);
+  Simulator::Schedule (MilliSeconds (1), &PhySimWifiManualChannelTest::Send, this, phy1);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_pathLoss.size (), 3, "Frame has not been delivered to all other PHYs");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_pathLoss["0"], 50.0, 1e-9, "Default loss model has not been applied to link 1->0");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_pathLoss["3"], 50.0, 1e-9, "Default loss model has not been applied to link 1->3");
+
+  Simulator::Destroy ();
+}
+
+Ptr<PhySimWifiPhy>
+PhySimWifiManualChannelTest::CreatePhy (Ptr<PhySimWifiChannel> channel, uint32_t index)
+{
+  Ptr<PhySimWifiPhy> phy = CreateObject<PhySimWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211p_CCH);
+  phy->SetChannel (channel);
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+  device->SetNode (node);
+  Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (Vector (10000.0 * index, 0.0, 0.0));
+  node->AggregateObject (mobility);
+  phy->SetMobility (node);
+  phy->SetDevice (device);
+
+  std::ostringstream context;
+  context << index;
+  phy->TraceConnect ("StartRx", context.str (), MakeCallback (&PhySimWifiManualChannelTest::StartRx, this));
+  return phy;
+}
+
+void
+PhySimWifiManualChannelTest::Send (Ptr<PhySimWifiPhy> phy)
+{
+  phy->SendPacket (Create<Packet> (100), WifiMode ("OfdmRate6MbpsBW10MHz"), WIFI_PREAMBLE_LONG, 1);
+}
+
+void
+PhySimWifiManualChannelTest::StartRx (std::string context, Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag)
+{
+  m_pathLoss[context] = tag->GetPathLoss ();
+  m_rxTime[context] = Simulator::Now ();
+}
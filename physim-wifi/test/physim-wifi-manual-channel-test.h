@@ -0,0 +1,57 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#ifndef PHYSIM_WIFI_MANUAL_CHANNEL_TEST_H_
+#define PHYSIM_WIFI_MANUAL_CHANNEL_TEST_H_
+
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/physim-wifi-phy-tag.h"
+#include "ns3/physim-wifi-phy.h"
+#include <map>
+#include <string>
+
+using namespace ns3;
+
+/**
+ * Test case to verify that PhySimWifiManualChannel applies the explicitly configured propagation loss and delay
+ * models only to the configured (directed) links and the default models to all other links, also if PHYs are
+ * added after the first transmission.
+ */
+class PhySimWifiManualChannelTest : public ns3::TestCase
+{
+public:
+  PhySimWifiManualChannelTest ();
+  virtual ~PhySimWifiManualChannelTest ();
+
+private:
+  void DoRun (void);
+  Ptr<PhySimWifiPhy> CreatePhy (Ptr<PhySimWifiChannel> channel, uint32_t index);
+  void Send (Ptr<PhySimWifiPhy> phy);
+  void StartRx (std::string context, Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag);
+
+  std::map<std::string, double> m_pathLoss;
+  std::map<std::string, Time> m_rxTime;
+};
+
+#endif /* PHYSIM_WIFI_MANUAL_CHANNEL_TEST_H_ */
@@ -58,24 +58,28 @@ PhySimWifiModulatorTest::DoRun (void)
   uint16_t  blockSize = 48;
   std::string description = "BPSK";
   RunSingle (modulation, constellation, blockSize, description);
+  RunBatched (modulation, constellation, blockSize, description);
 
   modulation = PhySimHelper::QPSK;
   constellation = 4;
   blockSize = 96;
   description = "QPSK";
   RunSingle (modulation, constellation, blockSize, description);
+  RunBatched (modulation, constellation, blockSize, description);
 
   modulation = PhySimHelper::QAM16;
   constellation = 16;
   blockSize = 192;
   description = "QAM-16";
   RunSingle (modulation, constellation, blockSize, description);
+  RunBatched (modulation, constellation, blockSize, description);
 
   modulation = PhySimHelper::QAM64;
   constellation = 64;
   blockSize = 288;
   description = "QAM-64";
   RunSingle (modulation, constellation, blockSize, description);
+  RunBatched (modulation, constellation, blockSize, description);
 }
 
 bool
@@ -98,3 +102,40 @@ PhySimWifiModulatorTest::RunSingle (PhySimHelper::ModulationType modulation,uint
   NS_TEST_EXPECT_MSG_EQ (success, true, "Modulation test failed for " << description);
   return success;
 }
+
+// Verify that the batched modulation of several OFDM symbols matches the symbol-wise modulation
+bool
+PhySimWifiModulatorTest::RunBatched (PhySimHelper::ModulationType modulation,uint8_t constellation, uint16_t blockSize, std::string description)
+{
+  // more symbols than the length of the pilot polarity sequence
+  const uint32_t numSymbols = 130;
+  itpp::bvec bits = itpp::randb (numSymbols * blockSize);
+  m_symbolcreator->SetModulationType (modulation,constellation);
+  itpp::cvec batched (numSymbols * 80);
+  uint32_t modulatedSymbols = m_symbolcreator->ModulateSymbols (bits, 1, batched._data ());
+  bool success = (modulatedSymbols == numSymbols);
+  for (uint32_t i = 0; i < numSymbols && success; i++)
+    {
+      itpp::cvec single = m_symbolcreator->Modulate (bits.mid (i * blockSize, blockSize), i + 1);
+      success = (itpp::max (itpp::abs (single - batched.mid (i * 80, 80))) < 1e-12);
+    }
+  NS_TEST_EXPECT_MSG_EQ (success, true, "Batched modulation differs from symbol-wise modulation for " << description);
+
+  // Batched demodulation has to match symbol-wise demodulation, with and without pilot-based correction
+  std::string estimators[] = { "ns3::PhySimChannelEstimator", "ns3::PhySimSimpleChannelEstimator", "ns3::PhySimChannelFrequencyOffsetEstimator" };
+  for (uint32_t e = 0; e < 3; e++)
+    {
+      m_symbolcreator->SetChannelEstimator (estimators[e]);
+      itpp::vec expected;
+      for (uint32_t i = 0; i < numSymbols; i++)
+        {
+          expected.ins (expected.size (), m_symbolcreator->DeModulate (batched.mid (i * 80, 80), i + 1));
+        }
+      itpp::vec demodulated = m_symbolcreator->DeModulateSymbols (batched, 1);
+      bool demodulationSuccess = (demodulated == expected) && (to_bvec (demodulated) == bits);
+      NS_TEST_EXPECT_MSG_EQ (demodulationSuccess, true, "Batched demodulation differs from symbol-wise demodulation for " << description << " using " << estimators[e]);
+      success = success && demodulationSuccess;
+    }
+  m_symbolcreator->SetChannelEstimator ("ns3::PhySimChannelEstimator");
+  return success;
+}
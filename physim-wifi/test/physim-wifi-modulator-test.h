@@ -42,6 +42,7 @@ public:
 private:
   void DoRun (void);
   bool RunSingle (PhySimHelper::ModulationType modulation,uint8_t constellation, uint16_t blockSize, std::string description);
+  bool RunBatched (PhySimHelper::ModulationType modulation,uint8_t constellation, uint16_t blockSize, std::string description);
   Ptr<PhySimOFDMSymbolCreator> m_symbolcreator;
 };
 
@@ -19,9 +19,14 @@
  */
 
 #include "ns3/physim-interference-helper.h"
+#include "ns3/physim-wifi-phy-tag.h"
+#include "ns3/wifi-phy.h"
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/random-variable.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
 #include "physim-wifi-noise-chunk-test.h"
 #include <itpp/itcomm.h>
 
@@ -142,4 +147,112 @@ PhySimWifiNoiseChunkTest::DoRun (void)
       NS_LOG_DEBUG ("PASS: Case 5b, multiple overlapping noise requests are not matching in their overlap area");
     }
   NS_TEST_EXPECT_MSG_EQ ( (noise2 == noise1.get (2,10)), true, "Case 5b: multiple overlapping noise requests are not matching in their overlap area");
+
+  // Test case 6: counter based noise has to be identical for the same sample index, independent of the order
+  // of the requests and of the instance, but has to differ between noise streams
+  Ptr<PhySimInterferenceHelper> m_counterA = CreateObject<PhySimInterferenceHelper> ();
+  Ptr<PhySimInterferenceHelper> m_counterB = CreateObject<PhySimInterferenceHelper> ();
+  m_counterA->SetAttribute ("CounterBasedNoise", BooleanValue (true));
+  m_counterB->SetAttribute ("CounterBasedNoise", BooleanValue (true));
+  // instance A: first (1150ns - 1550ns), then (1300ns - 1400ns)
+  noise1 = m_counterA->GetBackgroundNoise (NanoSeconds (1150), NanoSeconds (1550));
+  chunk1 = m_counterA->GetBackgroundNoise (NanoSeconds (1300), NanoSeconds (1400));
+  // instance B: the other way round
+  chunk2 = m_counterB->GetBackgroundNoise (NanoSeconds (1300), NanoSeconds (1400));
+  noise2 = m_counterB->GetBackgroundNoise (NanoSeconds (1150), NanoSeconds (1550));
+  final = (noise1.get (3,4) == chunk1) && (chunk1 == chunk2) && (noise1 == noise2);
+  if (!final)
+    {
+      NS_LOG_DEBUG ("FAIL: Case 6, counter based noise is not reproducible");
+    }
+  else
+    {
+      NS_LOG_DEBUG ("PASS: Case 6, counter based noise is reproducible");
+    }
+  NS_TEST_EXPECT_MSG_EQ ( final, true, "Case 6: counter based noise is not reproducible");
+
+  m_counterB->SetNoiseStream (1);
+  noise2 = m_counterB->GetBackgroundNoise (NanoSeconds (1150), NanoSeconds (1550));
+  NS_TEST_EXPECT_MSG_EQ ( (noise1 != noise2), true, "Case 6: counter based noise of different streams is identical");
+
+  // The power of the generated noise has to match the noise floor (-99 dBm by default)
+  noise1 = m_counterA->GetBackgroundNoise (MicroSeconds (0), MicroSeconds (4000));
+  double power = 10.0 * log10 (itpp::sum (itpp::sqr (noise1)) / noise1.size ());
+  NS_LOG_DEBUG ("Case 6: power of counter based noise = " << power << " dBm");
+  NS_TEST_EXPECT_MSG_EQ_TOL (power, m_counterA->GetNoiseFloorDbm (), 0.1, "Case 6: counter based noise does not match the noise floor");
+
+  // Test case 7: the energy timeline has to give the same CCA answers as the sample based computation while
+  // frames are added and expire. Frame 1 starts at 0us with 3 symbols at -70 dBm followed by 7 symbols at -50 dBm,
+  // frame 2 starts at 40us with 8 symbols at -50 dBm and ends at 104us.
+  m_samplesHelper = CreateObject<PhySimInterferenceHelper> ();
+  m_timelineHelper = CreateObject<PhySimInterferenceHelper> ();
+  m_timelineHelper->SetAttribute ("UseEnergyTimeline", BooleanValue (true));
+  Simulator::Schedule (MicroSeconds (0), &PhySimWifiNoiseChunkTest::AddFrame, this, -70.0, 3, -50.0, 7);
+  Simulator::Schedule (MicroSeconds (0), &PhySimWifiNoiseChunkTest::CheckEnergyQueries, this, -62.0, true, MicroSeconds (24), MicroSeconds (8));
+  Simulator::Schedule (MicroSeconds (0), &PhySimWifiNoiseChunkTest::CheckEnergyQueries, this, -75.0, true, MicroSeconds (0), MicroSeconds (80));
+  Simulator::Schedule (MicroSeconds (0), &PhySimWifiNoiseChunkTest::CheckEnergyQueries, this, -40.0, false, MicroSeconds (0), MicroSeconds (8));
+  Simulator::Schedule (MicroSeconds (40), &PhySimWifiNoiseChunkTest::AddFrame, this, -50.0, 0, -50.0, 8);
+  Simulator::Schedule (MicroSeconds (40), &PhySimWifiNoiseChunkTest::CheckEnergyQueries, this, -62.0, true, MicroSeconds (0), MicroSeconds (64));
+  Simulator::Schedule (MicroSeconds (120), &PhySimWifiNoiseChunkTest::CheckEnergyQueries, this, -62.0, false, MicroSeconds (0), MicroSeconds (0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_samplesHelper = 0;
+  m_timelineHelper = 0;
+
+  // Test case 8: the single pass SINR computation has to match the individual SINR methods for a frame
+  // of 5 symbols that is overlapped by a constant power frame of -50 dBm
+  Ptr<PhySimInterferenceHelper> helper = CreateObject<PhySimInterferenceHelper> ();
+  Ptr<PhySimWifiPhyTag> tag = Create<PhySimWifiPhyTag> ();
+  itpp::cvec samples (801);
+  samples = std::complex<double> (sqrt (1e-5), 0.0);
+  tag->SetTxParameters (WIFI_PREAMBLE_LONG, WifiPhy::GetOfdmRate6Mbps (), MicroSeconds (40), itpp::bvec (), samples, 5.2e9, 5e-8, 0);
+  tag->SetRxSamples (samples);
+  helper->Add (Create<Packet> (), tag);
+  Ptr<PhySimWifiPhyTag> interferer = Create<PhySimWifiPhyTag> ();
+  samples = 1e-3 * itpp::randn_c (801);
+  interferer->SetTxParameters (WIFI_PREAMBLE_LONG, WifiPhy::GetOfdmRate6Mbps (), MicroSeconds (40), itpp::bvec (), samples, 5.2e9, 5e-8, 0);
+  interferer->SetRxSamples (samples);
+  Ptr<PhySimInterferenceHelper::Event> event = helper->Add (Create<Packet> (), interferer);
+  PhySimInterferenceHelper::SinrValues sinrs = helper->CalculateSinrs (event);
+  NS_TEST_EXPECT_MSG_EQ_TOL (sinrs.preamble, helper->CalculatePreambleSinr (event), 1e-9, "Case 8: single pass preamble SINR differs");
+  NS_TEST_EXPECT_MSG_EQ_TOL (sinrs.header, helper->CalculateHeaderSinr (event), 1e-9, "Case 8: single pass header SINR differs");
+  NS_TEST_EXPECT_MSG_EQ_TOL (sinrs.payload, helper->CalculatePayloadSinr (event), 1e-9, "Case 8: single pass payload SINR differs");
+  NS_TEST_EXPECT_MSG_EQ_TOL (sinrs.overall, helper->CalculateOverallSinr (event), 1e-9, "Case 8: single pass overall SINR differs");
+  NS_TEST_EXPECT_MSG_EQ (sinrs.perSymbol.size (), 10, "Case 8: wrong number of per-symbol SINR values");
+}
+
+void
+PhySimWifiNoiseChunkTest::AddFrame (double lowPowerDbm, uint32_t lowSymbols, double powerDbm, uint32_t symbols)
+{
+  // A frame with a constant power per symbol, 80 samples per symbol
+  uint32_t numSymbols = lowSymbols + symbols;
+  itpp::cvec samples (80 * numSymbols);
+  for (int32_t k = 0; k < samples.size (); k++)
+    {
+      double power = (k < (int32_t) (80 * lowSymbols)) ? lowPowerDbm : powerDbm;
+      samples (k) = std::complex<double> (sqrt (pow (10.0, power / 10.0)), 0.0);
+    }
+  Ptr<PhySimWifiPhyTag> tag = Create<PhySimWifiPhyTag> ();
+  tag->SetTxParameters (WIFI_PREAMBLE_LONG, WifiPhy::GetOfdmRate6Mbps (), MicroSeconds (8 * numSymbols), itpp::bvec (), samples, 5.2e9, 5e-8, 0);
+  tag->SetRxSamples (samples);
+  m_samplesHelper->Add (Create<Packet> (), tag);
+  m_timelineHelper->Add (Create<Packet> (), tag);
+}
+
+void
+PhySimWifiNoiseChunkTest::CheckEnergyQueries (double threshold, bool busy, Time reached, Time duration)
+{
+  Ptr<PhySimInterferenceHelper> helpers[] = { m_samplesHelper, m_timelineHelper };
+  std::string description[] = { "samples", "energy timeline" };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Time reachedAfter;
+      bool busyReached = helpers[i]->IsEnergyReached (threshold, reachedAfter);
+      Time busyDuration = helpers[i]->GetEnergyDuration (threshold);
+      NS_LOG_DEBUG ("Case 7: " << description[i] << " at " << Simulator::Now () << " for " << threshold << " dBm: reached = " << busyReached
+                                << " after " << reachedAfter << ", duration = " << busyDuration);
+      NS_TEST_EXPECT_MSG_EQ (busyReached, busy, "Case 7: wrong IsEnergyReached answer from the " << description[i] << " at " << Simulator::Now () << " for " << threshold << " dBm");
+      NS_TEST_EXPECT_MSG_EQ (reachedAfter, reached, "Case 7: wrong time until " << threshold << " dBm are reached from the " << description[i] << " at " << Simulator::Now ());
+      NS_TEST_EXPECT_MSG_EQ (busyDuration, duration, "Case 7: wrong energy duration from the " << description[i] << " at " << Simulator::Now () << " for " << threshold << " dBm");
+    }
 }
@@ -22,6 +22,9 @@
 #define PHYSIM_WIFI_NOISE_CHUNK_TEST_H
 
 #include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/physim-interference-helper.h"
 
 using namespace ns3;
 
@@ -39,6 +42,11 @@ public:
 
 private:
   void DoRun (void);
+  void AddFrame (double lowPowerDbm, uint32_t lowSymbols, double powerDbm, uint32_t symbols);
+  void CheckEnergyQueries (double threshold, bool busy, Time reached, Time duration);
+
+  Ptr<PhySimInterferenceHelper> m_samplesHelper;
+  Ptr<PhySimInterferenceHelper> m_timelineHelper;
 
 };
 
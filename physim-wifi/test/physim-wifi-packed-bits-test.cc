@@ -0,0 +1,99 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include <itpp/itcomm.h>
+#include "ns3/log.h"
+#include "ns3/physim-helper.h"
+#include "physim-wifi-packed-bits-test.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhySimWifiPackedBitsTest");
+
+PhySimWifiPackedBitsTest::PhySimWifiPackedBitsTest ()
+  : TestCase ("PhySim WiFi packed bits test case")
+{
+}
+
+PhySimWifiPackedBitsTest::~PhySimWifiPackedBitsTest ()
+{
+}
+
+void
+PhySimWifiPackedBitsTest::DoRun (void)
+{
+  uint32_t lengths[4] = { 1, 17, 100, 1500 };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      bool success = RunSingle (lengths[i]);
+      if (!success)
+        {
+          NS_LOG_DEBUG ("FAIL: Packed bits test for " << lengths[i] << " bytes");
+        }
+      else
+        {
+          NS_LOG_DEBUG ("PASS: Packed bits test for " << lengths[i] << " bytes");
+        }
+      NS_TEST_EXPECT_MSG_EQ ( success, true, "Packed bits test failed for " << lengths[i] << " bytes: conversion does not match the byte-wise reference");
+    }
+
+  // Bit sequences that are not a multiple of 8 bits long
+  itpp::bvec bits = itpp::randb (61);
+  PhySimPackedBits packed (bits);
+  NS_TEST_EXPECT_MSG_EQ (packed.GetNBytes (), (uint32_t) 8, "Unexpected number of bytes for 61 bits");
+  NS_TEST_EXPECT_MSG_EQ ( (packed.ToBvec () == bits), true, "Packing and unpacking of 61 bits does not restore the bit vector");
+  NS_TEST_EXPECT_MSG_EQ ( (packed.GetBytes ()[7] >> 5), 0, "Unused bits of the last byte are not zero");
+}
+
+bool
+PhySimWifiPackedBitsTest::RunSingle (uint32_t numBytes)
+{
+  // Reference: the byte-wise conversion that PhySimWifiPhy used before
+  itpp::bvec reference;
+  std::vector<uint8_t> bytes (numBytes);
+  for (uint32_t i = 0; i < numBytes; i++)
+    {
+      bytes[i] = itpp::randi (0, 255);
+      reference.ins (reference.size (), PhySimHelper::DecToBin (bytes[i], 8));
+    }
+
+  PhySimPackedBits packed (&bytes[0], numBytes);
+  if (!(packed.ToBvec () == reference))
+    {
+      return false;
+    }
+
+  PhySimPackedBits repacked (reference);
+  for (uint32_t i = 0; i < numBytes; i++)
+    {
+      itpp::bvec extract = reference ((i * 8), (i * 8) + 8 - 1);
+      if (repacked.GetBytes ()[i] != itpp::bin2dec ( extract, false ))
+        {
+          return false;
+        }
+      if (packed.GetBit (8 * i + 3) != (bool) reference (8 * i + 3))
+        {
+          return false;
+        }
+    }
+  return true;
+}
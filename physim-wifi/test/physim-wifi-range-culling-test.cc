@@ -0,0 +1,160 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-preamble.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/physim-wifi-phy.h"
+#include "ns3/physim-wifi-channel.h"
+#include "ns3/physim-propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "physim-wifi-range-culling-test.h"
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhySimWifiRangeCullingTest");
+
+PhySimWifiRangeCullingTest::PhySimWifiRangeCullingTest ()
+  : TestCase ("PhySim WiFi range culling test case")
+{
+}
+
+PhySimWifiRangeCullingTest::~PhySimWifiRangeCullingTest ()
+{
+}
+
+void
+PhySimWifiRangeCullingTest::DoRun (void)
+{
+  uint64_t culled, delivered;
+  Run (false, culled, delivered);
+  std::map<std::string, uint32_t> startRx = m_startRx;
+  std::map<std::string, uint32_t> energyDetectionFailed = m_energyDetectionFailed;
+  NS_TEST_EXPECT_MSG_EQ (culled, 0, "Receivers have been culled although range culling is disabled");
+  NS_TEST_EXPECT_MSG_EQ (delivered, 20, "Frames have not been delivered to all receivers");
+  NS_TEST_EXPECT_MSG_EQ (energyDetectionFailed.size () > 0, true, "Test scenario does not contain receivers out of range");
+
+  Run (true, culled, delivered);
+  NS_TEST_EXPECT_MSG_EQ (culled + delivered, 20, "Culled and delivered receivers do not add up to all receivers");
+  NS_TEST_EXPECT_MSG_EQ (culled > 0, true, "No receiver has been culled");
+  NS_TEST_EXPECT_MSG_EQ ((m_startRx == startRx), true, "Range culling changed the receivers that start a reception");
+  NS_TEST_EXPECT_MSG_EQ (m_energyDetectionFailed.size () < energyDetectionFailed.size (), true,
+                         "Culled receivers should not report a failed energy detection");
+
+  Simulator::Destroy ();
+}
+
+void
+PhySimWifiRangeCullingTest::Run (bool rangeCulling, uint64_t &culled, uint64_t &delivered)
+{
+  m_startRx.clear ();
+  m_energyDetectionFailed.clear ();
+  PhySimWifiPhy::ClearCache ();
+  PhySimWifiPhy::ResetRNG ();
+
+  Ptr<PhySimWifiUniformChannel> channel = CreateObject<PhySimWifiUniformChannel> ();
+  channel->SetAttribute ("RangeCulling", BooleanValue (rangeCulling));
+  channel->SetAttribute ("RangeCullingCellSize", DoubleValue (100.0));
+  channel->SetPropagationLossModel (CreateObject<PhySimLogDistancePropagationLoss> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  // Two nodes close to each other, one at a medium distance, one far away and one that approaches the first node
+  // with a constant velocity (without reporting course changes), from 85m at the first to 5m at the last frame
+  double positions[] = { 0.0, 20.0, 150.0, 20000.0, 105.0 };
+  std::vector<Ptr<PhySimWifiPhy> > phys;
+  std::vector<Ptr<MobilityModel> > mobilities;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Ptr<PhySimWifiPhy> phy = CreateObject<PhySimWifiPhy> ();
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211p_CCH);
+      phy->SetChannel (channel);
+      Ptr<Node> node = CreateObject<Node> ();
+      Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+      device->SetNode (node);
+      Ptr<MobilityModel> mobility;
+      if (i < 4)
+        {
+          mobility = CreateObject<ConstantPositionMobilityModel> ();
+        }
+      else
+        {
+          Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+          moving->SetVelocity (Vector (-2000.0, 0.0, 0.0));
+          mobility = moving;
+        }
+      mobility->SetPosition (Vector (positions[i], 0.0, 0.0));
+      mobilities.push_back (mobility);
+      node->AggregateObject (mobility);
+      phy->SetMobility (node);
+      phy->SetDevice (device);
+
+      std::ostringstream context;
+      context << i;
+      phy->TraceConnect ("StartRx", context.str (), MakeCallback (&PhySimWifiRangeCullingTest::StartRx, this));
+      phy->TraceConnect ("EnergyDetectionFailed", context.str (), MakeCallback (&PhySimWifiRangeCullingTest::EnergyDetectionFailed, this));
+      phys.push_back (phy);
+    }
+
+  // The first four nodes send one frame, one after the other. Then the far node moves next to the first node and
+  // the second node moves far away, and the first node sends again.
+  Ptr<Packet> packet = Create<Packet> (100);
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Simulator::Schedule (MilliSeconds (10 * (i + 1)), &PhySimWifiRangeCullingTest::Send, this, phys[i], packet);
+    }
+  Simulator::Schedule (MilliSeconds (45), &MobilityModel::SetPosition, mobilities[3], Vector (10.0, 0.0, 0.0));
+  Simulator::Schedule (MilliSeconds (45), &MobilityModel::SetPosition, mobilities[1], Vector (20000.0, 0.0, 0.0));
+  Simulator::Schedule (MilliSeconds (50), &PhySimWifiRangeCullingTest::Send, this, phys[0], packet);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  culled = channel->GetNCulledReceivers ();
+  delivered = channel->GetNDeliveredReceivers ();
+}
+
+void
+PhySimWifiRangeCullingTest::Send (Ptr<PhySimWifiPhy> phy, Ptr<const Packet> packet)
+{
+  phy->SendPacket (packet, WifiMode ("OfdmRate6MbpsBW10MHz"), WIFI_PREAMBLE_LONG, 1);
+}
+
+void
+PhySimWifiRangeCullingTest::StartRx (std::string context, Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag)
+{
+  m_startRx[context]++;
+}
+
+void
+PhySimWifiRangeCullingTest::EnergyDetectionFailed (std::string context, Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag)
+{
+  m_energyDetectionFailed[context]++;
+}
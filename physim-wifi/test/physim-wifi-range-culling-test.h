@@ -0,0 +1,59 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#ifndef PHYSIM_WIFI_RANGE_CULLING_TEST_H_
+#define PHYSIM_WIFI_RANGE_CULLING_TEST_H_
+
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/physim-wifi-phy-tag.h"
+#include "ns3/physim-wifi-phy.h"
+#include <map>
+#include <string>
+
+using namespace ns3;
+
+/**
+ * Test case to verify that the range culling of PhySimWifiUniformChannel only drops receivers at which
+ * the energy detection fails, i.e. that the same receivers start the reception of a frame with and without
+ * range culling, also when nodes move after the spatial grid has been built, and that the culled and delivered
+ * receivers are counted correctly.
+ */
+class PhySimWifiRangeCullingTest : public ns3::TestCase
+{
+public:
+  PhySimWifiRangeCullingTest ();
+  virtual ~PhySimWifiRangeCullingTest ();
+
+private:
+  void DoRun (void);
+  void Run (bool rangeCulling, uint64_t &culled, uint64_t &delivered);
+  void Send (Ptr<PhySimWifiPhy> phy, Ptr<const Packet> packet);
+  void StartRx (std::string context, Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag);
+  void EnergyDetectionFailed (std::string context, Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag);
+
+  std::map<std::string, uint32_t> m_startRx;
+  std::map<std::string, uint32_t> m_energyDetectionFailed;
+};
+
+#endif /* PHYSIM_WIFI_RANGE_CULLING_TEST_H_ */
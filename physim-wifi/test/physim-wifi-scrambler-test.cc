@@ -79,6 +79,23 @@ PhySimWifiScramblerTest::DoRun (void)
       NS_LOG_DEBUG ("PASS: Scrambler test for input as in standard annex G");
     }
   NS_TEST_EXPECT_MSG_EQ ( success, true, "Scrambler test failed as scrambled bits do not match standard annex G");
+
+  // The precomputed sequences have to be bit-exact w.r.t. the shift register implementation, for all
+  // initial states and also for lengths that are not a multiple of 8 bits or exceed one table period
+  uint32_t lengths[6] = { 1, 13, 144, 1016, 1017, 12000 };
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      success = RunLookupTable (lengths[i]);
+      if (!success)
+        {
+          NS_LOG_DEBUG ("FAIL: Scrambler lookup table test for " << lengths[i] << " bits");
+        }
+      else
+        {
+          NS_LOG_DEBUG ("PASS: Scrambler lookup table test for " << lengths[i] << " bits");
+        }
+      NS_TEST_EXPECT_MSG_EQ ( success, true, "Scrambler lookup table test failed for " << lengths[i] << " bits: output differs from shift register implementation");
+    }
 }
 
 bool
@@ -111,3 +128,39 @@ PhySimWifiScramblerTest::RunAnnexG (void)
   itpp::bvec scrambledBits = m_scrambler.Scramble (first144Bits, annexSeed);
   return (scrambledBits == first144BitsAfterScrambling);
 }
+
+// Verify the lookup table based scrambler against the shift register implementation
+bool
+PhySimWifiScramblerTest::RunLookupTable (uint32_t numBits)
+{
+  Ptr<PhySimScrambler> bitwise = CreateObject<PhySimScrambler> ();
+  bitwise->SetAttribute ("UseLookupTable", BooleanValue (false));
+  Ptr<PhySimScrambler> table = CreateObject<PhySimScrambler> ();
+  table->SetAttribute ("UseLookupTable", BooleanValue (true));
+
+  itpp::bvec bits = itpp::randb (numBits);
+  PhySimPackedBits packed (bits);
+  for (uint32_t state = 0; state < 128; state++)
+    {
+      itpp::bvec seed = PhySimHelper::DecToBin (state, 7);
+      itpp::bvec reference = bitwise->Scramble (bits, seed);
+      if (!(table->Scramble (bits, seed) == reference))
+        {
+          return false;
+        }
+      if (!(table->Scramble (packed, seed).ToBvec () == reference))
+        {
+          return false;
+        }
+      itpp::bvec descrambled = bitwise->DeScramble (bits, seed);
+      if (!(table->DeScramble (bits, seed) == descrambled))
+        {
+          return false;
+        }
+      if (!(table->DeScramble (packed, seed).ToBvec () == descrambled))
+        {
+          return false;
+        }
+    }
+  return true;
+}
@@ -42,6 +42,7 @@ private:
   void DoRun (void);
   bool RunSingle (itpp::bvec seed);
   bool RunAnnexG (void);
+  bool RunLookupTable (uint32_t numBits);
   PhySimScrambler m_scrambler;
 };
 
@@ -0,0 +1,81 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include "ns3/nstime.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/double.h"
+#include "ns3/mobility-model.h"
+#include "ns3/physim-wifi-phy-tag.h"
+#include "ns3/physim-propagation-loss-model.h"
+#include "physim-wifi-shared-samples-test.h"
+#include <itpp/itbase.h>
+#include <cmath>
+
+using namespace ns3;
+
+PhySimWifiSharedSamplesTest::PhySimWifiSharedSamplesTest ()
+  : TestCase ("PhySim WiFi shared tag samples test case")
+{
+}
+
+PhySimWifiSharedSamplesTest::~PhySimWifiSharedSamplesTest ()
+{
+}
+
+void
+PhySimWifiSharedSamplesTest::DoRun (void)
+{
+  itpp::cvec samples = itpp::randn_c (400);
+  itpp::bvec bits = itpp::randb (800);
+  Ptr<PhySimWifiPhyTag> tag = Create<PhySimWifiPhyTag> ();
+  tag->SetTxParameters (WIFI_PREAMBLE_LONG, WifiPhy::GetOfdmRate6Mbps (), MicroSeconds (40), bits, samples, 5.9e9, 1e-7, 0);
+  tag->SetRxSamplesToTxSamples ();
+
+  NS_TEST_EXPECT_MSG_EQ ((tag->PeekRxedSamples () == samples), true, "Received samples do not equal the transmitted samples");
+  NS_TEST_EXPECT_MSG_EQ (&tag->PeekRxedSamples (), &tag->PeekTxedSamples (), "Received samples are not shared with the transmitted samples");
+
+  // Copies of the tag, as created by the channel for every receiver, share all sample buffers
+  Ptr<PhySimWifiPhyTag> first = Create<PhySimWifiPhyTag> (*tag);
+  Ptr<PhySimWifiPhyTag> second = Create<PhySimWifiPhyTag> (*tag);
+  NS_TEST_EXPECT_MSG_EQ (&first->PeekTxedSamples (), &tag->PeekTxedSamples (), "Transmitted samples have been copied");
+  NS_TEST_EXPECT_MSG_EQ (&first->PeekTxedDataBits (), &tag->PeekTxedDataBits (), "Transmitted bits have been copied");
+  NS_TEST_EXPECT_MSG_EQ (&first->PeekRxedSamples (), &second->PeekRxedSamples (), "Received samples have been copied");
+
+  // Storing received samples in one copy must leave the others untouched
+  first->SetRxSamples (2.0 * first->PeekRxedSamples ());
+  NS_TEST_EXPECT_MSG_EQ ((first->PeekRxedSamples () == 2.0 * samples), true, "Received samples have not been stored");
+  NS_TEST_EXPECT_MSG_EQ ((second->PeekRxedSamples () == samples), true, "Received samples of another copy have been modified");
+  NS_TEST_EXPECT_MSG_EQ ((tag->PeekTxedSamples () == samples), true, "Transmitted samples have been modified");
+  NS_TEST_EXPECT_MSG_EQ ((first->GetTxedDataBits () == bits), true, "Transmitted bits have been modified");
+
+  // A chain of deterministic loss models only accumulates a gain, which is applied when the samples are read
+  Ptr<PhySimConstantPropagationLoss> loss = CreateObject<PhySimConstantPropagationLoss> ();
+  loss->SetAttribute ("PathLoss", DoubleValue (10.0));
+  Ptr<PhySimConstantPropagationLoss> next = CreateObject<PhySimConstantPropagationLoss> ();
+  next->SetAttribute ("PathLoss", DoubleValue (20.0));
+  loss->SetNext (next);
+  loss->CalcRxPower (second, Ptr<MobilityModel> (), Ptr<MobilityModel> ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (itpp::max (itpp::abs (second->PeekRxedSamples () - samples * std::pow (10.0, -30.0 / 20.0))), 0.0, 1e-12,
+                             "Accumulated gain of the loss models has not been applied correctly");
+  NS_TEST_EXPECT_MSG_EQ ((tag->PeekRxedSamples () == samples), true, "Gain has been applied to the samples of another copy");
+  NS_TEST_EXPECT_MSG_EQ ((tag->PeekTxedSamples () == samples), true, "Gain has been applied to the transmitted samples");
+}
@@ -0,0 +1,45 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#ifndef PHYSIM_WIFI_SHARED_SAMPLES_TEST_H_
+#define PHYSIM_WIFI_SHARED_SAMPLES_TEST_H_
+
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Test case to verify that copies of a PhySimWifiPhyTag share the transmitted samples and bits, that
+ * storing received samples in one copy does not affect the other copies, and that the gains accumulated
+ * by deterministic propagation loss models are applied correctly when the samples are read.
+ */
+class PhySimWifiSharedSamplesTest : public ns3::TestCase
+{
+public:
+  PhySimWifiSharedSamplesTest ();
+  virtual ~PhySimWifiSharedSamplesTest ();
+
+private:
+  void DoRun (void);
+};
+
+#endif /* PHYSIM_WIFI_SHARED_SAMPLES_TEST_H_ */
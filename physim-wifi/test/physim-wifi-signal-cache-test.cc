@@ -0,0 +1,126 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-preamble.h"
+#include "ns3/uinteger.h"
+#include "ns3/physim-wifi-channel.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "physim-wifi-signal-cache-test.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhySimWifiSignalCacheTest");
+
+PhySimWifiSignalCacheTest::PhySimWifiSignalCacheTest ()
+  : TestCase ("PhySim WiFi SIGNAL field and preamble cache test case")
+{
+}
+
+PhySimWifiSignalCacheTest::~PhySimWifiSignalCacheTest ()
+{
+}
+
+void
+PhySimWifiSignalCacheTest::DoRun (void)
+{
+  PhySimWifiPhy::ClearCache ();
+  PhySimWifiPhy::ResetRNG ();
+  WifiMode mode ("OfdmRate6MbpsBW10MHz");
+
+  // Cache hits give the same SIGNAL field as a PHY without cache
+  Ptr<PhySimWifiPhy> cached = CreatePhy (WIFI_PHY_STANDARD_80211p_CCH, 2);
+  Ptr<PhySimWifiPhy> uncached = CreatePhy (WIFI_PHY_STANDARD_80211p_CCH, 0);
+  Simulator::Schedule (MilliSeconds (1), &PhySimWifiSignalCacheTest::Send, this, cached, 100, mode);
+  Simulator::Schedule (MilliSeconds (2), &PhySimWifiSignalCacheTest::Send, this, cached, 100, mode);
+  Simulator::Schedule (MilliSeconds (3), &PhySimWifiSignalCacheTest::Send, this, uncached, 100, mode);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_txSamples.size (), 3, "Not all frames have been transmitted");
+  // Samples 321 to 399 belong to the SIGNAL field only (sample 320 overlaps with the preamble, 400 with the DATA field)
+  NS_TEST_EXPECT_MSG_EQ ((m_txSamples[0].mid (321, 79) == m_txSamples[1].mid (321, 79)), true,
+                         "Cached SIGNAL field differs from the first construction");
+  NS_TEST_EXPECT_MSG_EQ ((m_txSamples[0].mid (321, 79) == m_txSamples[2].mid (321, 79)), true,
+                         "Cached SIGNAL field differs from the construction without cache");
+  NS_TEST_EXPECT_MSG_EQ (cached->IsSignalFieldCached (800, mode), true, "SIGNAL field has not been cached");
+  NS_TEST_EXPECT_MSG_EQ (uncached->IsSignalFieldCached (800, mode), false, "SIGNAL field has been cached with a cache size of 0");
+
+  // The oldest entry is evicted once the cache holds 'SignalCacheSize' entries
+  Simulator::Schedule (MilliSeconds (1), &PhySimWifiSignalCacheTest::Send, this, cached, 200, mode);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (cached->IsSignalFieldCached (800, mode), true, "SIGNAL field evicted before the cache is full");
+  NS_TEST_EXPECT_MSG_EQ (cached->IsSignalFieldCached (1600, mode), true, "SIGNAL field has not been cached");
+  Simulator::Schedule (MilliSeconds (1), &PhySimWifiSignalCacheTest::Send, this, cached, 300, mode);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (cached->IsSignalFieldCached (800, mode), false, "Oldest SIGNAL field has not been evicted");
+  NS_TEST_EXPECT_MSG_EQ (cached->IsSignalFieldCached (1600, mode), true, "Wrong SIGNAL field has been evicted");
+  NS_TEST_EXPECT_MSG_EQ (cached->IsSignalFieldCached (2400, mode), true, "SIGNAL field has not been cached");
+
+  // The preamble is cached per symbol time
+  NS_TEST_EXPECT_MSG_EQ (PhySimWifiPhy::IsPreambleCached (MicroSeconds (8)), true, "Preamble of 10 MHz channels has not been cached");
+  NS_TEST_EXPECT_MSG_EQ (PhySimWifiPhy::IsPreambleCached (MicroSeconds (4)), false, "Preamble of 20 MHz channels cached without transmission");
+  Ptr<PhySimWifiPhy> wide = CreatePhy (WIFI_PHY_STANDARD_80211a, 2);
+  Simulator::Schedule (MilliSeconds (1), &PhySimWifiSignalCacheTest::Send, this, wide, 100, WifiMode ("OfdmRate6Mbps"));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (PhySimWifiPhy::IsPreambleCached (MicroSeconds (4)), true, "Preamble of 20 MHz channels has not been cached");
+  NS_TEST_EXPECT_MSG_EQ (PhySimWifiPhy::IsPreambleCached (MicroSeconds (8)), true, "Preamble of 10 MHz channels has been dropped");
+
+  PhySimWifiPhy::ClearCache ();
+  NS_TEST_EXPECT_MSG_EQ (PhySimWifiPhy::IsPreambleCached (MicroSeconds (8)), false, "Preamble cache has not been cleared");
+
+  Simulator::Destroy ();
+}
+
+Ptr<PhySimWifiPhy>
+PhySimWifiSignalCacheTest::CreatePhy (enum WifiPhyStandard standard, uint32_t signalCacheSize)
+{
+  // Every PHY uses a channel of its own, such that the transmissions are not received by the other PHYs
+  Ptr<PhySimWifiChannel> channel = CreateObject<PhySimWifiUniformChannel> ();
+  Ptr<PhySimWifiPhy> phy = CreateObject<PhySimWifiPhy> ();
+  phy->SetAttribute ("SignalCacheSize", UintegerValue (signalCacheSize));
+  phy->ConfigureStandard (standard);
+  phy->SetChannel (channel);
+  phy->TraceConnectWithoutContext ("Tx", MakeCallback (&PhySimWifiSignalCacheTest::PhyTxCallback, this));
+
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+  Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  node->AggregateObject (mobility);
+  phy->SetMobility (node);
+  phy->SetDevice (device);
+  return phy;
+}
+
+void
+PhySimWifiSignalCacheTest::Send (Ptr<PhySimWifiPhy> phy, uint32_t size, WifiMode mode)
+{
+  phy->SendPacket (Create<Packet> (size), mode, WIFI_PREAMBLE_LONG, 1);
+}
+
+void
+PhySimWifiSignalCacheTest::PhyTxCallback (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag)
+{
+  m_txSamples.push_back (tag->GetTxedSamples ());
+}
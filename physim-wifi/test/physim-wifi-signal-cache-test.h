@@ -0,0 +1,57 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#ifndef PHYSIM_WIFI_SIGNAL_CACHE_TEST_H_
+#define PHYSIM_WIFI_SIGNAL_CACHE_TEST_H_
+
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/physim-wifi-phy.h"
+#include "ns3/physim-wifi-phy-tag.h"
+#include <itpp/itcomm.h>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Test case to verify the caches used during frame construction: a cached SIGNAL field yields the same time
+ * samples as a newly constructed one, the SIGNAL field cache of a PHY evicts its oldest entry once it holds
+ * 'SignalCacheSize' entries, and the OFDM preamble is cached separately for each symbol time.
+ */
+class PhySimWifiSignalCacheTest : public ns3::TestCase
+{
+public:
+  PhySimWifiSignalCacheTest ();
+  virtual ~PhySimWifiSignalCacheTest ();
+
+private:
+  void DoRun (void);
+  Ptr<PhySimWifiPhy> CreatePhy (enum WifiPhyStandard standard, uint32_t signalCacheSize);
+  void Send (Ptr<PhySimWifiPhy> phy, uint32_t size, WifiMode mode);
+  void PhyTxCallback (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag);
+
+  std::vector<itpp::cvec> m_txSamples;
+};
+
+#endif /* PHYSIM_WIFI_SIGNAL_CACHE_TEST_H_ */
@@ -36,13 +36,18 @@
 #include "ns3/constant-position-mobility-model.h"
 #include "physim-wifi-signal-detection-test.h"
 #include <itpp/itcomm.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("PhySimWifiSignalDetectionTest");
 
 PhySimWifiSignalDetectionTest::PhySimWifiSignalDetectionTest ()
-  : TestCase ("PhySim WiFi signal detection test case")
+  : TestCase ("PhySim WiFi signal detection test case"),
+    m_shortCorrelations (0),
+    m_longCorrelations (0)
 {
 }
 
@@ -112,6 +117,9 @@ PhySimWifiSignalDetectionTest::DoRun (void)
   // Create a signal detector
   Ptr<PhySimSignalDetector>  detector = CreateObject<PhySimSignalDetector> ();
   RunSingle (detector, packet, m_txSamples, tag);
+
+  // The early exit mode must not change the detection results
+  RunEarlyExit (packet, m_txSamples);
 }
 
 bool
@@ -155,6 +163,89 @@ PhySimWifiSignalDetectionTest::RunSingle (Ptr<PhySimSignalDetector> detector, Pt
   return true;
 }
 
+void
+PhySimWifiSignalDetectionTest::RunEarlyExit (Ptr<Packet> packet, const itpp::cvec &samples)
+{
+  // Reference: scan the whole input for the short and the long training symbols
+  Ptr<PhySimSignalDetector> reference = CreateObject<PhySimSignalDetector> ();
+  Ptr<PhySimWifiPhyTag> referenceTag = Create<PhySimWifiPhyTag> ();
+  bool detected = reference->DetectPreamble (packet, referenceTag, samples);
+  NS_TEST_ASSERT_MSG_EQ (detected, true, "Preamble not detected without early exit");
+  int32_t beginShortSymbols = referenceTag->GetShortSymbolStart ();
+  int32_t beginLongSymbols = referenceTag->GetLongSymbolStart ();
+
+  // The reference scan starts at the begin of the input that follows the short training symbols, so the positions
+  // of its two highest correlation values are the indices of the two maxima. The bounded scan expects the long
+  // training symbols at 112 and 176, and the smallest margin that still covers both maxima is the boundary.
+  std::vector<double> correlations = referenceTag->GetLongTrainingSymbolCorrelations ();
+  int32_t maxPosFirst = -1;
+  int32_t maxPosSecond = -1;
+  for (uint32_t k = 0; k < correlations.size (); k++)
+    {
+      if (maxPosFirst < 0 || correlations[k] > correlations[maxPosFirst])
+        {
+          maxPosSecond = maxPosFirst;
+          maxPosFirst = k;
+        }
+      else if (maxPosSecond < 0 || correlations[k] > correlations[maxPosSecond])
+        {
+          maxPosSecond = k;
+        }
+    }
+  int32_t lowest = std::min (maxPosFirst, maxPosSecond);
+  int32_t highest = std::max (maxPosFirst, maxPosSecond);
+  NS_TEST_ASSERT_MSG_EQ (lowest + 80 - 32, beginLongSymbols, "Unexpected long training symbol correlations");
+  uint32_t boundary = std::max (0, std::max (112 - lowest, highest - 176));
+  int32_t remainder = samples.size () - beginShortSymbols - 80;
+  uint32_t margins[] = { boundary, 32 };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<PhySimSignalDetector> detector = CreateObject<PhySimSignalDetector> ();
+      detector->SetAttribute ("EarlyExit", BooleanValue (true));
+      detector->SetAttribute ("LongSymbolSearchMargin", UintegerValue (margins[i]));
+      detector->TraceConnectWithoutContext ("ShortSymbolCorrelations", MakeCallback (&PhySimWifiSignalDetectionTest::ShortSymbolCorrelations, this));
+      detector->TraceConnectWithoutContext ("LongSymbolCorrelations", MakeCallback (&PhySimWifiSignalDetectionTest::LongSymbolCorrelations, this));
+      m_shortCorrelations = 0;
+      m_longCorrelations = 0;
+      Ptr<PhySimWifiPhyTag> tag = Create<PhySimWifiPhyTag> ();
+      NS_TEST_EXPECT_MSG_EQ (detector->DetectPreamble (packet, tag, samples), true, "Preamble not detected with early exit and a margin of " << margins[i]);
+      NS_TEST_EXPECT_MSG_EQ ((int32_t) tag->GetShortSymbolStart (), beginShortSymbols, "Early exit changed the begin of the short training symbols");
+      NS_TEST_EXPECT_MSG_EQ ((int32_t) tag->GetLongSymbolStart (), beginLongSymbols, "Early exit changed the begin of the long training symbols with a margin of " << margins[i]);
+
+      // The short symbol scan has to stop 'EarlyExitSamples' (16) samples after the threshold crossing, and the long
+      // symbol scan has to be bounded to [112 - margin, 176 + margin]
+      NS_TEST_EXPECT_MSG_EQ (m_shortCorrelations, (uint32_t) beginShortSymbols + 16 + 1, "Short training symbol scan did not exit early");
+      int32_t first = std::max (0, 112 - (int32_t) margins[i]);
+      int32_t last = std::min (remainder - 64, 176 + (int32_t) margins[i]);
+      NS_TEST_EXPECT_MSG_EQ (m_longCorrelations, (uint32_t) (last - first + 1), "Long training symbol scan was not bounded");
+    }
+
+  // A frame 20 dB below the noise is rejected in both modes, without scanning for the long training symbols
+  double power = itpp::sum_sqr (itpp::abs (samples)) / samples.size ();
+  itpp::cvec weak = samples + std::sqrt (100 * power) * itpp::randn_c (samples.size ());
+  Ptr<PhySimSignalDetector> detector = CreateObject<PhySimSignalDetector> ();
+  detector->SetAttribute ("EarlyExit", BooleanValue (true));
+  detector->TraceConnectWithoutContext ("ShortSymbolCorrelations", MakeCallback (&PhySimWifiSignalDetectionTest::ShortSymbolCorrelations, this));
+  detector->TraceConnectWithoutContext ("LongSymbolCorrelations", MakeCallback (&PhySimWifiSignalDetectionTest::LongSymbolCorrelations, this));
+  m_shortCorrelations = 0;
+  m_longCorrelations = 0;
+  NS_TEST_EXPECT_MSG_EQ (reference->DetectPreamble (packet, Create<PhySimWifiPhyTag> (), weak), false, "Preamble of a frame below the sensitivity detected");
+  NS_TEST_EXPECT_MSG_EQ (detector->DetectPreamble (packet, Create<PhySimWifiPhyTag> (), weak), false, "Preamble of a frame below the sensitivity detected with early exit");
+  NS_TEST_EXPECT_MSG_EQ (m_longCorrelations, (uint32_t) 0, "Long training symbols scanned for a frame below the sensitivity");
+}
+
+void
+PhySimWifiSignalDetectionTest::ShortSymbolCorrelations (Ptr<const PhySimWifiPhyTag> tag, std::vector<double> correlations)
+{
+  m_shortCorrelations = correlations.size ();
+}
+
+void
+PhySimWifiSignalDetectionTest::LongSymbolCorrelations (Ptr<const PhySimWifiPhyTag> tag, std::vector<double> correlations)
+{
+  m_longCorrelations = correlations.size ();
+}
+
 void
 PhySimWifiSignalDetectionTest::PhyTxCallback (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag)
 {
@@ -29,6 +29,7 @@
 #include "ns3/packet.h"
 #include "ns3/physim-wifi-phy-tag.h"
 #include <itpp/itcomm.h>
+#include <vector>
 
 using namespace ns3;
 
@@ -47,8 +48,13 @@ private:
   void DoRun (void);
   void PhyTxCallback (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag);
   bool RunSingle (Ptr<PhySimSignalDetector> detector, Ptr<Packet> packet, itpp::cvec &samples, Ptr<PhySimWifiPhyTag> tag);
+  void RunEarlyExit (Ptr<Packet> packet, const itpp::cvec &samples);
+  void ShortSymbolCorrelations (Ptr<const PhySimWifiPhyTag> tag, std::vector<double> correlations);
+  void LongSymbolCorrelations (Ptr<const PhySimWifiPhyTag> tag, std::vector<double> correlations);
 
   itpp::cvec m_txSamples;
+  uint32_t m_shortCorrelations;
+  uint32_t m_longCorrelations;
 
 };
 
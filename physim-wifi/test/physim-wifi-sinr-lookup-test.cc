@@ -0,0 +1,195 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-preamble.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/physim-wifi-channel.h"
+#include "ns3/physim-propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "physim-wifi-sinr-lookup-test.h"
+#include <cmath>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhySimWifiSinrLookupTest");
+
+PhySimWifiSinrLookupTest::PhySimWifiSinrLookupTest ()
+  : TestCase ("PhySim WiFi SINR lookup test case")
+{
+}
+
+PhySimWifiSinrLookupTest::~PhySimWifiSinrLookupTest ()
+{
+}
+
+void
+PhySimWifiSinrLookupTest::DoRun (void)
+{
+  // The link has an SNR of 25 dB (16.02 dBm transmit power, 90 dB path loss and a noise floor of -99 dBm). The
+  // threshold curve loses 10% of the frames at 25 dB, the failure curve loses all frames.
+  const double threshold[] = { 1.0, 1.0, 0.2, 0.0, 0.0 };
+  const double failure[] = { 1.0, 1.0, 1.0, 1.0, 1.0 };
+
+  // Round trip through the file format
+  std::string filename = CreateTempDirFilename ("physim-per-table.bin");
+  NS_TEST_ASSERT_MSG_EQ (CreateTable (threshold)->Save (filename), true, "Unable to write the PER table");
+  Ptr<PhySimPerTable> table = CreateObject<PhySimPerTable> ();
+  NS_TEST_ASSERT_MSG_EQ (table->Load (filename), true, "Unable to read the PER table");
+  NS_TEST_EXPECT_MSG_EQ (table->HasCurve ("OfdmRate6MbpsBW10MHz", PhySimPerTable::AWGN_PROFILE), true, "Curve is missing");
+  NS_TEST_EXPECT_MSG_EQ (table->HasCurve ("OfdmRate12MbpsBW10MHz", PhySimPerTable::AWGN_PROFILE), false, "Unexpected curve");
+  NS_TEST_EXPECT_MSG_EQ (table->HasCurve ("OfdmRate6MbpsBW10MHz", 0), false, "Unexpected curve");
+  NS_TEST_EXPECT_MSG_EQ_TOL (table->GetPer ("OfdmRate6MbpsBW10MHz", 100, PhySimPerTable::AWGN_PROFILE, 25.0), 0.1, 1e-9,
+                             "PER is not interpolated between the SNR values");
+  NS_TEST_EXPECT_MSG_EQ_TOL (table->GetPer ("OfdmRate6MbpsBW10MHz", 200, PhySimPerTable::AWGN_PROFILE, 25.0), 0.18, 1e-9,
+                             "PER is not scaled to the frame length");
+  NS_TEST_EXPECT_MSG_EQ_TOL (table->GetSnrForPer ("OfdmRate6MbpsBW10MHz", 100, PhySimPerTable::AWGN_PROFILE, 0.1), 25.0, 1e-9,
+                             "Decoding threshold is not interpolated between the SNR values");
+
+  // Frames within the uncertainty band have to be decoded bit by bit
+  Run (table, 3.0, 20);
+  NS_TEST_EXPECT_MSG_EQ (m_fullDecodings, 20, "Frames within the uncertainty band have not been decoded");
+  NS_TEST_EXPECT_MSG_EQ (m_lookupSuccesses + m_lookupFailures, 0, "Frames within the uncertainty band have been looked up");
+  NS_TEST_EXPECT_MSG_EQ (m_rxOk, 20, "Frames at an SNR of 25 dB have not been decoded");
+
+  // Without a band, the lookup decides on all frames and loses about 10% of them
+  Run (table, 0.0, 400);
+  NS_TEST_EXPECT_MSG_EQ (m_fullDecodings, 0, "Frames have been decoded although the uncertainty band is empty");
+  NS_TEST_EXPECT_MSG_EQ (m_lookupSuccesses + m_lookupFailures, 400, "Not all frames have been looked up");
+  NS_TEST_EXPECT_MSG_EQ (m_lookupFailures, m_rxError, "Lookup failures have not been reported as errors");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_rxError / 400.0, 0.1, 0.05, "Lookup failure rate does not follow the PER table");
+
+  // Failures decided by the lookup do not carry received data bits
+  Run (CreateTable (failure), 0.0, 20);
+  NS_TEST_EXPECT_MSG_EQ (m_lookupFailures, 20, "Frames have not been decided erroneous by the lookup");
+  NS_TEST_EXPECT_MSG_EQ (m_rxError, 20, "Lookup failures have not been reported as errors");
+  NS_TEST_EXPECT_MSG_EQ (m_rxErrorWithData, 0, "Lookup failures carry (corrupted) received data bits");
+
+  // Without a PER table the frames are decoded bit by bit
+  Run (0, 0.0, 5);
+  NS_TEST_EXPECT_MSG_EQ (m_fullDecodings, 5, "Frames have not been decoded without a PER table");
+}
+
+Ptr<PhySimPerTable>
+PhySimWifiSinrLookupTest::CreateTable (const double *pers)
+{
+  std::vector<double> snrs;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      snrs.push_back (10.0 * i);
+    }
+  Ptr<PhySimPerTable> table = CreateObject<PhySimPerTable> ();
+  table->SetGrid (snrs, std::vector<std::string> (1, "OfdmRate6MbpsBW10MHz"), std::vector<uint32_t> (1, 100),
+                  std::vector<uint32_t> (1, PhySimPerTable::AWGN_PROFILE));
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      uint32_t rxOk = (uint32_t) floor ((1.0 - pers[i]) * 1000 + 0.5);
+      table->SetRecord (table->GetIndex (i, 0, 0, 0), 1000, rxOk, rxOk, rxOk * 800, 0);
+    }
+  return table;
+}
+
+void
+PhySimWifiSinrLookupTest::Run (Ptr<PhySimPerTable> table, double band, uint32_t frames)
+{
+  m_rxOk = 0;
+  m_rxError = 0;
+  m_rxErrorWithData = 0;
+  PhySimWifiPhy::ClearCache ();
+  PhySimWifiPhy::ResetRNG ();
+
+  Ptr<PhySimWifiUniformChannel> channel = CreateObject<PhySimWifiUniformChannel> ();
+  Ptr<PhySimConstantPropagationLoss> loss = CreateObject<PhySimConstantPropagationLoss> ();
+  loss->SetPathLoss (90.0);
+  channel->SetPropagationLossModel (loss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+
+  std::vector<Ptr<PhySimWifiPhy> > phys;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<PhySimWifiPhy> phy = CreateObject<PhySimWifiPhy> ();
+      phy->SetAttribute ("UseSinrLookup", BooleanValue (true));
+      phy->SetAttribute ("SinrLookupBand", DoubleValue (band));
+      phy->SetAttribute ("PerTable", PointerValue (table));
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211p_CCH);
+      phy->SetChannel (channel);
+      Ptr<Node> node = CreateObject<Node> ();
+      Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+      device->SetNode (node);
+      Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (10.0 * i, 0.0, 0.0));
+      node->AggregateObject (mobility);
+      phy->SetMobility (node);
+      phy->SetDevice (device);
+      phys.push_back (phy);
+    }
+  phys[1]->TraceConnectWithoutContext ("RxOk", MakeCallback (&PhySimWifiSinrLookupTest::RxOk, this));
+  phys[1]->TraceConnectWithoutContext ("RxError", MakeCallback (&PhySimWifiSinrLookupTest::RxError, this));
+
+  Ptr<Packet> packet = Create<Packet> (100);
+  for (uint32_t i = 0; i < frames; i++)
+    {
+      Simulator::Schedule (MilliSeconds (i + 1), &PhySimWifiSinrLookupTest::Send, this, phys[0], packet);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_lookupSuccesses = phys[1]->GetNLookupSuccesses ();
+  m_lookupFailures = phys[1]->GetNLookupFailures ();
+  m_fullDecodings = phys[1]->GetNFullDecodings ();
+}
+
+void
+PhySimWifiSinrLookupTest::Send (Ptr<PhySimWifiPhy> phy, Ptr<const Packet> packet)
+{
+  phy->SendPacket (packet, WifiMode ("OfdmRate6MbpsBW10MHz"), WIFI_PREAMBLE_LONG, 1);
+}
+
+void
+PhySimWifiSinrLookupTest::RxOk (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag)
+{
+  m_rxOk++;
+}
+
+void
+PhySimWifiSinrLookupTest::RxError (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag, enum PhySimWifiPhy::ErrorReason reason)
+{
+  if (reason != PhySimWifiPhy::PROCESSING)
+    {
+      return;
+    }
+  m_rxError++;
+  if (tag->GetRxDataBits ().size () > 0)
+    {
+      m_rxErrorWithData++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (tag->GetTxedDataBits ().size () > 0, true, "Transmitted data bits have been lost");
+}
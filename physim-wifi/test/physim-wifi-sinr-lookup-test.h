@@ -0,0 +1,63 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#ifndef PHYSIM_WIFI_SINR_LOOKUP_TEST_H_
+#define PHYSIM_WIFI_SINR_LOOKUP_TEST_H_
+
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/physim-wifi-phy-tag.h"
+#include "ns3/physim-wifi-phy.h"
+#include "ns3/physim-per-table.h"
+
+using namespace ns3;
+
+/**
+ * Test case for the SINR lookup of PhySimWifiPhy (attributes UseSinrLookup, SinrLookupBand and PerTable): the PER
+ * table has to survive a round trip through its file format, frames within the uncertainty band have to be decoded
+ * bit by bit, the lookup outcomes have to follow the PER of the table near the decoding threshold, and a failure
+ * decided by the lookup has to be reported without received data bits.
+ */
+class PhySimWifiSinrLookupTest : public ns3::TestCase
+{
+public:
+  PhySimWifiSinrLookupTest ();
+  virtual ~PhySimWifiSinrLookupTest ();
+
+private:
+  void DoRun (void);
+  Ptr<PhySimPerTable> CreateTable (const double *pers);
+  void Run (Ptr<PhySimPerTable> table, double band, uint32_t frames);
+  void Send (Ptr<PhySimWifiPhy> phy, Ptr<const Packet> packet);
+  void RxOk (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag);
+  void RxError (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag, enum PhySimWifiPhy::ErrorReason reason);
+
+  uint32_t m_rxOk;
+  uint32_t m_rxError;
+  uint32_t m_rxErrorWithData;
+  uint64_t m_lookupSuccesses;
+  uint64_t m_lookupFailures;
+  uint64_t m_fullDecodings;
+};
+
+#endif /* PHYSIM_WIFI_SINR_LOOKUP_TEST_H_ */
@@ -0,0 +1,105 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include <itpp/itcomm.h>
+#include "ns3/log.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/physim-blockinterleaver.h"
+#include "physim-wifi-soft-demapper-test.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhySimWifiSoftDemapperTest");
+
+PhySimWifiSoftDemapperTest::PhySimWifiSoftDemapperTest ()
+  : TestCase ("PhySim WiFi soft demapper test case")
+{
+}
+
+PhySimWifiSoftDemapperTest::~PhySimWifiSoftDemapperTest ()
+{
+}
+
+void
+PhySimWifiSoftDemapperTest::DoRun (void)
+{
+  // Provide known seed for predictable results (bits and noise are drawn from the IT++ generator)
+  itpp::RNG_reset (1);
+
+  itpp::BPSK_c bpsk;
+  itpp::QPSK qpsk;
+  itpp::QAM qam16 (16);
+  itpp::QAM qam64 (64);
+  RunSingle<2> (bpsk, WifiPhy::GetOfdmRate6Mbps (), "BPSK");
+  RunSingle<4> (qpsk, WifiPhy::GetOfdmRate12Mbps (), "QPSK");
+  RunSingle<16> (qam16, WifiPhy::GetOfdmRate24Mbps (), "QAM-16");
+  RunSingle<64> (qam64, WifiPhy::GetOfdmRate54Mbps (), "QAM-64");
+}
+
+template <uint32_t M>
+bool
+PhySimWifiSoftDemapperTest::RunSingle (itpp::Modulator<std::complex<double> > &modulator, WifiMode mode, std::string description)
+{
+  PhySimMaxLogDemapper<M> demapper;
+  bool success = demapper.Initialise (modulator);
+  NS_TEST_EXPECT_MSG_EQ (success, true, "Soft demapper does not support the " << description << " constellation");
+  if (!success)
+    {
+      return false;
+    }
+
+  // The max-log approximation differs from the exact LLR by at most log(M/2)
+  const double maxLogBound = std::log (M / 2.0) + 1e-9;
+  double noiseDensities[] = { 1.0, 0.1, 0.01 };
+  for (uint32_t n = 0; n < 3; n++)
+    {
+      double N0 = noiseDensities[n];
+      itpp::bvec bits = itpp::randb (PhySimMaxLogDemapper<M>::NBITS * 1000);
+      itpp::cvec received = modulator.modulate_bits (bits) + std::sqrt (N0) * itpp::randn_c (1000);
+
+      itpp::vec llrs = demapper.Demodulate (received, N0);
+      itpp::vec approx = modulator.demodulate_soft_bits (received, N0, itpp::APPROX);
+      itpp::vec logmap = modulator.demodulate_soft_bits (received, N0, itpp::LOGMAP);
+
+      bool approxSuccess = (llrs.size () == approx.size ());
+      bool logmapSuccess = (llrs.size () == logmap.size ());
+      for (int32_t i = 0; i < llrs.size () && approxSuccess && logmapSuccess; i++)
+        {
+          approxSuccess = std::fabs (llrs (i) - approx (i)) <= 1e-9 * (1 + std::fabs (approx (i)));
+          logmapSuccess = std::fabs (llrs (i) - logmap (i)) <= maxLogBound;
+        }
+      NS_TEST_EXPECT_MSG_EQ (approxSuccess, true, "Soft demapper differs from IT++ APPROX for " << description << " and N0 = " << N0);
+      NS_TEST_EXPECT_MSG_EQ (logmapSuccess, true, "Soft demapper exceeds the max-log bound of IT++ LOGMAP for " << description << " and N0 = " << N0);
+      success = success && approxSuccess && logmapSuccess;
+    }
+
+  // Writing the LLRs to the deinterleaved positions has to match a separate deinterleaving
+  PhySimBlockInterleaver interleaver;
+  interleaver.SetWifiMode (mode);
+  itpp::bvec bits = itpp::randb (PhySimMaxLogDemapper<M>::NBITS * 48 * 20);
+  itpp::cvec received = modulator.modulate_bits (bits) + 0.1 * itpp::randn_c (48 * 20);
+  itpp::vec deinterleaved (bits.size ());
+  demapper.Demodulate (received._data (), received.size (), 0.01, deinterleaved._data (), interleaver.GetDeinterleavingPositions (), 48);
+  bool fusedSuccess = (deinterleaved == interleaver.Deinterleave (demapper.Demodulate (received, 0.01)));
+  NS_TEST_EXPECT_MSG_EQ (fusedSuccess, true, "Soft demapping to deinterleaved positions differs from demapping and deinterleaving for " << description);
+  return success && fusedSuccess;
+}
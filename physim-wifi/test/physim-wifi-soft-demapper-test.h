@@ -0,0 +1,48 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#ifndef PHYSIM_WIFI_SOFT_DEMAPPER_TEST_H_
+#define PHYSIM_WIFI_SOFT_DEMAPPER_TEST_H_
+
+#include "ns3/test.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/physim-soft-demapper.h"
+
+using namespace ns3;
+
+/**
+ * Test case to verify that the max-log soft demapper produces the same LLRs as the
+ * IT++ APPROX method, and stays within the max-log bound of the IT++ LOGMAP method.
+ */
+class PhySimWifiSoftDemapperTest : public ns3::TestCase
+{
+public:
+  PhySimWifiSoftDemapperTest ();
+  virtual ~PhySimWifiSoftDemapperTest ();
+
+private:
+  void DoRun (void);
+  template <uint32_t M>
+  bool RunSingle (itpp::Modulator<std::complex<double> > &modulator, WifiMode mode, std::string description);
+};
+
+#endif /* PHYSIM_WIFI_SOFT_DEMAPPER_TEST_H_ */
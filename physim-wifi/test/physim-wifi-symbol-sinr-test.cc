@@ -0,0 +1,170 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-preamble.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/physim-helper.h"
+#include "ns3/physim-propagation-loss-model.h"
+#include "ns3/physim-sinr-trace-writer.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "physim-wifi-symbol-sinr-test.h"
+#include <fstream>
+#include <string>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhySimWifiSymbolSinrTest");
+
+template <typename T>
+static T
+ReadValue (std::ifstream &in)
+{
+  T value = 0;
+  in.read (reinterpret_cast<char *> (&value), sizeof (T));
+  return value;
+}
+
+PhySimWifiSymbolSinrTest::PhySimWifiSymbolSinrTest ()
+  : TestCase ("PhySim WiFi per-symbol SINR test case")
+{
+}
+
+PhySimWifiSymbolSinrTest::~PhySimWifiSymbolSinrTest ()
+{
+}
+
+void
+PhySimWifiSymbolSinrTest::DoRun (void)
+{
+  m_records = 0;
+  PhySimWifiPhy::ClearCache ();
+  PhySimWifiPhy::ResetRNG ();
+
+  // All links have an SNR of 25 dB (16.02 dBm transmit power, 90 dB path loss and a noise floor of -99 dBm), apart
+  // from the link between the sender and the interferer, such that the interferer does not receive the frame.
+  Ptr<PhySimWifiManualChannel> channel = CreateObject<PhySimWifiManualChannel> ();
+  Ptr<PhySimConstantPropagationLoss> loss = CreateObject<PhySimConstantPropagationLoss> ();
+  loss->SetPathLoss (90.0);
+  channel->SetPropagationLossModel (loss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<PhySimWifiPhy> receiver = CreatePhy (channel, 0.0);
+  Ptr<PhySimWifiPhy> sender = CreatePhy (channel, 10.0);
+  Ptr<PhySimWifiPhy> interferer = CreatePhy (channel, -10.0);
+  uint32_t receiverId = receiver->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
+  uint32_t senderId = sender->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
+  uint32_t interfererId = interferer->GetDevice ()->GetObject<NetDevice> ()->GetNode ()->GetId ();
+  Ptr<PhySimConstantPropagationLoss> isolation = CreateObject<PhySimConstantPropagationLoss> ();
+  isolation->SetPathLoss (200.0);
+  channel->SetExplicitPropagationLossModel (senderId, interfererId, isolation);
+
+  receiver->SetAttribute ("CalculateSymbolSinr", BooleanValue (true));
+  receiver->TraceConnectWithoutContext ("SymbolSinr", MakeCallback (&PhySimWifiSymbolSinrTest::SymbolSinr, this));
+  std::string filename = CreateTempDirFilename ("physim-symbol-sinr.bin");
+  Ptr<PhySimSinrTraceWriter> writer = Create<PhySimSinrTraceWriter> (filename);
+  receiver->TraceConnectWithoutContext ("SymbolSinr", MakeCallback (&PhySimSinrTraceWriter::Write, PeekPointer (writer)));
+
+  // A frame of 1000 bytes at 6 Mbps lasts 4 + 1 + 168 OFDM symbols of 8 us. 400 us (50 symbols) after its start,
+  // a frame of 100 bytes (23 symbols) is sent by the interferer, i.e. symbols 50 to 72 are overlapped.
+  Simulator::Schedule (MilliSeconds (1), &PhySimWifiSymbolSinrTest::Send, this, sender, 1000);
+  Simulator::Schedule (MilliSeconds (1) + MicroSeconds (400), &PhySimWifiSymbolSinrTest::Send, this, interferer, 100);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  writer = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (m_records, 1, "SymbolSinr trace has not been fired once for the frame of the sender");
+  NS_TEST_ASSERT_MSG_EQ (m_sinrs.size (), 173, "Wrong number of per-symbol SINR values");
+  for (uint32_t i = 0; i < m_sinrs.size (); i++)
+    {
+      if (i >= 50 && i <= 72)
+        {
+          NS_TEST_EXPECT_MSG_EQ_TOL (m_sinrs[i], 0.0, 3.0, "Wrong SINR of symbol " << i << " overlapped by the interferer");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ_TOL (m_sinrs[i], 25.0, 3.0, "Wrong SINR of symbol " << i << " without interference");
+        }
+    }
+
+  // The trace file holds the header and a single record with the same values
+  std::ifstream in (filename.c_str (), std::ios::in | std::ios::binary);
+  char magic[4];
+  in.read (magic, 4);
+  NS_TEST_ASSERT_MSG_EQ (std::string (magic, 4), "PSNR", "Wrong file magic");
+  NS_TEST_EXPECT_MSG_EQ (ReadValue<uint16_t> (in), (uint16_t) PhySimSinrTraceWriter::VERSION, "Wrong format version");
+  NS_TEST_EXPECT_MSG_EQ (ReadValue<uint16_t> (in), 0, "Wrong reserved field");
+  NS_TEST_EXPECT_MSG_EQ (ReadValue<uint64_t> (in), (uint64_t) m_rxTime.GetNanoSeconds (), "Wrong reception time");
+  NS_TEST_EXPECT_MSG_EQ (ReadValue<uint32_t> (in), receiverId, "Wrong receiver node id");
+  NS_TEST_EXPECT_MSG_EQ (ReadValue<uint32_t> (in), senderId, "Wrong transmitter node id");
+  uint32_t rateField = itpp::bin2dec (PhySimHelper::CreateRateField (WifiMode ("OfdmRate6MbpsBW10MHz")));
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) ReadValue<uint8_t> (in), rateField, "Wrong rate field");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) ReadValue<uint8_t> (in), (m_success ? 1u : 0u), "Wrong decoding result");
+  NS_TEST_EXPECT_MSG_EQ (ReadValue<uint32_t> (in), m_length, "Wrong frame length");
+  NS_TEST_ASSERT_MSG_EQ (ReadValue<uint32_t> (in), m_sinrs.size (), "Wrong number of symbols");
+  for (uint32_t i = 0; i < m_sinrs.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (ReadValue<float> (in), (float) m_sinrs[i], "Wrong SINR of symbol " << i << " in the trace file");
+    }
+  NS_TEST_EXPECT_MSG_EQ (in.good (), true, "Trace file is truncated");
+  in.peek ();
+  NS_TEST_EXPECT_MSG_EQ (in.eof (), true, "Trace file holds more than one record");
+}
+
+Ptr<PhySimWifiPhy>
+PhySimWifiSymbolSinrTest::CreatePhy (Ptr<PhySimWifiChannel> channel, double position)
+{
+  Ptr<PhySimWifiPhy> phy = CreateObject<PhySimWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211p_CCH);
+  phy->SetChannel (channel);
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+  device->SetNode (node);
+  Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (Vector (position, 0.0, 0.0));
+  node->AggregateObject (mobility);
+  phy->SetMobility (node);
+  phy->SetDevice (device);
+  return phy;
+}
+
+void
+PhySimWifiSymbolSinrTest::Send (Ptr<PhySimWifiPhy> phy, uint32_t size)
+{
+  phy->SendPacket (Create<Packet> (size), WifiMode ("OfdmRate6MbpsBW10MHz"), WIFI_PREAMBLE_LONG, 1);
+}
+
+void
+PhySimWifiSymbolSinrTest::SymbolSinr (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag, bool success)
+{
+  m_records++;
+  m_sinrs = tag->GetSymbolSinrs ();
+  m_success = success;
+  m_rxTime = Simulator::Now ();
+  m_length = tag->GetDetectedLength ();
+}
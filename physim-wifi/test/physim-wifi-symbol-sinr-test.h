@@ -0,0 +1,62 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#ifndef PHYSIM_WIFI_SYMBOL_SINR_TEST_H_
+#define PHYSIM_WIFI_SYMBOL_SINR_TEST_H_
+
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/physim-wifi-phy-tag.h"
+#include "ns3/physim-wifi-phy.h"
+#include "ns3/physim-wifi-channel.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Test case for the per-symbol SINR of PhySimWifiPhy (attribute CalculateSymbolSinr and trace source SymbolSinr)
+ * and for PhySimSinrTraceWriter: a frame that is partly overlapped by a single interferer of the same receive power
+ * has to show an SINR of about 0 dB for exactly the overlapped OFDM symbols and the SNR of the link elsewhere, and
+ * the trace file has to contain one record with these values in the documented format.
+ */
+class PhySimWifiSymbolSinrTest : public ns3::TestCase
+{
+public:
+  PhySimWifiSymbolSinrTest ();
+  virtual ~PhySimWifiSymbolSinrTest ();
+
+private:
+  void DoRun (void);
+  Ptr<PhySimWifiPhy> CreatePhy (Ptr<PhySimWifiChannel> channel, double position);
+  void Send (Ptr<PhySimWifiPhy> phy, uint32_t size);
+  void SymbolSinr (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag, bool success);
+
+  uint32_t m_records;
+  std::vector<double> m_sinrs;
+  bool m_success;
+  Time m_rxTime;
+  uint32_t m_length;
+};
+
+#endif /* PHYSIM_WIFI_SYMBOL_SINR_TEST_H_ */
@@ -34,6 +34,15 @@
 #include "physim-wifi-frame-power-test.h"
 #include "physim-wifi-signal-detection-test.h"
 #include "physim-wifi-vehicular-channel-test.h"
+#include "physim-wifi-sinr-lookup-test.h"
+#include "physim-wifi-packed-bits-test.h"
+#include "physim-wifi-signal-cache-test.h"
+#include "physim-wifi-soft-demapper-test.h"
+#include "physim-wifi-tx-pipeline-test.h"
+#include "physim-wifi-range-culling-test.h"
+#include "physim-wifi-shared-samples-test.h"
+#include "physim-wifi-manual-channel-test.h"
+#include "physim-wifi-symbol-sinr-test.h"
 
 using namespace ns3;
 
@@ -55,6 +64,15 @@ PhySimWifiTestSuite::PhySimWifiTestSuite ()
   AddTestCase (new PhySimWifiFramePowerTest);
   AddTestCase (new PhySimWifiSignalDetectionTest);
   AddTestCase (new PhySimWifiVehicularChannelTest);
+  AddTestCase (new PhySimWifiSinrLookupTest);
+  AddTestCase (new PhySimWifiPackedBitsTest);
+  AddTestCase (new PhySimWifiSignalCacheTest);
+  AddTestCase (new PhySimWifiSoftDemapperTest);
+  AddTestCase (new PhySimWifiTxPipelineTest);
+  AddTestCase (new PhySimWifiRangeCullingTest);
+  AddTestCase (new PhySimWifiSharedSamplesTest);
+  AddTestCase (new PhySimWifiManualChannelTest);
+  AddTestCase (new PhySimWifiSymbolSinrTest);
 }
 
 // create an instance of the test suite
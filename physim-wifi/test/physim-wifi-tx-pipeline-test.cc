@@ -0,0 +1,128 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-preamble.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/physim-wifi-channel.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "physim-wifi-tx-pipeline-test.h"
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PhySimWifiTxPipelineTest");
+
+PhySimWifiTxPipelineTest::PhySimWifiTxPipelineTest ()
+  : TestCase ("PhySim WiFi streaming TX pipeline test case")
+{
+}
+
+PhySimWifiTxPipelineTest::~PhySimWifiTxPipelineTest ()
+{
+}
+
+void
+PhySimWifiTxPipelineTest::DoRun (void)
+{
+  PhySimWifiPhy::ClearCache ();
+  PhySimWifiPhy::ResetRNG ();
+
+  // Both constructions have to use the same scrambler state
+  Config::SetDefault ("ns3::PhySimScrambler::UseFixedScrambler", BooleanValue (true) );
+
+  WifiMode modes[] = { WifiPhy::GetOfdmRate3MbpsBW10MHz (), WifiPhy::GetOfdmRate4_5MbpsBW10MHz (),
+                       WifiPhy::GetOfdmRate6MbpsBW10MHz (), WifiPhy::GetOfdmRate9MbpsBW10MHz (),
+                       WifiPhy::GetOfdmRate12MbpsBW10MHz (), WifiPhy::GetOfdmRate18MbpsBW10MHz (),
+                       WifiPhy::GetOfdmRate24MbpsBW10MHz (), WifiPhy::GetOfdmRate27MbpsBW10MHz () };
+  uint32_t sizes[] = { 1, 13, 100, 257, 1500 };
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      for (uint32_t j = 0; j < 5; j++)
+        {
+          bool success = RunSingle (modes[i], sizes[j]);
+          NS_TEST_EXPECT_MSG_EQ (success, true, "TX pipeline output differs from frame-wise construction for "
+                                 << modes[i].GetUniqueName () << " and " << sizes[j] << " bytes");
+        }
+    }
+
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::PhySimScrambler::UseFixedScrambler", BooleanValue (false) );
+}
+
+bool
+PhySimWifiTxPipelineTest::RunSingle (WifiMode mode, uint32_t size)
+{
+  std::vector<uint8_t> payload (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      payload[i] = itpp::randi (0, 255);
+    }
+  Ptr<const Packet> packet = Create<Packet> (&payload[0], size);
+
+  itpp::cvec reference = Send (packet, mode, false);
+  itpp::cvec streamed = Send (packet, mode, true);
+  bool success = (reference.size () > 0) && (reference == streamed);
+  if (!success)
+    {
+      NS_LOG_DEBUG ("FAIL: TX pipeline test for " << mode.GetUniqueName () << " and " << size << " bytes");
+    }
+  else
+    {
+      NS_LOG_DEBUG ("PASS: TX pipeline test for " << mode.GetUniqueName () << " and " << size << " bytes");
+    }
+  return success;
+}
+
+itpp::cvec
+PhySimWifiTxPipelineTest::Send (Ptr<const Packet> packet, WifiMode mode, bool useTxPipeline)
+{
+  Ptr<PhySimWifiChannel> channel = CreateObject<PhySimWifiUniformChannel> ();
+  Ptr<PhySimWifiPhy> phy = CreateObject<PhySimWifiPhy> ();
+  phy->SetAttribute ("UseTxPipeline", BooleanValue (useTxPipeline));
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211p_CCH);
+  phy->SetChannel (channel);
+  phy->TraceConnectWithoutContext ("Tx", MakeCallback (&PhySimWifiTxPipelineTest::PhyTxCallback, this));
+
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+  Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  node->AggregateObject (mobility);
+  phy->SetMobility (node);
+  phy->SetDevice (device);
+
+  m_txSamples.set_size (0);
+  phy->SendPacket (packet, mode, WIFI_PREAMBLE_LONG, 1);
+  return m_txSamples;
+}
+
+void
+PhySimWifiTxPipelineTest::PhyTxCallback (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag)
+{
+  m_txSamples = tag->GetTxedSamples ();
+}
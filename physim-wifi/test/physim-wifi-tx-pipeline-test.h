@@ -0,0 +1,56 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2010 Jens Mittag, Stylianos Papanastasiou
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *      Jens Mittag <jens.mittag@kit.edu>
+ *      Stylianos Papanastasiou <stylianos@gmail.com>
+ */
+
+#ifndef PHYSIM_WIFI_TX_PIPELINE_TEST_H_
+#define PHYSIM_WIFI_TX_PIPELINE_TEST_H_
+
+#include "ns3/test.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/physim-wifi-phy.h"
+#include "ns3/physim-wifi-phy-tag.h"
+#include <itpp/itcomm.h>
+
+using namespace ns3;
+
+/**
+ * Test case to verify that the streaming TX pipeline produces exactly the same time samples as the
+ * construction of the DATA field in separate passes over the whole frame, for all rates and for
+ * payload sizes whose last OFDM symbol starts and ends at arbitrary bit positions.
+ */
+class PhySimWifiTxPipelineTest : public ns3::TestCase
+{
+public:
+  PhySimWifiTxPipelineTest ();
+  virtual ~PhySimWifiTxPipelineTest ();
+
+private:
+  void DoRun (void);
+  bool RunSingle (WifiMode mode, uint32_t size);
+  itpp::cvec Send (Ptr<const Packet> packet, WifiMode mode, bool useTxPipeline);
+  void PhyTxCallback (Ptr<const Packet> packet, Ptr<const PhySimWifiPhyTag> tag);
+
+  itpp::cvec m_txSamples;
+};
+
+#endif /* PHYSIM_WIFI_TX_PIPELINE_TEST_H_ */